@@ -0,0 +1,141 @@
+// Counts heap allocations on the daemon's request path: each INSERT and DELETE is
+// parsed from its wire form, executed against an in-memory store and serialized into
+// reused buffers, as a client handler does, with the logger at its default level.
+// Exits non-zero if a request allocates once the buffers and node pools have grown.
+#include "../daemon/CommandProcessor.hxx"
+#include "../protocol/MessageSerializer.hxx"
+#include "../protocol/BinaryCodec.hxx"
+#include "../storage/NumberStore.hxx"
+#include "../utils/Config.hxx"
+#include "../utils/Logger.hxx"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+    std::atomic<uint64_t> allocations(0);
+}
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+    using namespace NumberStore;
+
+    const uint64_t REQUESTS = 100000;
+
+    struct Phase {
+        const char* name;
+        CommandType type;
+        uint64_t first;     // Numbers first .. first + REQUESTS - 1
+    };
+
+    // Wire forms are built up front so the measured loop only sees the daemon's work
+    std::vector<std::string> encode(const Phase& phase, bool binary) {
+        std::vector<std::string> messages;
+        messages.reserve(REQUESTS);
+        for (uint64_t i = 0; i < REQUESTS; ++i) {
+            Command command(phase.type, phase.first + i);
+            std::string message;
+            if (binary) {
+                BinaryCodec::encodeCommand(command, static_cast<uint32_t>(i + 1), message);
+            } else {
+                message = "CMD#" + std::to_string(i + 1) + ":" + Command::getTypeName(phase.type) + " " +
+                          std::to_string(phase.first + i) + "\n";
+            }
+            messages.push_back(std::move(message));
+        }
+        return messages;
+    }
+
+    // Returns the allocations made while serving the messages
+    uint64_t serve(CommandProcessor& processor, const std::vector<std::string>& messages, bool binary,
+                   Command& command, Response& response, std::string& output, double& outNanosPerRequest) {
+        uint64_t before = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& message : messages) {
+            uint32_t requestId = 0;
+            bool parsed = binary ? BinaryCodec::decodeCommand(message, command, requestId)
+                                 : MessageSerializer::parseCommand(message, command, requestId);
+            if (!parsed) {
+                std::cerr << "Failed to parse a request" << std::endl;
+                std::exit(2);
+            }
+            processor.processCommandInto(command, response);
+            output.clear();
+            if (binary) {
+                BinaryCodec::encodeResponse(response, requestId, output);
+            } else {
+                MessageSerializer::serializeResponseInto(response, requestId, output);
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        outNanosPerRequest = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                             static_cast<double>(messages.size());
+        return allocations.load(std::memory_order_relaxed) - before;
+    }
+}
+
+int main() {
+    Logger::getInstance().setConsoleOutput(false);
+    Config& config = Config::getInstance();
+    config.loadDefaults();
+    config.setDurabilityMode(DurabilityMode::NONE);
+
+    NumberStore::NumberStore store;
+    CommandProcessor processor(store);
+
+    const Phase phases[] = {
+        {"INSERT new", CommandType::INSERT, 1},
+        {"INSERT duplicate", CommandType::INSERT, 1},
+        {"DELETE missing", CommandType::DELETE_NUM, REQUESTS + 1},
+        {"DELETE present", CommandType::DELETE_NUM, 1},
+    };
+
+    bool clean = true;
+    for (bool binary : {false, true}) {
+        std::vector<std::vector<std::string>> messages;
+        for (const Phase& phase : phases) {
+            messages.push_back(encode(phase, binary));
+        }
+
+        Command command(CommandType::EXIT);
+        Response response(ResponseType::SUCCESS, ErrorCode::SUCCESS);
+        std::string output;
+
+        // The first round grows the buffers and node pools; the second is measured
+        for (int round = 0; round < 2; ++round) {
+            for (size_t i = 0; i < messages.size(); ++i) {
+                double nanos = 0;
+                uint64_t count = serve(processor, messages[i], binary, command, response, output, nanos);
+                if (round == 0) {
+                    continue;
+                }
+                std::cout << (binary ? "binary " : "text   ") << phases[i].name << ": "
+                          << static_cast<double>(count) / static_cast<double>(REQUESTS) << " allocations/request, "
+                          << nanos << " ns/request" << std::endl;
+                clean = clean && count == 0;
+            }
+        }
+    }
+
+    Logger::getInstance().flush();
+    return clean ? 0 : 1;
+}
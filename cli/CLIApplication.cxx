@@ -61,20 +61,23 @@ namespace NumberStore {
                 << "2. Delete a number\n"
                 << "3. Print all numbers\n"
                 << "4. Delete all numbers\n"
-                << "5. Exit\n"
+                << "5. Print numbers in a range\n"
+                << "6. Count numbers in a range\n"
+                << "7. Show daemon statistics\n"
+                << "8. Exit\n"
                 << std::string(40, '=') << std::endl;
     }
 
     int CLIApplication::getUserChoice() {
         int choice;
         while (true) {
-            std::cout << "Enter your choice (1-5): ";
+            std::cout << "Enter your choice (1-8): ";
             
             if (std::cin >> choice) {
                 // Clear the input buffer
                 std::cin.ignore((std::numeric_limits<std::streamsize>::max)(), '\n');
                 
-                if (choice >= 1 && choice <= 5) {
+                if (choice >= 1 && choice <= 8) {
                     return choice;
                 }
             } else {
@@ -83,7 +86,7 @@ namespace NumberStore {
                 std::cin.ignore((std::numeric_limits<std::streamsize>::max)(), '\n');
             }
             
-            std::cout << "Invalid choice. Please enter a number between 1 and 5." << std::endl;
+            std::cout << "Invalid choice. Please enter a number between 1 and 8." << std::endl;
         }
     }
 
@@ -102,6 +105,15 @@ namespace NumberStore {
                 handleDeleteAllNumbers();
                 break;
             case 5:
+                handlePrintRange();
+                break;
+            case 6:
+                handleCountRange();
+                break;
+            case 7:
+                handleShowStats();
+                break;
+            case 8:
                 handleExit();
                 break;
             default:
@@ -153,16 +165,24 @@ namespace NumberStore {
     void CLIApplication::handlePrintAllNumbers() {
         std::cout << "\n--- All Stored Numbers ---" << std::endl;
         
+        // Print each streamed chunk as soon as it arrives instead of waiting for the whole dump
+        bool printedAny = false;
         std::string result;
-        ErrorCode error = client.printAllNumbers(result);
+        ErrorCode error = client.streamAllNumbers([&printedAny](const std::string& chunk) {
+            if (chunk == "No numbers stored.") {
+                return;
+            }
+            if (!printedAny) {
+                std::cout << "Number:Timestamp" << std::endl;
+                std::cout << std::string(30, '-') << std::endl;
+                printedAny = true;
+            }
+            std::cout << chunk << std::endl;
+        }, result);
         
         if (error == ErrorCode::SUCCESS) {
-            if (result.empty() || result == "No numbers stored.") {
+            if (!printedAny) {
                 std::cout << "No numbers are currently stored." << std::endl;
-            } else {
-                std::cout << "Number:Timestamp" << std::endl;
-                std::cout << std::string(30, '-') << std::endl;
-                std::cout << result << std::endl;
             }
         } else if (isConnectionError(error)) {
             handleConnectionError(result);
@@ -191,6 +211,82 @@ namespace NumberStore {
         }
     }
 
+    void CLIApplication::handlePrintRange() {
+        std::cout << "\n--- Print Numbers in a Range ---" << std::endl;
+        
+        uint64_t low = getNumberInput("Enter the lower bound: ");
+        uint64_t high = getNumberInput("Enter the upper bound: ");
+        
+        // Walk the range one page at a time so only a single page is ever held in memory
+        bool printedHeader = false;
+        bool hasMore = true;
+        uint64_t cursor = low;
+        
+        while (hasMore) {
+            std::string result;
+            uint64_t nextCursor = 0;
+            ErrorCode error = client.fetchRange(cursor, high, result, nextCursor, hasMore);
+            
+            if (error != ErrorCode::SUCCESS) {
+                if (isConnectionError(error)) {
+                    handleConnectionError(result);
+                } else {
+                    displayError(result);
+                }
+                return;
+            }
+            
+            if (!result.empty()) {
+                if (!printedHeader) {
+                    std::cout << "Number:Timestamp" << std::endl;
+                    std::cout << std::string(30, '-') << std::endl;
+                    printedHeader = true;
+                }
+                std::cout << result << std::endl;
+            }
+            cursor = nextCursor;
+        }
+        
+        if (!printedHeader) {
+            std::cout << "No numbers are stored in that range." << std::endl;
+        }
+    }
+
+    void CLIApplication::handleCountRange() {
+        std::cout << "\n--- Count Numbers in a Range ---" << std::endl;
+        
+        uint64_t low = getNumberInput("Enter the lower bound: ");
+        uint64_t high = getNumberInput("Enter the upper bound: ");
+        
+        std::string result;
+        uint64_t count = 0;
+        ErrorCode error = client.countNumbers(low, high, count, result);
+        
+        if (error == ErrorCode::SUCCESS) {
+            displayMessage(std::to_string(count) + " numbers stored between " + std::to_string(low) +
+                           " and " + std::to_string(high));
+        } else if (isConnectionError(error)) {
+            handleConnectionError(result);
+        } else {
+            displayError(result);
+        }
+    }
+
+    void CLIApplication::handleShowStats() {
+        std::cout << "\n--- Daemon Statistics ---" << std::endl;
+        
+        std::string result;
+        ErrorCode error = client.getStats(result);
+        
+        if (error == ErrorCode::SUCCESS) {
+            std::cout << result << std::endl;
+        } else if (isConnectionError(error)) {
+            handleConnectionError(result);
+        } else {
+            displayError(result);
+        }
+    }
+
     void CLIApplication::handleExit() {
         std::cout << "\n--- Exit ---" << std::endl;
         
@@ -34,6 +34,9 @@ namespace NumberStore {
         void handleDeleteNumber();
         void handlePrintAllNumbers();
         void handleDeleteAllNumbers();
+        void handlePrintRange();
+        void handleCountRange();
+        void handleShowStats();
         
         bool isConnectionError(ErrorCode error);
         void handleConnectionError(const std::string& message);
@@ -1,10 +1,16 @@
 #include "DaemonClient.hxx"
 #include "../utils/Logger.hxx"
 #include "../utils/Config.hxx"
+#include "../utils/Constants.hxx"
+#include "../ipc/IpcTransport.hxx"
+#include <string>
+#include <deque>
+#include <algorithm>
+#include <stdexcept>
 
 namespace NumberStore {
-    DaemonClient::DaemonClient() : connected(false) {
-        client = std::make_unique<NamedPipeClient>();
+    DaemonClient::DaemonClient() : connected(false), binaryProtocol(false), nextRequestId(1) {
+        client = std::make_unique<IpcClient>();
     }
 
     DaemonClient::~DaemonClient() {
@@ -17,11 +23,16 @@ namespace NumberStore {
         }
 
         Config& config = Config::getInstance();
-        ErrorCode result = client->connect(config.getPipeName());
+        ErrorCode result = client->connect(IpcTransport::getAddress());
         
         if (result == ErrorCode::SUCCESS) {
             connected = true;
+            binaryProtocol = false;
             Logger::getInstance().info("Connected to daemon");
+            
+            if (config.isBinaryProtocolEnabled()) {
+                result = negotiateProtocol();
+            }
         } else {
             Logger::getInstance().error("Failed to connect to daemon: " + 
                                      ErrorHandler::getErrorMessage(result));
@@ -37,6 +48,7 @@ namespace NumberStore {
 
         ErrorCode result = client->disconnect();
         connected = false;
+        binaryProtocol = false;
         
         Logger::getInstance().info("Disconnected from daemon");
         return result;
@@ -50,6 +62,53 @@ namespace NumberStore {
         return sendCommandInternal(command, response);
     }
 
+    ErrorCode DaemonClient::sendPipelined(const std::vector<Command>& commands, std::vector<std::unique_ptr<Response>>& outResponses) {
+        outResponses.clear();
+        if (!connected) {
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        for (const auto& command : commands) {
+            CommandType type = command.getCommandType();
+            if (type == CommandType::STREAM_ALL || type == CommandType::HELLO || type == CommandType::EXIT) {
+                return ErrorCode::INVALID_COMMAND;
+            }
+        }
+
+        outResponses.resize(commands.size());
+        size_t depth = Config::getInstance().getPipelineDepth();
+        std::deque<uint32_t> inFlight;
+        size_t sent = 0;
+        size_t received = 0;
+        ErrorCode result = ErrorCode::SUCCESS;
+
+        // Keep the window full, then collect the oldest reply to make room for the next request
+        while (received < commands.size() && result == ErrorCode::SUCCESS) {
+            while (sent < commands.size() && inFlight.size() < depth && result == ErrorCode::SUCCESS) {
+                uint32_t requestId = 0;
+                result = sendRequest(commands[sent], requestId, true);
+                inFlight.push_back(requestId);
+                ++sent;
+            }
+
+            if (result == ErrorCode::SUCCESS) {
+                result = receiveResponse(inFlight.front(), outResponses[received]);
+                inFlight.pop_front();
+                ++received;
+            }
+        }
+
+        if (result != ErrorCode::SUCCESS) {
+            // Replies still in flight would be read as answers to the next request
+            Logger::getInstance().error("Pipelined request failed after " + std::to_string(received) + " of " +
+                                        std::to_string(commands.size()) + " replies, dropping connection");
+            outResponses.resize(received);
+            disconnect();
+        }
+
+        return result;
+    }
+
     ErrorCode DaemonClient::insertNumber(uint64_t number, std::string& result) {
         auto command = Command::createInsertCommand(number);
         std::unique_ptr<Response> response;
@@ -78,6 +137,14 @@ namespace NumberStore {
         return response->isSuccess() ? ErrorCode::SUCCESS : response->getErrorCode();
     }
 
+    ErrorCode DaemonClient::insertNumbers(const std::vector<uint64_t>& numbers, size_t& outApplied, std::vector<bool>& outRejected, std::string& result) {
+        return sendBatch(CommandType::INSERT_MANY, numbers, outApplied, outRejected, result);
+    }
+
+    ErrorCode DaemonClient::deleteNumbers(const std::vector<uint64_t>& numbers, size_t& outApplied, std::vector<bool>& outRejected, std::string& result) {
+        return sendBatch(CommandType::DELETE_MANY, numbers, outApplied, outRejected, result);
+    }
+
     ErrorCode DaemonClient::printAllNumbers(std::string& result) {
         auto command = Command::createPrintAllCommand();
         std::unique_ptr<Response> response;
@@ -97,6 +164,75 @@ namespace NumberStore {
         return response->isSuccess() ? ErrorCode::SUCCESS : response->getErrorCode();
     }
 
+    ErrorCode DaemonClient::getStats(std::string& result) {
+        auto command = Command::createStatsCommand();
+        std::unique_ptr<Response> response;
+        
+        ErrorCode error = sendCommand(*command, response);
+        if (error != ErrorCode::SUCCESS) {
+            result = "Failed to communicate with daemon: " + ErrorHandler::getErrorMessage(error);
+            return error;
+        }
+
+        if (response->getResponseType() == ResponseType::DATA) {
+            result = response->getData();
+        } else {
+            result = formatResponse(*response);
+        }
+        
+        return response->isSuccess() ? ErrorCode::SUCCESS : response->getErrorCode();
+    }
+
+    ErrorCode DaemonClient::requestSave(std::string& result) {
+        auto command = Command::createSaveCommand();
+        std::unique_ptr<Response> response;
+        
+        ErrorCode error = sendCommand(*command, response);
+        if (error != ErrorCode::SUCCESS) {
+            result = "Failed to communicate with daemon: " + ErrorHandler::getErrorMessage(error);
+            return error;
+        }
+
+        result = formatResponse(*response);
+        return response->isSuccess() ? ErrorCode::SUCCESS : response->getErrorCode();
+    }
+
+    ErrorCode DaemonClient::streamAllNumbers(const std::function<void(const std::string&)>& onChunk, std::string& result) {
+        if (!connected) {
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        auto command = Command::createStreamAllCommand();
+        uint32_t requestId = 0;
+        ErrorCode error = sendRequest(*command, requestId);
+        
+        // CHUNK frames keep coming until the final DATA (or ERROR) frame
+        while (error == ErrorCode::SUCCESS) {
+            std::unique_ptr<Response> response;
+            error = receiveResponse(requestId, response);
+            if (error != ErrorCode::SUCCESS) {
+                break;
+            }
+
+            if (!response->isSuccess()) {
+                result = formatResponse(*response);
+                return response->getErrorCode();
+            }
+
+            if (!response->getData().empty()) {
+                onChunk(response->getData());
+            }
+
+            if (response->getResponseType() != ResponseType::CHUNK) {
+                result.clear();
+                return ErrorCode::SUCCESS;
+            }
+        }
+
+        result = "Failed to communicate with daemon: " + ErrorHandler::getErrorMessage(error);
+        return error;
+    }
+
     ErrorCode DaemonClient::deleteAllNumbers(std::string& result) {
         auto command = Command::createDeleteAllCommand();
         std::unique_ptr<Response> response;
@@ -125,35 +261,231 @@ namespace NumberStore {
         return response->isSuccess() ? ErrorCode::SUCCESS : response->getErrorCode();
     }
 
+    ErrorCode DaemonClient::fetchRange(uint64_t low, uint64_t high, std::string& result, uint64_t& outNextCursor, bool& outHasMore) {
+        auto command = Command::createRangeCommand(low, high);
+        return sendPageCommand(*command, result, outNextCursor, outHasMore);
+    }
+
+    ErrorCode DaemonClient::fetchPage(uint64_t cursor, uint64_t limit, std::string& result, uint64_t& outNextCursor, bool& outHasMore) {
+        auto command = Command::createPageCommand(cursor, limit);
+        return sendPageCommand(*command, result, outNextCursor, outHasMore);
+    }
+
+    ErrorCode DaemonClient::countNumbers(uint64_t low, uint64_t high, uint64_t& outCount, std::string& result) {
+        auto command = Command::createCountCommand(low, high);
+        std::unique_ptr<Response> response;
+        outCount = 0;
+        
+        ErrorCode error = sendCommand(*command, response);
+        if (error != ErrorCode::SUCCESS) {
+            result = "Failed to communicate with daemon: " + ErrorHandler::getErrorMessage(error);
+            return error;
+        }
+
+        result = formatResponse(*response);
+        if (!response->isSuccess()) {
+            return response->getErrorCode();
+        }
+
+        try {
+            outCount = std::stoull(response->getData());
+        } catch (const std::exception&) {
+            result = "Error: malformed COUNT response";
+            return ErrorCode::SERIALIZATION_ERROR;
+        }
+        return ErrorCode::SUCCESS;
+    }
+
     bool DaemonClient::isConnected() const {
         return connected && client && client->isConnected();
     }
 
-    ErrorCode DaemonClient::sendCommandInternal(const Command& command, std::unique_ptr<Response>& response) {
-        // Serialize and send command
-        std::string serializedCommand = MessageSerializer::serializeCommand(command);
-        ErrorCode sendResult = client->sendMessage(serializedCommand);
+    bool DaemonClient::isBinaryProtocol() const {
+        return binaryProtocol;
+    }
+
+    ErrorCode DaemonClient::negotiateProtocol() {
+        auto hello = Command::createHelloCommand(BinaryCodec::PROTOCOL_VERSION);
+        std::unique_ptr<Response> response;
+        ErrorCode result = sendCommandInternal(*hello, response);
+        
+        uint64_t agreed = 0;
+        bool understood = false;
+        if (result == ErrorCode::SUCCESS && response->isSuccess()) {
+            try {
+                size_t parsed = 0;
+                agreed = std::stoull(response->getData(), &parsed);
+                understood = parsed == response->getData().size();
+            } catch (const std::exception&) {
+                understood = false;
+            }
+        }
+
+        if (understood) {
+            binaryProtocol = agreed >= 1;
+            Logger::getInstance().info(std::string("Using ") + (binaryProtocol ? "binary" : "text") + " protocol");
+            return ErrorCode::SUCCESS;
+        }
+
+        // Daemons that predate HELLO end the session on unknown commands; reconnect and stay on text
+        Logger::getInstance().info("Daemon does not support protocol negotiation, using text protocol");
+        client->disconnect();
+        result = client->connect(IpcTransport::getAddress());
+        connected = result == ErrorCode::SUCCESS;
+        return result;
+    }
+
+    ErrorCode DaemonClient::sendRequest(const Command& command, uint32_t& outRequestId, bool tagged) {
+        ErrorCode sendResult;
+        outRequestId = 0;
+        
+        // Binary frames always carry an id; text commands are tagged only when pipelined,
+        // so plain request/response keeps working against daemons without tag support
+        if (binaryProtocol || tagged) {
+            outRequestId = nextRequestId++;
+            if (nextRequestId == 0) {
+                nextRequestId = 1; // 0 means untagged
+            }
+        }
+        
+        if (binaryProtocol) {
+            BinaryCodec::encodeCommand(command, outRequestId, frameBuffer);
+            sendResult = client->sendMessage(frameBuffer);
+        } else {
+            sendResult = client->sendMessage(MessageSerializer::serializeCommand(command, outRequestId));
+        }
         
         if (sendResult != ErrorCode::SUCCESS) {
             Logger::getInstance().error("Failed to send command to daemon");
-            return sendResult;
         }
+        return sendResult;
+    }
 
-        // Receive and deserialize response
+    ErrorCode DaemonClient::receiveResponse(uint32_t requestId, std::unique_ptr<Response>& response) {
         std::string serializedResponse;
-        ErrorCode receiveResult = client->receiveMessage(serializedResponse);
+        ErrorCode receiveResult = binaryProtocol ? client->receiveFrame(serializedResponse)
+                                                 : client->receiveMessage(serializedResponse);
         
         if (receiveResult != ErrorCode::SUCCESS) {
             Logger::getInstance().error("Failed to receive response from daemon");
             return receiveResult;
         }
 
-        response = MessageSerializer::deserializeResponse(serializedResponse);
+        uint32_t responseId = 0;
+        response = binaryProtocol ? BinaryCodec::decodeResponse(serializedResponse, responseId)
+                                  : MessageSerializer::deserializeResponse(serializedResponse, responseId);
         if (!response) {
             Logger::getInstance().error("Failed to deserialize response from daemon");
             return ErrorCode::SERIALIZATION_ERROR;
         }
 
+        if (responseId != requestId) {
+            Logger::getInstance().error("Response id " + std::to_string(responseId) + " does not match request " + std::to_string(requestId));
+            return ErrorCode::SERIALIZATION_ERROR;
+        }
+
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode DaemonClient::sendCommandInternal(const Command& command, std::unique_ptr<Response>& response) {
+        uint32_t requestId = 0;
+        ErrorCode sendResult = sendRequest(command, requestId);
+        if (sendResult != ErrorCode::SUCCESS) {
+            return sendResult;
+        }
+
+        return receiveResponse(requestId, response);
+    }
+
+    ErrorCode DaemonClient::sendBatch(CommandType type, const std::vector<uint64_t>& numbers, size_t& outApplied, std::vector<bool>& outRejected, std::string& result) {
+        outApplied = 0;
+        outRejected.assign(numbers.size(), false);
+
+        std::vector<Command> commands;
+        for (size_t start = 0; start < numbers.size(); start += Constants::MAX_BATCH_SIZE) {
+            size_t end = (std::min)(numbers.size(), start + Constants::MAX_BATCH_SIZE);
+            commands.emplace_back(type, std::vector<uint64_t>(numbers.begin() + start, numbers.begin() + end));
+        }
+
+        std::vector<std::unique_ptr<Response>> responses;
+        ErrorCode error = sendPipelined(commands, responses);
+        if (error != ErrorCode::SUCCESS) {
+            result = "Failed to communicate with daemon: " + ErrorHandler::getErrorMessage(error);
+            return error;
+        }
+
+        // Each reply is "<applied> <hex bitmap of rejected numbers, LSB first>"
+        for (size_t i = 0; i < responses.size(); ++i) {
+            const Response& response = *responses[i];
+            if (!response.isSuccess()) {
+                result = formatResponse(response);
+                return response.getErrorCode();
+            }
+
+            const std::string& data = response.getData();
+            size_t count = commands[i].getValues().size();
+            size_t offset = i * Constants::MAX_BATCH_SIZE;
+            size_t space = data.find(' ');
+
+            try {
+                outApplied += std::stoull(data.substr(0, space));
+                std::string bitmap = space == std::string::npos ? std::string() : data.substr(space + 1);
+                if (bitmap.size() != (count + 7) / 8 * 2) {
+                    throw std::invalid_argument("bitmap size");
+                }
+                for (size_t byte = 0; byte * 2 < bitmap.size(); ++byte) {
+                    unsigned long bits = std::stoul(bitmap.substr(byte * 2, 2), nullptr, 16);
+                    for (size_t bit = 0; bit < 8 && byte * 8 + bit < count; ++bit) {
+                        outRejected[offset + byte * 8 + bit] = (bits >> bit) & 1;
+                    }
+                }
+            } catch (const std::exception&) {
+                result = "Error: malformed batch response";
+                return ErrorCode::SERIALIZATION_ERROR;
+            }
+        }
+
+        result = std::string(type == CommandType::INSERT_MANY ? "Inserted " : "Deleted ") + std::to_string(outApplied) +
+                 " of " + std::to_string(numbers.size()) + " numbers (" + std::to_string(numbers.size() - outApplied) +
+                 (type == CommandType::INSERT_MANY ? " duplicates)" : " not found)");
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode DaemonClient::sendPageCommand(const Command& command, std::string& result, uint64_t& outNextCursor, bool& outHasMore) {
+        std::unique_ptr<Response> response;
+        outNextCursor = 0;
+        outHasMore = false;
+        
+        ErrorCode error = sendCommand(command, response);
+        if (error != ErrorCode::SUCCESS) {
+            result = "Failed to communicate with daemon: " + ErrorHandler::getErrorMessage(error);
+            return error;
+        }
+
+        if (response->getResponseType() != ResponseType::DATA) {
+            result = formatResponse(*response);
+            return response->isSuccess() ? ErrorCode::SERIALIZATION_ERROR : response->getErrorCode();
+        }
+
+        // First line is "NEXT <cursor>" or "END"; the entries follow
+        const std::string& data = response->getData();
+        size_t lineEnd = data.find('\n');
+        std::string header = data.substr(0, lineEnd);
+        result = lineEnd == std::string::npos ? std::string() : data.substr(lineEnd + 1);
+
+        if (header.compare(0, Constants::PAGE_NEXT.size(), Constants::PAGE_NEXT) == 0) {
+            try {
+                outNextCursor = std::stoull(header.substr(Constants::PAGE_NEXT.size()));
+                outHasMore = true;
+            } catch (const std::exception&) {
+                result = "Error: malformed page cursor";
+                return ErrorCode::SERIALIZATION_ERROR;
+            }
+        } else if (header != Constants::PAGE_END) {
+            result = "Error: malformed page response";
+            return ErrorCode::SERIALIZATION_ERROR;
+        }
+
         return ErrorCode::SUCCESS;
     }
 
@@ -1,18 +1,24 @@
 #ifndef DAEMON_CLIENT_HXX
 #define DAEMON_CLIENT_HXX
 
-#include "../ipc/NamedPipeClient.hxx"
+#include "../ipc/IpcClient.hxx"
 #include "../protocol/Command.hxx"
 #include "../protocol/Response.hxx"
 #include "../protocol/MessageSerializer.hxx"
+#include "../protocol/BinaryCodec.hxx"
 #include "../utils/ErrorCodes.hxx"
 #include <memory>
+#include <functional>
+#include <vector>
 
 namespace NumberStore {
     class DaemonClient {
     private:
-        std::unique_ptr<NamedPipeClient> client;
+        std::unique_ptr<IpcClient> client;
         bool connected;
+        bool binaryProtocol;     // Agreed with the daemon by HELLO at connect time
+        uint32_t nextRequestId;
+        std::string frameBuffer; // Reused for encoding binary commands
 
     public:
         DaemonClient();
@@ -25,19 +31,47 @@ namespace NumberStore {
         ErrorCode disconnect();
         
         ErrorCode sendCommand(const Command& command, std::unique_ptr<Response>& response);
+        // Pipelined form: commands go out without waiting for replies, up to the configured
+        // pipeline depth in flight, and outResponses[i] receives the reply to commands[i].
+        // Streaming and session commands (STREAM_ALL, HELLO, EXIT) cannot be pipelined.
+        ErrorCode sendPipelined(const std::vector<Command>& commands, std::vector<std::unique_ptr<Response>>& outResponses);
         
         // Convenience methods for specific commands
         ErrorCode insertNumber(uint64_t number, std::string& result);
         ErrorCode deleteNumber(uint64_t number, std::string& result);
+        // Bulk forms: numbers go out as pipelined INSERT_MANY/DELETE_MANY commands of up to
+        // Constants::MAX_BATCH_SIZE each; outRejected[i] marks numbers[i] as a duplicate
+        // (insert) or missing (delete), and outApplied counts the others
+        ErrorCode insertNumbers(const std::vector<uint64_t>& numbers, size_t& outApplied, std::vector<bool>& outRejected, std::string& result);
+        ErrorCode deleteNumbers(const std::vector<uint64_t>& numbers, size_t& outApplied, std::vector<bool>& outRejected, std::string& result);
         ErrorCode printAllNumbers(std::string& result);
+        // Streams the whole store: onChunk receives each block of "number:timestamp" lines
+        // as it arrives, so memory use does not grow with the store
+        ErrorCode streamAllNumbers(const std::function<void(const std::string&)>& onChunk, std::string& result);
         ErrorCode deleteAllNumbers(std::string& result);
         ErrorCode exitSession(std::string& result);
         
+        // Paged reads: result receives one page of "number:timestamp" lines; when
+        // outHasMore is set, continue from outNextCursor
+        ErrorCode fetchRange(uint64_t low, uint64_t high, std::string& result, uint64_t& outNextCursor, bool& outHasMore);
+        ErrorCode fetchPage(uint64_t cursor, uint64_t limit, std::string& result, uint64_t& outNextCursor, bool& outHasMore);
+        ErrorCode countNumbers(uint64_t low, uint64_t high, uint64_t& outCount, std::string& result);
+        // Daemon counters and per-command latency percentiles, one "name value" line each
+        ErrorCode getStats(std::string& result);
+        // Asks the daemon to write a checkpoint now; returns once the save is queued
+        ErrorCode requestSave(std::string& result);
+        
         bool isConnected() const;
+        bool isBinaryProtocol() const;
         
     private:
+        ErrorCode negotiateProtocol();
+        ErrorCode sendRequest(const Command& command, uint32_t& outRequestId, bool tagged = false);
+        ErrorCode receiveResponse(uint32_t requestId, std::unique_ptr<Response>& response);
         ErrorCode sendCommandInternal(const Command& command, std::unique_ptr<Response>& response);
         std::string formatResponse(const Response& response);
+        ErrorCode sendBatch(CommandType type, const std::vector<uint64_t>& numbers, size_t& outApplied, std::vector<bool>& outRejected, std::string& result);
+        ErrorCode sendPageCommand(const Command& command, std::string& result, uint64_t& outNextCursor, bool& outHasMore);
     };
 }
 
@@ -1,17 +1,26 @@
 #include "ClientHandler.hxx"
 #include "SignalHandler.hxx"
 #include "../utils/Logger.hxx"
+#include "../utils/Constants.hxx"
+#include "../utils/Config.hxx"
 #include <sstream>
 #include <chrono>
+#include <algorithm>
 
 namespace NumberStore {
-    ClientHandler::ClientHandler(std::unique_ptr<NamedPipeConnection> conn, CommandProcessor& proc)
-        : connection(std::move(conn)), processor(proc), active(true) {
+    ClientHandler::ClientHandler(std::unique_ptr<IpcConnection> conn, CommandProcessor& proc)
+        : connection(std::move(conn)), processor(proc), active(true), binaryProtocol(false),
+          response(ResponseType::SUCCESS, ErrorCode::SUCCESS), eventDriven(false), executing(false),
+          requestCount(0), nextRequest(0), replyCount(0), replyBytes(0), closeAfterReplies(false),
+          streamRequestId(0), replyCommand(CommandType::EXIT), replyTimed(false),
+          statsInterval(Config::getInstance().getStatsSampleInterval()), statsCountdown(1) {
         clientId = generateClientId();
+        processor.getStats().connectionOpened();
     }
 
     ClientHandler::~ClientHandler() {
         cleanup();
+        processor.getStats().connectionClosed();
     }
 
     void ClientHandler::run() {
@@ -34,7 +43,7 @@ namespace NumberStore {
 
     void ClientHandler::stop() {
         active.store(false);
-        Logger::getInstance().debug("Stop requested for client: " + clientId);
+        NS_LOG_DEBUG("Stop requested for client: " + clientId);
     }
 
     bool ClientHandler::isActive() const {
@@ -45,50 +54,298 @@ namespace NumberStore {
         return clientId;
     }
 
+    ErrorCode ClientHandler::attachToEventLoop() {
+        ErrorCode result = connection->setNonBlocking(true);
+        eventDriven = result == ErrorCode::SUCCESS;
+        return result;
+    }
+
+    bool ClientHandler::onReadable() {
+        return processInput();
+    }
+
+    bool ClientHandler::onWritable() {
+        ErrorCode result = connection->flushPending();
+        if (result != ErrorCode::SUCCESS && result != ErrorCode::WOULD_BLOCK) {
+            Logger::getInstance().error("Failed to write response to client " + clientId + ": " + 
+                                     ErrorHandler::getErrorMessage(result));
+            return false;
+        }
+        
+        // Room in the socket again: requests held back behind the backlog can be read
+        return processInput();
+    }
+
+    bool ClientHandler::readyToExecute() const {
+        return !executing && hasWork() && connection->getPendingBytes() < Constants::REACTOR_OUTPUT_HIGH_WATER;
+    }
+
+    void ClientHandler::beginExecution() {
+        executing = true;
+    }
+
+    void ClientHandler::execute() {
+        // Answer the batch in order, stopping once a reply backlog's worth is ready so a
+        // stream to a slow reader is cut one bounded piece at a time
+        replyCount = 0;
+        replyBytes = 0;
+        
+        try {
+            while (replyBytes < Constants::REACTOR_OUTPUT_HIGH_WATER) {
+                if (stream.active) {
+                    uint64_t frameStart = DaemonStats::now();
+                    processor.nextStreamFrame(stream, response);
+                    processor.getStats().recordStage(CommandType::STREAM_ALL, RequestStage::EXECUTE, DaemonStats::now() - frameStart);
+                    
+                    replyCommand = CommandType::STREAM_ALL;
+                    replyTimed = true;
+                    sendResponse(response, streamRequestId);
+                    continue;
+                }
+                if (nextRequest == requestCount) {
+                    break;
+                }
+                
+                if (!handleRequest(requests[nextRequest++])) {
+                    closeAfterReplies = true;
+                    nextRequest = requestCount;
+                    break;
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            Logger::getInstance().error("Exception in client handler: " + std::string(e.what()));
+            closeAfterReplies = true;
+            stream = StreamCursor();
+            nextRequest = requestCount;
+        }
+    }
+
+    bool ClientHandler::completeExecution() {
+        executing = false;
+        
+        DaemonStats& stats = processor.getStats();
+        for (size_t i = 0; i < replyCount; ++i) {
+            uint64_t writeStart = replies[i].timed ? DaemonStats::now() : 0;
+            ErrorCode result = connection->write(replies[i].data);
+            if (result != ErrorCode::SUCCESS) {
+                Logger::getInstance().error("Failed to write response to client " + clientId + ": " + 
+                                         ErrorHandler::getErrorMessage(result));
+                return false;
+            }
+            
+            if (replies[i].timed) {
+                stats.recordStage(replies[i].command, RequestStage::WRITE, DaemonStats::now() - writeStart);
+            }
+            stats.addBytesOut(replies[i].data.size());
+        }
+        replyCount = 0;
+        
+        if (nextRequest == requestCount) {
+            nextRequest = 0;
+            requestCount = 0;
+        }
+        return !closeAfterReplies && processInput();
+    }
+
+    bool ClientHandler::isExecuting() const {
+        return executing;
+    }
+
+    bool ClientHandler::wantsRead() const {
+        return !executing && !hasWork() && connection->getPendingBytes() < Constants::REACTOR_OUTPUT_HIGH_WATER;
+    }
+
+    bool ClientHandler::wantsWrite() const {
+        return connection->getPendingBytes() > 0;
+    }
+
+    int ClientHandler::getDescriptor() const {
+        return connection->getDescriptor();
+    }
+
+    IpcConnection& ClientHandler::getConnection() {
+        return *connection;
+    }
+
+    void ClientHandler::close() {
+        cleanup();
+    }
+
     bool ClientHandler::handleSingleCommand() {
-        // Read command from client
-        std::string rawMessage;
-        ErrorCode readResult = connection->read(rawMessage);
+        // Commands are answered strictly in arrival order and nothing here waits on the
+        // client, so a pipelining client can keep many tagged requests in flight
+        ErrorCode readResult = readMessage();
         
         if (readResult != ErrorCode::SUCCESS) {
-            if (readResult == ErrorCode::CONNECTION_FAILED) {
-                Logger::getInstance().info("Client disconnected: " + clientId);
-            } else {
-                Logger::getInstance().error("Failed to read from client " + clientId + ": " + 
-                                         ErrorHandler::getErrorMessage(readResult));
-            }
+            reportReadFailure(readResult);
             return false;
         }
 
-        // Deserialize command
-        auto command = MessageSerializer::deserializeCommand(rawMessage);
-        if (!command) {
+        if (requests.empty()) {
+            requests.emplace_back();
+        }
+        // The read blocked until the client sent something, so only parsing is timed
+        uint64_t parseStart = statsCountdown == 1 ? DaemonStats::now() : 0;
+        parseMessage(requests[0]);
+        recordReceived(requests[0], parseStart, parseStart);
+        return handleRequest(requests[0]);
+    }
+
+    bool ClientHandler::processInput() {
+        // Parse whatever has arrived into the next batch, but at most a budget of messages
+        // so one busy client cannot starve the others; the rest is read once the batch is done
+        if (!wantsRead()) {
+            return true;
+        }
+        
+        while (requestCount < Constants::REACTOR_MESSAGE_BUDGET) {
+            // Clocks cost tens of nanoseconds, as much as parsing a binary frame, so only
+            // sampled requests read them
+            uint64_t readStart = statsCountdown == 1 ? DaemonStats::now() : 0;
+            ErrorCode readResult = readMessage();
+            if (readResult == ErrorCode::WOULD_BLOCK) {
+                break;
+            }
+            if (readResult != ErrorCode::SUCCESS) {
+                reportReadFailure(readResult);
+                return false;
+            }
+            
+            if (requestCount == requests.size()) {
+                requests.emplace_back();
+            }
+            PendingRequest& request = requests[requestCount++];
+            uint64_t parseStart = readStart != 0 ? DaemonStats::now() : 0;
+            parseMessage(request);
+            recordReceived(request, readStart, parseStart);
+            
+            // HELLO decides how the messages behind it are framed, and nothing is read after EXIT
+            if (!request.malformed && (request.command.getCommandType() == CommandType::HELLO ||
+                                       request.command.getCommandType() == CommandType::EXIT)) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool ClientHandler::hasWork() const {
+        return stream.active || nextRequest < requestCount;
+    }
+
+    ErrorCode ClientHandler::readMessage() {
+        return binaryProtocol ? connection->readFrame(inputBuffer) : connection->read(inputBuffer);
+    }
+
+    void ClientHandler::reportReadFailure(ErrorCode readResult) {
+        if (readResult == ErrorCode::CONNECTION_FAILED) {
+            Logger::getInstance().info("Client disconnected: " + clientId);
+        } else {
+            Logger::getInstance().error("Failed to read from client " + clientId + ": " + 
+                                     ErrorHandler::getErrorMessage(readResult));
+        }
+    }
+
+    void ClientHandler::parseMessage(PendingRequest& request) {
+        // Parse command in place
+        request.requestId = 0;
+        request.malformed = !(binaryProtocol ? BinaryCodec::decodeCommand(inputBuffer, request.command, request.requestId)
+                                             : MessageSerializer::parseCommand(inputBuffer, request.command, request.requestId));
+    }
+
+    void ClientHandler::recordReceived(PendingRequest& request, uint64_t readStart, uint64_t parseStart) {
+        DaemonStats& stats = processor.getStats();
+        stats.countOperation();
+        stats.addBytesIn(inputBuffer.size());
+        
+        request.timed = parseStart != 0 && !request.malformed;
+        if (--statsCountdown == 0) {
+            statsCountdown = statsInterval;
+        }
+        if (!request.timed) {
+            return;
+        }
+        
+        uint64_t parseEnd = DaemonStats::now();
+        CommandType type = request.command.getCommandType();
+        if (parseStart > readStart) {
+            stats.recordStage(type, RequestStage::READ, parseStart - readStart);
+        }
+        stats.recordStage(type, RequestStage::PARSE, parseEnd - parseStart);
+    }
+
+    bool ClientHandler::handleRequest(const PendingRequest& request) {
+        const Command& command = request.command;
+        uint32_t requestId = request.requestId;
+        replyCommand = command.getCommandType();
+        replyTimed = request.timed;
+        
+        if (request.malformed) {
             Logger::getInstance().error("Failed to deserialize command from client: " + clientId);
+            processor.getStats().countError(ErrorCode::SERIALIZATION_ERROR);
             
             // Send error response
-            auto errorResponse = Response::createErrorResponse(ErrorCode::SERIALIZATION_ERROR, "");
-            std::string errorMessage = MessageSerializer::serializeResponse(*errorResponse);
-            connection->write(errorMessage);
+            response.assign(ResponseType::ERROR_RESPONSE, ErrorCode::SERIALIZATION_ERROR);
+            sendResponse(response, requestId);
             return true; // Continue processing other commands
         }
 
+        // Protocol negotiation: agree on the highest version both sides speak; 0 keeps the text protocol
+        if (command.getCommandType() == CommandType::HELLO) {
+            uint64_t agreed = (std::min<uint64_t>)(command.getNumber(), BinaryCodec::PROTOCOL_VERSION);
+            ErrorCode writeResult = sendResponse(*Response::createSuccessResponse(std::to_string(agreed)), requestId);
+            binaryProtocol = agreed >= 1;
+            Logger::getInstance().info("Client " + clientId + " negotiated " + (binaryProtocol ? "binary" : "text") + " protocol");
+            return writeResult == ErrorCode::SUCCESS;
+        }
+
         // Check for exit command
-        if (command->getCommandType() == CommandType::EXIT) {
+        if (command.getCommandType() == CommandType::EXIT) {
             // Process exit command and send response
-            auto response = processor.processCommand(*command);
-            std::string responseMessage = MessageSerializer::serializeResponse(*response);
-            connection->write(responseMessage);
+            processor.processCommandInto(command, response);
+            sendResponse(response, requestId);
             
             Logger::getInstance().info("Client " + clientId + " requested exit");
             return false; // End this client session
         }
 
-        // Process command
-        auto response = processor.processCommand(*command);
+        if (processor.isStreamingCommand(command) && eventDriven) {
+            // execute() cuts the frames
+            processor.beginStream(stream);
+            streamRequestId = requestId;
+            return true;
+        }
+
+        if (processor.isStreamingCommand(command)) {
+            ErrorCode streamResult = processor.processStreamingCommand(command, [this, requestId](const Response& frame) {
+                return sendResponse(frame, requestId);
+            });
+            
+            if (streamResult != ErrorCode::SUCCESS) {
+                Logger::getInstance().error("Failed to stream response to client " + clientId + ": " + 
+                                         ErrorHandler::getErrorMessage(streamResult));
+                return false;
+            }
+            return true;
+        }
+
+        // Process command; lock waits left over from earlier work on this thread are not its own
+        DaemonStats& stats = processor.getStats();
+        if (request.timed) {
+            NumberStore::takeLockWaitNanos();
+            uint64_t executeStart = DaemonStats::now();
+            processor.processCommandInto(command, response);
+            stats.recordStage(command.getCommandType(), RequestStage::EXECUTE, DaemonStats::now() - executeStart);
+            stats.recordStage(command.getCommandType(), RequestStage::LOCK_WAIT, NumberStore::takeLockWaitNanos());
+        } else {
+            processor.processCommandInto(command, response);
+        }
+        if (response.getResponseType() == ResponseType::ERROR_RESPONSE) {
+            stats.countError(response.getErrorCode());
+        }
         
         // Send response back to client
-        std::string responseMessage = MessageSerializer::serializeResponse(*response);
-        ErrorCode writeResult = connection->write(responseMessage);
+        ErrorCode writeResult = sendResponse(response, requestId);
         
         if (writeResult != ErrorCode::SUCCESS) {
             Logger::getInstance().error("Failed to write response to client " + clientId + ": " + 
@@ -99,10 +356,53 @@ namespace NumberStore {
         return true; // Continue processing commands
     }
 
+    ErrorCode ClientHandler::sendResponse(const Response& reply, uint32_t requestId) {
+        DaemonStats& stats = processor.getStats();
+        uint64_t serializeStart = replyTimed ? DaemonStats::now() : 0;
+        
+        if (eventDriven) {
+            // Serialized on the worker, sent by completeExecution()
+            if (replyCount == replies.size()) {
+                replies.emplace_back();
+            }
+            PendingReply& out = replies[replyCount++];
+            if (binaryProtocol) {
+                BinaryCodec::encodeResponse(reply, requestId, out.data);
+            } else {
+                MessageSerializer::serializeResponseInto(reply, requestId, out.data);
+            }
+            out.command = replyCommand;
+            out.timed = replyTimed;
+            replyBytes += out.data.size();
+            
+            if (replyTimed) {
+                stats.recordStage(replyCommand, RequestStage::SERIALIZE, DaemonStats::now() - serializeStart);
+            }
+            return ErrorCode::SUCCESS;
+        }
+        
+        if (binaryProtocol) {
+            BinaryCodec::encodeResponse(reply, requestId, outputBuffer);
+        } else {
+            MessageSerializer::serializeResponseInto(reply, requestId, outputBuffer);
+        }
+        
+        uint64_t writeStart = replyTimed ? DaemonStats::now() : 0;
+        ErrorCode result = connection->write(outputBuffer);
+        if (replyTimed) {
+            stats.recordStage(replyCommand, RequestStage::SERIALIZE, writeStart - serializeStart);
+            stats.recordStage(replyCommand, RequestStage::WRITE, DaemonStats::now() - writeStart);
+        }
+        stats.addBytesOut(outputBuffer.size());
+        return result;
+    }
+
     void ClientHandler::cleanup() {
         active.store(false);
         
         if (connection && connection->isConnected()) {
+            // Best effort for replies still queued in event-loop mode, such as the EXIT answer
+            connection->flushPending();
             connection->disconnect();
         }
     }
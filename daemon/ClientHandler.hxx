@@ -1,22 +1,69 @@
 #ifndef CLIENT_HANDLER_HXX
 #define CLIENT_HANDLER_HXX
 
-#include "../ipc/NamedPipeConnection.hxx"
+#include "../ipc/IpcConnection.hxx"
 #include "CommandProcessor.hxx"
 #include "../protocol/MessageSerializer.hxx"
+#include "../protocol/BinaryCodec.hxx"
 #include <memory>
 #include <atomic>
+#include <vector>
 
 namespace NumberStore {
     class ClientHandler {
     private:
-        std::unique_ptr<NamedPipeConnection> connection;
+        // One parsed request; requests that failed to parse still queue, so their error
+        // reply keeps its place in the reply order
+        struct PendingRequest {
+            Command command;
+            uint32_t requestId;
+            bool malformed;
+            bool timed;       // Sampled for DaemonStats latencies
+            
+            PendingRequest() : command(CommandType::EXIT), requestId(0), malformed(false), timed(false) {}
+        };
+
+        // A serialized reply waiting for the loop thread, and what it answers (for DaemonStats)
+        struct PendingReply {
+            std::string data;
+            CommandType command = CommandType::EXIT;
+            bool timed = false;
+        };
+
+        std::unique_ptr<IpcConnection> connection;
         CommandProcessor& processor;
         std::atomic<bool> active;
         std::string clientId;
+        bool binaryProtocol;      // Switched on by a successful HELLO
+        // Per-connection buffers reused by every request, so the steady-state
+        // INSERT/DELETE path does not touch the heap
+        std::string inputBuffer;
+        std::string outputBuffer;
+        Response response;
+        // Event-loop mode: the loop thread parses requests into [nextRequest, requestCount)
+        // and execute() answers them on an executor worker, serializing into replies[0,
+        // replyCount) for the loop thread to send. Slots are reused across batches
+        bool eventDriven;
+        bool executing;           // A batch is on a worker; only execute() touches the state above
+        std::vector<PendingRequest> requests;
+        size_t requestCount;
+        size_t nextRequest;
+        std::vector<PendingReply> replies;
+        size_t replyCount;
+        size_t replyBytes;
+        bool closeAfterReplies;   // EXIT was answered
+        // An unfinished STREAM_ALL and the request it answers
+        StreamCursor stream;
+        uint32_t streamRequestId;
+        // What the next sendResponse() answers; malformed requests have no command to time
+        CommandType replyCommand;
+        bool replyTimed;
+        // Requests left until the next one is timed; every request is still counted
+        size_t statsInterval;
+        size_t statsCountdown;
 
     public:
-        ClientHandler(std::unique_ptr<NamedPipeConnection> conn, CommandProcessor& proc);
+        ClientHandler(std::unique_ptr<IpcConnection> conn, CommandProcessor& proc);
         ~ClientHandler();
 
         ClientHandler(const ClientHandler&) = delete;
@@ -27,8 +74,35 @@ namespace NumberStore {
         bool isActive() const;
         const std::string& getClientId() const;
         
+        // Event-loop mode (daemon/EpollReactor): the connection is switched to non-blocking
+        // and these run on readiness instead of run(). The loop thread does all of the
+        // connection I/O; commands run in execute() on an executor worker, one batch at a
+        // time per client so replies keep request order. The bool results are false once
+        // the client is done and should be closed
+        ErrorCode attachToEventLoop();
+        bool onReadable();
+        bool onWritable();
+        bool readyToExecute() const;  // Parsed requests or a stream wait, and the reply queue has room
+        void beginExecution();
+        void execute();               // Worker thread
+        bool completeExecution();     // Loop thread, once execute() has returned
+        bool isExecuting() const;
+        bool wantsRead() const;       // False while a batch runs or a stream or reply backlog drains
+        bool wantsWrite() const;
+        int getDescriptor() const;
+        IpcConnection& getConnection();
+        void close();
+        
     private:
         bool handleSingleCommand();
+        void parseMessage(PendingRequest& request);
+        void recordReceived(PendingRequest& request, uint64_t readStart, uint64_t parseStart);
+        bool handleRequest(const PendingRequest& request);
+        bool processInput();
+        bool hasWork() const;
+        ErrorCode readMessage();
+        void reportReadFailure(ErrorCode readResult);
+        ErrorCode sendResponse(const Response& reply, uint32_t requestId);
         void cleanup();
         std::string generateClientId();
     };
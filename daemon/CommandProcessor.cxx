@@ -1,13 +1,26 @@
 #include "CommandProcessor.hxx"
 #include "../utils/Logger.hxx"
 #include "../utils/TimeUtils.hxx"
+#include "../utils/Constants.hxx"
+#include <algorithm>
+#include <limits>
+#include <charconv>
 
 namespace NumberStore {
-    CommandProcessor::CommandProcessor(NumberStore& store) : numberStore(store) {
+    namespace {
+        template <typename Integer>
+        void appendInteger(std::string& out, Integer value) {
+            char digits[24];
+            auto converted = std::to_chars(digits, digits + sizeof(digits), value);
+            out.append(digits, converted.ptr);
+        }
+    }
+
+    CommandProcessor::CommandProcessor(NumberStore& store) : numberStore(store), backgroundSaver(nullptr) {
     }
 
     std::unique_ptr<Response> CommandProcessor::processCommand(const Command& command) {
-        Logger::getInstance().debug("Processing command: " + std::to_string(static_cast<int>(command.getCommandType())));
+        NS_LOG_DEBUG("Processing command: " + std::to_string(static_cast<int>(command.getCommandType())));
         
         switch (command.getCommandType()) {
             case CommandType::INSERT:
@@ -25,34 +38,159 @@ namespace NumberStore {
             case CommandType::EXIT:
                 return processExit();
                 
+            case CommandType::RANGE:
+                return processRange(command.getNumber(), command.getArgument(), Constants::MAX_PAGE_SIZE);
+                
+            case CommandType::PAGE:
+                return processRange(command.getNumber(), (std::numeric_limits<uint64_t>::max)(),
+                                    static_cast<size_t>((std::min<uint64_t>)(command.getArgument(), Constants::MAX_PAGE_SIZE)));
+                
+            case CommandType::COUNT:
+                return processCount(command.getNumber(), command.getArgument());
+                
+            case CommandType::INSERT_MANY:
+            case CommandType::DELETE_MANY: {
+                auto response = std::make_unique<Response>(ResponseType::SUCCESS, ErrorCode::SUCCESS);
+                processBatch(command, *response);
+                return response;
+            }
+                
+            case CommandType::STATS:
+                return processStats();
+                
+            case CommandType::SAVE:
+                return processSave();
+                
             default:
                 Logger::getInstance().error("Unknown command type");
                 return Response::createErrorResponse(ErrorCode::INVALID_COMMAND);
         }
     }
 
-    std::unique_ptr<Response> CommandProcessor::processInsert(uint64_t number) {
-        ErrorCode result = numberStore.insert(number);
+    void CommandProcessor::processCommandInto(const Command& command, Response& outResponse) {
+        ErrorCode result;
+        int64_t timestamp = 0;
         
-        if (result == ErrorCode::SUCCESS) {
-            int64_t timestamp = TimeUtils::getCurrentUnixTimestamp();
-            std::string message = createSuccessMessage("inserted", number, timestamp);
-            return Response::createSuccessResponse(message);
-        } else {
-            return Response::createErrorResponse(result);
+        switch (command.getCommandType()) {
+            case CommandType::INSERT:
+                result = numberStore.insert(command.getNumber());
+                if (result == ErrorCode::SUCCESS) {
+                    timestamp = TimeUtils::getCurrentUnixTimestamp();
+                    writeSuccessMessage(outResponse, "inserted", command.getNumber(), timestamp);
+                } else {
+                    outResponse.assign(ResponseType::ERROR_RESPONSE, result);
+                }
+                return;
+                
+            case CommandType::DELETE_NUM:
+                result = numberStore.remove(command.getNumber(), timestamp);
+                if (result == ErrorCode::SUCCESS) {
+                    writeSuccessMessage(outResponse, "deleted", command.getNumber(), timestamp);
+                } else {
+                    outResponse.assign(ResponseType::ERROR_RESPONSE, result);
+                }
+                return;
+                
+            case CommandType::INSERT_MANY:
+            case CommandType::DELETE_MANY:
+                processBatch(command, outResponse);
+                return;
+                
+            default:
+                outResponse = *processCommand(command);
+                return;
         }
     }
 
-    std::unique_ptr<Response> CommandProcessor::processDelete(uint64_t number) {
-        int64_t timestamp;
-        ErrorCode result = numberStore.remove(number, timestamp);
+    DaemonStats& CommandProcessor::getStats() {
+        return stats;
+    }
+
+    void CommandProcessor::setBackgroundSaver(BackgroundSaver* saver) {
+        backgroundSaver = saver;
+    }
+
+    bool CommandProcessor::isStreamingCommand(const Command& command) const {
+        return command.getCommandType() == CommandType::STREAM_ALL;
+    }
+
+    ErrorCode CommandProcessor::processStreamingCommand(const Command& command, const std::function<ErrorCode(const Response&)>& sendFrame) {
+        if (!isStreamingCommand(command)) {
+            return sendFrame(*processCommand(command));
+        }
         
-        if (result == ErrorCode::SUCCESS) {
-            std::string message = createSuccessMessage("deleted", number, timestamp);
-            return Response::createSuccessResponse(message);
-        } else {
-            return Response::createErrorResponse(result);
+        StreamCursor cursor;
+        Response frame(ResponseType::DATA, ErrorCode::SUCCESS);
+        beginStream(cursor);
+        
+        while (cursor.active) {
+            nextStreamFrame(cursor, frame);
+            ErrorCode result = sendFrame(frame);
+            if (result != ErrorCode::SUCCESS) {
+                return result;
+            }
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    void CommandProcessor::beginStream(StreamCursor& cursor) {
+        cursor.snapshot = numberStore.getSnapshot();
+        cursor.position = cursor.snapshot ? cursor.snapshot->begin() : StoreSnapshot::Iterator();
+        cursor.chunk.clear();
+        cursor.chunk.reserve(Constants::STREAM_CHUNK_SIZE + 64);
+        cursor.frames = 0;
+        cursor.active = true;
+    }
+
+    void CommandProcessor::nextStreamFrame(StreamCursor& cursor, Response& outFrame) {
+        if (!cursor.snapshot || cursor.snapshot->empty()) {
+            outFrame.assign(ResponseType::DATA, ErrorCode::SUCCESS);
+            outFrame.getDataBuffer() = "No numbers stored.";
+            cursor.position = StoreSnapshot::Iterator();
+            cursor.snapshot.reset();
+            cursor.active = false;
+            return;
         }
+        
+        // Frames are cut from the snapshot iterator as they fill, so memory stays at one
+        // chunk no matter how large the store is
+        std::string& chunk = cursor.chunk;
+        for (; cursor.position.isValid(); ++cursor.position) {
+            if (!chunk.empty()) {
+                chunk += '\n';
+            }
+            appendInteger(chunk, cursor.position.getNumber());
+            chunk += ':';
+            appendInteger(chunk, cursor.position.getTimestamp());
+            
+            if (chunk.size() >= Constants::STREAM_CHUNK_SIZE) {
+                ++cursor.position;
+                ++cursor.frames;
+                outFrame.assign(ResponseType::CHUNK, ErrorCode::SUCCESS);
+                outFrame.getDataBuffer().swap(chunk);
+                return;
+            }
+        }
+        
+        NS_LOG_DEBUG("Streamed " + std::to_string(cursor.snapshot->size()) + " numbers in " +
+                     std::to_string(cursor.frames + 1) + " frames");
+        outFrame.assign(ResponseType::DATA, ErrorCode::SUCCESS);
+        outFrame.getDataBuffer().swap(chunk);
+        cursor.position = StoreSnapshot::Iterator();
+        cursor.snapshot.reset();
+        cursor.active = false;
+    }
+
+    std::unique_ptr<Response> CommandProcessor::processInsert(uint64_t number) {
+        auto response = std::make_unique<Response>(ResponseType::SUCCESS, ErrorCode::SUCCESS);
+        processCommandInto(Command(CommandType::INSERT, number), *response);
+        return response;
+    }
+
+    std::unique_ptr<Response> CommandProcessor::processDelete(uint64_t number) {
+        auto response = std::make_unique<Response>(ResponseType::SUCCESS, ErrorCode::SUCCESS);
+        processCommandInto(Command(CommandType::DELETE_NUM, number), *response);
+        return response;
     }
 
     std::unique_ptr<Response> CommandProcessor::processPrintAll() {
@@ -77,13 +215,115 @@ namespace NumberStore {
         return Response::createSuccessResponse("Goodbye!");
     }
 
-    std::string CommandProcessor::createSuccessMessage(const std::string& operation, uint64_t number, int64_t timestamp) {
-        std::string message = "Number " + std::to_string(number) + " " + operation;
+    std::unique_ptr<Response> CommandProcessor::processStats() {
+        BackgroundSaver::Status saveStatus{};
+        if (backgroundSaver) {
+            saveStatus = backgroundSaver->getStatus();
+        }
+        return Response::createDataResponse(stats.report(numberStore.getSnapshotRebuildCount(), numberStore.getMemoryUsage(),
+                                                         numberStore.getFilterStats(), backgroundSaver ? &saveStatus : nullptr));
+    }
+
+    std::unique_ptr<Response> CommandProcessor::processSave() {
+        if (!backgroundSaver) {
+            return Response::createErrorResponse(ErrorCode::INVALID_COMMAND, "Saving is disabled: the store is not durable");
+        }
         
-        if (timestamp > 0) {
-            message += " at timestamp " + std::to_string(timestamp);
+        Logger::getInstance().info("Client requested a checkpoint");
+        backgroundSaver->requestSave();
+        return Response::createSuccessResponse("Background save requested");
+    }
+
+    std::unique_ptr<Response> CommandProcessor::processRange(uint64_t low, uint64_t high, size_t limit) {
+        std::vector<NumberEntry> entries;
+        bool hasMore = false;
+        ErrorCode result = numberStore.getRange(low, high, limit, entries, hasMore);
+        
+        if (result != ErrorCode::SUCCESS) {
+            return Response::createErrorResponse(result);
+        }
+        
+        // The first line tells the client where to resume; cursors are plain numbers, so
+        // the daemon keeps no per-client state between pages
+        std::string data;
+        data.reserve(entries.size() * 32 + 32);
+        if (hasMore) {
+            data += Constants::PAGE_NEXT + " " + std::to_string(entries.back().number + 1);
+        } else {
+            data += Constants::PAGE_END;
+        }
+        
+        for (const auto& entry : entries) {
+            data += "\n";
+            data += std::to_string(entry.number);
+            data += ":";
+            data += std::to_string(entry.timestamp);
+        }
+        
+        return Response::createDataResponse(data);
+    }
+
+    std::unique_ptr<Response> CommandProcessor::processCount(uint64_t low, uint64_t high) {
+        size_t count = 0;
+        ErrorCode result = numberStore.countRange(low, high, count);
+        
+        if (result != ErrorCode::SUCCESS) {
+            return Response::createErrorResponse(result);
         }
         
-        return message;
+        return Response::createSuccessResponse(std::to_string(count));
+    }
+
+    void CommandProcessor::processBatch(const Command& command, Response& outResponse) {
+        const std::vector<uint64_t>& numbers = command.getValues();
+        if (numbers.empty() || numbers.size() > Constants::MAX_BATCH_SIZE) {
+            outResponse.assign(ResponseType::ERROR_RESPONSE, ErrorCode::BATCH_TOO_LARGE);
+            return;
+        }
+        
+        std::vector<bool> rejected;
+        size_t applied = 0;
+        ErrorCode result = command.getCommandType() == CommandType::INSERT_MANY
+                         ? numberStore.insertBatch(numbers, rejected, applied)
+                         : numberStore.removeBatch(numbers, rejected, applied);
+        
+        if (result != ErrorCode::SUCCESS) {
+            outResponse.assign(ResponseType::ERROR_RESPONSE, result);
+            return;
+        }
+        
+        // "<applied> <bitmap>": bit i (LSB first within each byte) marks numbers[i] as a
+        // duplicate (INSERT_MANY) or missing (DELETE_MANY); bytes are written as hex
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+        outResponse.assign(ResponseType::SUCCESS, ErrorCode::SUCCESS);
+        std::string& data = outResponse.getDataBuffer();
+        appendInteger(data, applied);
+        data += ' ';
+        
+        for (size_t byteStart = 0; byteStart < rejected.size(); byteStart += 8) {
+            unsigned int bits = 0;
+            for (size_t bit = 0; bit < 8 && byteStart + bit < rejected.size(); ++bit) {
+                if (rejected[byteStart + bit]) {
+                    bits |= 1u << bit;
+                }
+            }
+            data += HEX_DIGITS[bits >> 4];
+            data += HEX_DIGITS[bits & 0xF];
+        }
+    }
+
+    void CommandProcessor::writeSuccessMessage(Response& outResponse, const char* operation, uint64_t number, int64_t timestamp) {
+        outResponse.assign(ResponseType::SUCCESS, ErrorCode::SUCCESS);
+        std::string& message = outResponse.getDataBuffer();
+        
+        message += "Number ";
+        appendInteger(message, number);
+        message += ' ';
+        message += operation;
+        
+        if (timestamp > 0) {
+            message += " at timestamp ";
+            appendInteger(message, timestamp);
+        }
     }
 }
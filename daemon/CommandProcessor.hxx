@@ -1,16 +1,30 @@
 #ifndef COMMAND_PROCESSOR_HXX
 #define COMMAND_PROCESSOR_HXX
 
+#include "DaemonStats.hxx"
 #include "../protocol/Command.hxx"
 #include "../protocol/Response.hxx"
 #include "../storage/NumberStore.hxx"
+#include "../storage/BackgroundSaver.hxx"
 #include "../utils/ErrorCodes.hxx"
 #include <memory>
+#include <functional>
 
 namespace NumberStore {
+    // Position inside a STREAM_ALL result; holds the snapshot alive between frames
+    struct StreamCursor {
+        std::shared_ptr<const StoreSnapshot> snapshot;
+        StoreSnapshot::Iterator position;
+        std::string chunk;
+        size_t frames = 0;
+        bool active = false;
+    };
+
     class CommandProcessor {
     private:
         NumberStore& numberStore;
+        DaemonStats stats;  // Recorded by the client handlers, reported by STATS
+        BackgroundSaver* backgroundSaver;  // Null unless the store is durable
 
     public:
         explicit CommandProcessor(NumberStore& store);
@@ -20,6 +34,24 @@ namespace NumberStore {
         CommandProcessor& operator=(const CommandProcessor&) = delete;
 
         std::unique_ptr<Response> processCommand(const Command& command);
+        // Fills a caller-owned response; INSERT and DELETE are answered without allocating
+        // once the response buffer has grown to fit
+        void processCommandInto(const Command& command, Response& outResponse);
+        
+        // Commands answered with several frames (STREAM_ALL); each frame is handed to
+        // sendFrame as soon as it is built, and a failed send stops the stream
+        bool isStreamingCommand(const Command& command) const;
+        ErrorCode processStreamingCommand(const Command& command, const std::function<ErrorCode(const Response&)>& sendFrame);
+        
+        // Resumable form of the above for callers that cannot block on a slow reader:
+        // beginStream() takes the snapshot, and each nextStreamFrame() writes one frame,
+        // clearing cursor.active once the final DATA frame has been written
+        void beginStream(StreamCursor& cursor);
+        void nextStreamFrame(StreamCursor& cursor, Response& outFrame);
+        
+        DaemonStats& getStats();
+        // Set at start-up once the store has recovered, before any client connects
+        void setBackgroundSaver(BackgroundSaver* saver);
         
     private:
         std::unique_ptr<Response> processInsert(uint64_t number);
@@ -27,8 +59,13 @@ namespace NumberStore {
         std::unique_ptr<Response> processPrintAll();
         std::unique_ptr<Response> processDeleteAll();
         std::unique_ptr<Response> processExit();
+        std::unique_ptr<Response> processRange(uint64_t low, uint64_t high, size_t limit);
+        std::unique_ptr<Response> processCount(uint64_t low, uint64_t high);
+        std::unique_ptr<Response> processStats();
+        std::unique_ptr<Response> processSave();
+        void processBatch(const Command& command, Response& outResponse);
 
-        std::string createSuccessMessage(const std::string& operation, uint64_t number = 0, int64_t timestamp = 0);
+        void writeSuccessMessage(Response& outResponse, const char* operation, uint64_t number, int64_t timestamp);
     };
 }
 
@@ -2,28 +2,83 @@
 #include "SignalHandler.hxx"
 #include "../utils/Logger.hxx"
 #include "../utils/Config.hxx"
+#include "../ipc/IpcTransport.hxx"
+#ifdef __linux__
+#include "EpollReactor.hxx"
+#endif
+#ifdef NUMBERSTORE_HAVE_IO_URING
+#include "UringReactor.hxx"
+#endif
 #include <algorithm>
 
 namespace NumberStore {
     ConnectionManager::ConnectionManager(CommandProcessor& proc) 
-        : processor(proc), running(false) {
+        : server(IpcTransport::createServer(Config::getInstance().getTransportType())),
+          processor(proc), running(false), acceptingInLoop(false) {
+        processor.getStats().setExecutorSource([this] { return getExecutorStats(); });
     }
 
     ConnectionManager::~ConnectionManager() {
         stop();
+        processor.getStats().setExecutorSource(nullptr);
     }
 
-    ErrorCode ConnectionManager::start(const std::string& pipeName) {
+    ErrorCode ConnectionManager::start(const std::string& address) {
         if (running.load()) {
             return ErrorCode::SUCCESS;
         }
 
-        ErrorCode result = server.start(pipeName);
+        if (!server) {
+            return ErrorCode::PIPE_CREATE_FAILED;
+        }
+
+        ErrorCode result = server->start(address);
         if (result != ErrorCode::SUCCESS) {
-            Logger::getInstance().error("Failed to start named pipe server");
+            Logger::getInstance().error("Failed to start " +
+                                        IpcTransport::getTransportName(Config::getInstance().getTransportType()) + " server");
             return result;
         }
 
+#ifdef __linux__
+        executor = std::make_unique<WorkStealingExecutor>(Config::getInstance().getWorkerThreads());
+        executor->start();
+        
+        bool useUring = false;
+        if (Config::getInstance().getIoBackend() == IoBackend::IO_URING) {
+#ifdef NUMBERSTORE_HAVE_IO_URING
+            // The io_uring loop does stream-socket I/O itself; other transports keep epoll
+            useUring = Config::getInstance().getTransportType() == TransportType::UNIX_STREAM &&
+                       UringReactor::isSupported();
+#endif
+            if (!useUring) {
+                Logger::getInstance().info("io_uring is not available for this transport or kernel; using epoll");
+            }
+        }
+        
+        // All loops exist before any starts, since the accepting one hands clients to the rest
+        for (size_t i = 0; i < Config::getInstance().getReactorThreads(); ++i) {
+            reactors.push_back(createReactor(useUring));
+        }
+        acceptingInLoop = reactors[0]->acceptFrom(*server, [this](std::unique_ptr<IpcConnection> connection) {
+            acceptFromLoop(std::move(connection));
+        });
+        
+        for (auto& reactor : reactors) {
+            if (reactor->start() != ErrorCode::SUCCESS) {
+                Logger::getInstance().error("Failed to start event loop");
+                stopAllClients();
+                reactors.clear();
+                executor.reset();
+                server->stop();
+                acceptingInLoop = false;
+                return ErrorCode::INITIALIZATION_FAILED;
+            }
+        }
+        Logger::getInstance().info("Serving clients from " + std::to_string(reactors.size()) +
+                                   (useUring ? " io_uring" : " epoll") + " event loop threads and " +
+                                   std::to_string(executor->getWorkerCount()) + " command workers");
+#endif
+
         running.store(true);
         Logger::getInstance().info("Connection manager started");
         return ErrorCode::SUCCESS;
@@ -38,7 +93,7 @@ namespace NumberStore {
         running.store(false);
         
         stopAllClients();
-        server.stop();
+        server->stop();
         
         Logger::getInstance().info("Connection manager stopped");
     }
@@ -47,11 +102,15 @@ namespace NumberStore {
         Logger::getInstance().info("Connection manager main loop started");
         
         while (running.load() && !SignalHandler::isShutdownRequested()) {
-            acceptConnections();
+            // acceptConnection() itself waits for the next client, so a client is picked up
+            // as soon as it connects; only a full house, or an event loop that accepts on
+            // its own, needs a pause here
+            if (acceptingInLoop || getActiveConnectionCount() >= Config::getInstance().getMaxConnections()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            } else {
+                acceptConnections();
+            }
             cleanupFinishedClients();
-            
-            // Small delay to prevent busy waiting
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         
         Logger::getInstance().info("Connection manager main loop finished");
@@ -59,28 +118,43 @@ namespace NumberStore {
 
     size_t ConnectionManager::getActiveConnectionCount() const {
         std::lock_guard<std::mutex> lock(connectionsMutex);
-        return std::count_if(clientHandlers.begin(), clientHandlers.end(),
-                           [](const auto& handler) { return handler->isActive(); });
+        size_t count = std::count_if(clientHandlers.begin(), clientHandlers.end(),
+                                     [](const auto& handler) { return handler->isActive(); });
+#ifdef __linux__
+        for (const auto& reactor : reactors) {
+            count += reactor->getClientCount();
+        }
+#endif
+        return count;
     }
 
     bool ConnectionManager::isRunning() const {
         return running.load();
     }
 
-    void ConnectionManager::acceptConnections() {
-        Config& config = Config::getInstance();
-        
-        // Check if we've reached the maximum number of connections
-        if (getActiveConnectionCount() >= config.getMaxConnections()) {
-            return;
+    ExecutorStats ConnectionManager::getExecutorStats() const {
+#ifdef __linux__
+        if (executor) {
+            return executor->getStats();
         }
+#endif
+        return ExecutorStats();
+    }
 
-        // Try to accept a new connection (non-blocking)
-        auto connection = server.acceptConnection();
+    void ConnectionManager::acceptConnections() {
+        // Wait briefly for a new connection
+        auto connection = server->acceptConnection();
         if (!connection) {
             return; // No new connection available
         }
 
+#ifdef __linux__
+        if (!reactors.empty() && connection->getDescriptor() >= 0) {
+            assignToReactor(std::move(connection));
+            return;
+        }
+#endif
+
         // Create client handler and thread
         auto handler = std::make_unique<ClientHandler>(std::move(connection), processor);
         auto thread = std::make_unique<std::thread>(&ClientHandler::run, handler.get());
@@ -96,6 +170,41 @@ namespace NumberStore {
                                  std::to_string(getActiveConnectionCount()));
     }
 
+#ifdef __linux__
+    std::unique_ptr<Reactor> ConnectionManager::createReactor(bool useUring) {
+#ifdef NUMBERSTORE_HAVE_IO_URING
+        if (useUring) {
+            return std::make_unique<UringReactor>(processor, *executor);
+        }
+#else
+        (void)useUring;
+#endif
+        return std::make_unique<EpollReactor>(processor, *executor);
+    }
+
+    void ConnectionManager::assignToReactor(std::unique_ptr<IpcConnection> connection) {
+        auto leastLoaded = std::min_element(reactors.begin(), reactors.end(),
+                                            [](const auto& a, const auto& b) { return a->getClientCount() < b->getClientCount(); });
+        (*leastLoaded)->addConnection(std::move(connection));
+    }
+
+    void ConnectionManager::acceptFromLoop(std::unique_ptr<IpcConnection> connection) {
+        // Runs on the accepting loop's thread, so it counts without connectionsMutex, which
+        // stopAllClients() holds while it joins that thread; every client is on a loop here
+        size_t count = 0;
+        for (const auto& reactor : reactors) {
+            count += reactor->getClientCount();
+        }
+        
+        if (count >= Config::getInstance().getMaxConnections()) {
+            Logger::getInstance().warning("Connection limit reached; refusing client");
+            connection->disconnect();
+            return;
+        }
+        assignToReactor(std::move(connection));
+    }
+#endif
+
     void ConnectionManager::cleanupFinishedClients() {
         std::lock_guard<std::mutex> lock(connectionsMutex);
         
@@ -110,7 +219,7 @@ namespace NumberStore {
                     (*threadIt)->join();
                 }
                 
-                Logger::getInstance().debug("Cleaned up finished client: " + (*handlerIt)->getClientId());
+                NS_LOG_DEBUG("Cleaned up finished client: " + (*handlerIt)->getClientId());
                 
                 threadIt = clientThreads.erase(threadIt);
                 handlerIt = clientHandlers.erase(handlerIt);
@@ -130,5 +239,22 @@ namespace NumberStore {
         for (auto& handler : clientHandlers) {
             handler->stop();
         }
+        
+#ifdef __linux__
+        for (auto& reactor : reactors) {
+            reactor->stop();
+        }
+        
+        if (executor) {
+            executor->stop();
+            
+            ExecutorStats stats = executor->getStats();
+            Logger::getInstance().info("Command executor: " + std::to_string(stats.tasksExecuted) + " batches, " +
+                                       std::to_string(stats.steals) + " stolen, deepest queue " +
+                                       std::to_string(stats.maxQueueDepth) + ", idle " +
+                                       std::to_string(stats.idleMicroseconds / 1000) + " ms over " +
+                                       std::to_string(stats.workers) + " workers");
+        }
+#endif
     }
 }
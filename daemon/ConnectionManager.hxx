@@ -1,9 +1,13 @@
 #ifndef CONNECTION_MANAGER_HXX
 #define CONNECTION_MANAGER_HXX
 
-#include "../ipc/NamedPipeServer.hxx"
+#include "../ipc/IpcServer.hxx"
 #include "ClientHandler.hxx"
 #include "CommandProcessor.hxx"
+#include "WorkStealingExecutor.hxx"
+#ifdef __linux__
+#include "Reactor.hxx"
+#endif
 #include <vector>
 #include <memory>
 #include <thread>
@@ -13,12 +17,21 @@
 namespace NumberStore {
     class ConnectionManager {
     private:
-        NamedPipeServer server;
+        std::unique_ptr<IpcServer> server;
         CommandProcessor& processor;
         std::vector<std::unique_ptr<std::thread>> clientThreads;
         std::vector<std::unique_ptr<ClientHandler>> clientHandlers;
+#ifdef __linux__
+        // Event loops that multiplex every client; clients only get a thread of their own
+        // when their transport has no pollable descriptor
+        std::vector<std::unique_ptr<Reactor>> reactors;
+        // Runs the commands the event loops parse; declared after them so its workers,
+        // which post completions to the loops, are joined first
+        std::unique_ptr<WorkStealingExecutor> executor;
+#endif
         mutable std::mutex connectionsMutex;
         std::atomic<bool> running;
+        bool acceptingInLoop;   // The first event loop accepts clients itself (io_uring)
 
     public:
         explicit ConnectionManager(CommandProcessor& proc);
@@ -29,15 +42,22 @@ namespace NumberStore {
         ConnectionManager(ConnectionManager&&) = delete;
         ConnectionManager& operator=(ConnectionManager&&) = delete;
 
-        ErrorCode start(const std::string& pipeName);
+        ErrorCode start(const std::string& address);
         void stop();
         void run();
         
         size_t getActiveConnectionCount() const;
         bool isRunning() const;
+        // Zeroes when clients are served by a thread each
+        ExecutorStats getExecutorStats() const;
         
     private:
         void acceptConnections();
+#ifdef __linux__
+        std::unique_ptr<Reactor> createReactor(bool useUring);
+        void assignToReactor(std::unique_ptr<IpcConnection> connection);
+        void acceptFromLoop(std::unique_ptr<IpcConnection> connection);
+#endif
         void cleanupFinishedClients();
         void stopAllClients();
         void waitForAllClients();
@@ -8,6 +8,11 @@
 
 int main() {
     try {
+        // Before anything starts a thread (the logger's writer included): threads inherit
+        // the blocked SIGINT/SIGTERM, so only the sigwait thread takes them and the server
+        // is stopped cleanly instead of the process being killed
+        NumberStore::SignalHandler::setupSignalHandlers();
+        
         // Initialize configuration
         NumberStore::Config& config = NumberStore::Config::getInstance();
         config.loadDefaults();
@@ -35,13 +40,17 @@ int main() {
             return 1;
         }
         
-        // Set up signal handlers for graceful shutdown
-        NumberStore::SignalHandler::setupSignalHandlers();
-        
         // Create and start the daemon server
         NumberStore::DaemonServer server;
         NumberStore::SignalHandler::registerServer(&server);
         
+        // A signal taken before the server was registered had nothing to stop
+        if (NumberStore::SignalHandler::isShutdownRequested()) {
+            logger.info("Shutdown requested during startup");
+            instanceManager.unlock();
+            return 0;
+        }
+        
         NumberStore::ErrorCode startResult = server.start();
         if (startResult != NumberStore::ErrorCode::SUCCESS) {
             logger.error("Failed to start daemon server: " + 
@@ -2,6 +2,7 @@
 #include "SignalHandler.hxx"
 #include "../utils/Logger.hxx"
 #include "../utils/Config.hxx"
+#include "../ipc/IpcTransport.hxx"
 
 namespace NumberStore {
     DaemonServer::DaemonServer() : running(false) {
@@ -21,8 +22,21 @@ namespace NumberStore {
 
         Logger::getInstance().info("Starting daemon server");
         
+        ErrorCode result = numberStore.recover();
+        if (result != ErrorCode::SUCCESS) {
+            Logger::getInstance().error("Failed to recover stored numbers");
+            return result;
+        }
+        
         Config& config = Config::getInstance();
-        ErrorCode result = connectionManager->start(config.getPipeName());
+        if (numberStore.isDurable()) {
+            backgroundSaver = std::make_unique<BackgroundSaver>(numberStore, config.getSaveWriteThreshold(),
+                                                                std::chrono::seconds(config.getSaveInterval()));
+            backgroundSaver->start();
+            processor->setBackgroundSaver(backgroundSaver.get());
+        }
+        
+        result = connectionManager->start(IpcTransport::getAddress());
         
         if (result != ErrorCode::SUCCESS) {
             Logger::getInstance().error("Failed to start connection manager");
@@ -50,6 +64,15 @@ namespace NumberStore {
             serverThread->join();
         }
         
+        if (backgroundSaver) {
+            backgroundSaver->stop();
+        }
+        
+        // Checkpoint so the next start maps a compact image instead of replaying the
+        // whole log, then flush the write-ahead log before the process exits below
+        numberStore.checkpoint();
+        numberStore.shutdown();
+        
         Logger::getInstance().info("Daemon server stopped");
         std::exit(0);
     }
@@ -4,6 +4,7 @@
 #include "ConnectionManager.hxx"
 #include "CommandProcessor.hxx"
 #include "../storage/NumberStore.hxx"
+#include "../storage/BackgroundSaver.hxx"
 #include "../utils/ErrorCodes.hxx"
 #include <memory>
 #include <thread>
@@ -13,6 +14,7 @@ namespace NumberStore {
     class DaemonServer {
     private:
         NumberStore numberStore;
+        std::unique_ptr<BackgroundSaver> backgroundSaver;
         std::unique_ptr<CommandProcessor> processor;
         std::unique_ptr<ConnectionManager> connectionManager;
         std::unique_ptr<std::thread> serverThread;
@@ -0,0 +1,195 @@
+#include "DaemonStats.hxx"
+#include <chrono>
+#include <cstdio>
+
+namespace NumberStore {
+    namespace {
+        // Two decimals; Bloom filter rates are around one percent
+        std::string formatPercent(double ratio) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.2f", ratio * 100.0);
+            return text;
+        }
+    }
+
+    DaemonStats::DaemonStats()
+        : histograms(new LatencyHistogram[COMMAND_TYPES * STAGES]), operations(0), bytesIn(0), bytesOut(0),
+          activeConnections(0), totalConnections(0) {
+        for (auto& count : errors) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t DaemonStats::now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void DaemonStats::recordStage(CommandType type, RequestStage stage, uint64_t nanos) {
+        size_t index = static_cast<size_t>(type);
+        if (index < COMMAND_TYPES) {
+            histograms[index * STAGES + static_cast<size_t>(stage)].record(nanos);
+        }
+    }
+
+    void DaemonStats::countOperation() {
+        operations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void DaemonStats::countError(ErrorCode code) {
+        size_t index = static_cast<size_t>(code);
+        if (index < ERROR_CODES) {
+            errors[index].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void DaemonStats::addBytesIn(size_t bytes) {
+        bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void DaemonStats::addBytesOut(size_t bytes) {
+        bytesOut.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void DaemonStats::connectionOpened() {
+        activeConnections.fetch_add(1, std::memory_order_relaxed);
+        totalConnections.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void DaemonStats::connectionClosed() {
+        activeConnections.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    uint64_t DaemonStats::getOperationCount() const {
+        return operations.load(std::memory_order_relaxed);
+    }
+
+    int64_t DaemonStats::getActiveConnections() const {
+        return activeConnections.load(std::memory_order_relaxed);
+    }
+
+    LatencyHistogram::Summary DaemonStats::summarize(CommandType type, RequestStage stage) const {
+        size_t index = static_cast<size_t>(type);
+        if (index >= COMMAND_TYPES) {
+            return LatencyHistogram::Summary();
+        }
+        return histograms[index * STAGES + static_cast<size_t>(stage)].summarize();
+    }
+
+    void DaemonStats::setExecutorSource(std::function<ExecutorStats()> source) {
+        executorSource = std::move(source);
+    }
+
+    std::string DaemonStats::report(uint64_t snapshotRebuilds, const StoreMemoryUsage& memory, const FilterStats& filter,
+                                    const BackgroundSaver::Status* save) const {
+        std::string out;
+        out += "ops " + std::to_string(operations.load(std::memory_order_relaxed));
+        out += "\nbytes_in " + std::to_string(bytesIn.load(std::memory_order_relaxed));
+        out += "\nbytes_out " + std::to_string(bytesOut.load(std::memory_order_relaxed));
+        out += "\nactive_connections " + std::to_string(activeConnections.load(std::memory_order_relaxed));
+        out += "\ntotal_connections " + std::to_string(totalConnections.load(std::memory_order_relaxed));
+        out += "\nsnapshot_rebuilds " + std::to_string(snapshotRebuilds);
+
+        // No workers when clients are served by a thread each
+        ExecutorStats executor = executorSource ? executorSource() : ExecutorStats();
+        if (executor.workers > 0) {
+            out += "\nexecutor.workers " + std::to_string(executor.workers);
+            out += "\nexecutor.tasks " + std::to_string(executor.tasksExecuted);
+            out += "\nexecutor.steals " + std::to_string(executor.steals);
+            out += "\nexecutor.queue_depth " + std::to_string(executor.queueDepth);
+            out += "\nexecutor.max_queue_depth " + std::to_string(executor.maxQueueDepth);
+            out += "\nexecutor.idle_ms " + std::to_string(executor.idleMicroseconds / 1000);
+        }
+        if (save) {
+            // The last_* figures describe the most recent attempt, successful or not
+            out += "\nsave.in_progress " + std::to_string(save->inProgress ? 1 : 0);
+            out += "\nsave.completed " + std::to_string(save->completedSaves);
+            out += "\nsave.failed " + std::to_string(save->failedSaves);
+            out += "\nsave.last_success_time " + std::to_string(save->lastSaveTime);
+            out += "\nsave.last_result " + std::string(errorCodeName(static_cast<size_t>(save->lastResult)));
+            out += "\nsave.last_entries " + std::to_string(save->lastStats.entryCount);
+            out += "\nsave.last_capture_us " + std::to_string(save->lastStats.captureMicros);
+            out += "\nsave.last_write_ms " + std::to_string(save->lastStats.writeMillis);
+            out += "\nsave.last_copied_bytes " + std::to_string(save->lastStats.copiedNodeBytes);
+        }
+        out += "\nmemory.node_bytes_live " + std::to_string(memory.nodeBytesLive);
+        out += "\nmemory.node_bytes_reserved " + std::to_string(memory.nodeBytesReserved);
+        out += "\nmemory.node_blocks_live " + std::to_string(memory.nodeBlocksLive);
+        out += "\nmemory.fragmentation_pct " + std::to_string(static_cast<unsigned>(memory.fragmentation * 100.0 + 0.5));
+        out += "\nmemory.index_bytes " + std::to_string(memory.indexBytes);
+        out += "\nmemory.snapshot_copied_bytes " + std::to_string(memory.copiedNodeBytes);
+
+        if (filter.enabled) {
+            // Measured over absent numbers only: the share the filter failed to rule out
+            uint64_t absent = filter.definiteMisses + filter.falsePositives;
+            double measured = absent > 0 ? static_cast<double>(filter.falsePositives) / static_cast<double>(absent) : 0.0;
+            out += "\nbloom.definite_misses " + std::to_string(filter.definiteMisses);
+            out += "\nbloom.false_positives " + std::to_string(filter.falsePositives);
+            out += "\nbloom.false_positive_pct " + formatPercent(measured);
+            out += "\nbloom.expected_false_positive_pct " + formatPercent(filter.expectedFalsePositiveRate);
+            out += "\nbloom.rebuilds " + std::to_string(filter.rebuilds);
+            out += "\nbloom.bytes " + std::to_string(filter.bytes);
+        }
+
+        for (size_t code = 0; code < ERROR_CODES; ++code) {
+            uint64_t count = errors[code].load(std::memory_order_relaxed);
+            if (count > 0) {
+                out += "\nerrors." + std::string(errorCodeName(code)) + " " + std::to_string(count);
+            }
+        }
+
+        for (size_t type = 0; type < COMMAND_TYPES; ++type) {
+            for (size_t stage = 0; stage < STAGES; ++stage) {
+                LatencyHistogram::Summary summary = histograms[type * STAGES + stage].summarize();
+                if (summary.count == 0) {
+                    continue;
+                }
+
+                out += "\nlatency_ns." + Command::getTypeName(static_cast<CommandType>(type)) + "." + stageName(stage);
+                out += " count=" + std::to_string(summary.count);
+                out += " p50=" + std::to_string(summary.p50);
+                out += " p99=" + std::to_string(summary.p99);
+                out += " p999=" + std::to_string(summary.p999);
+                out += " max=" + std::to_string(summary.max);
+            }
+        }
+        return out;
+    }
+
+    const char* DaemonStats::stageName(size_t stage) {
+        switch (static_cast<RequestStage>(stage)) {
+            case RequestStage::READ: return "read";
+            case RequestStage::PARSE: return "parse";
+            case RequestStage::LOCK_WAIT: return "lock_wait";
+            case RequestStage::EXECUTE: return "execute";
+            case RequestStage::SERIALIZE: return "serialize";
+            case RequestStage::WRITE: return "write";
+            default: return "unknown";
+        }
+    }
+
+    const char* DaemonStats::errorCodeName(size_t code) {
+        switch (static_cast<ErrorCode>(code)) {
+            case ErrorCode::SUCCESS: return "SUCCESS";
+            case ErrorCode::INVALID_NUMBER: return "INVALID_NUMBER";
+            case ErrorCode::DUPLICATE_NUMBER: return "DUPLICATE_NUMBER";
+            case ErrorCode::NUMBER_NOT_FOUND: return "NUMBER_NOT_FOUND";
+            case ErrorCode::CONNECTION_FAILED: return "CONNECTION_FAILED";
+            case ErrorCode::SERIALIZATION_ERROR: return "SERIALIZATION_ERROR";
+            case ErrorCode::INVALID_COMMAND: return "INVALID_COMMAND";
+            case ErrorCode::PIPE_CREATE_FAILED: return "PIPE_CREATE_FAILED";
+            case ErrorCode::PIPE_CONNECT_FAILED: return "PIPE_CONNECT_FAILED";
+            case ErrorCode::READ_FAILED: return "READ_FAILED";
+            case ErrorCode::WRITE_FAILED: return "WRITE_FAILED";
+            case ErrorCode::TIMEOUT: return "TIMEOUT";
+            case ErrorCode::SHUTDOWN_REQUESTED: return "SHUTDOWN_REQUESTED";
+            case ErrorCode::INITIALIZATION_FAILED: return "INITIALIZATION_FAILED";
+            case ErrorCode::INSTANCE_ALREADY_RUNNING: return "INSTANCE_ALREADY_RUNNING";
+            case ErrorCode::PERSISTENCE_FAILED: return "PERSISTENCE_FAILED";
+            case ErrorCode::INVALID_RANGE: return "INVALID_RANGE";
+            case ErrorCode::BATCH_TOO_LARGE: return "BATCH_TOO_LARGE";
+            case ErrorCode::WOULD_BLOCK: return "WOULD_BLOCK";
+            default: return "UNKNOWN";
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef DAEMON_STATS_HXX
+#define DAEMON_STATS_HXX
+
+#include "WorkStealingExecutor.hxx"
+#include "../protocol/Command.hxx"
+#include "../storage/NumberStore.hxx"
+#include "../storage/BackgroundSaver.hxx"
+#include "../utils/LatencyHistogram.hxx"
+#include "../utils/ErrorCodes.hxx"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace NumberStore {
+    // Where a request's time goes, in the order it passes through the daemon
+    enum class RequestStage {
+        READ,       // Taking the message off the connection (event-loop mode; a thread's blocking wait is not counted)
+        PARSE,
+        LOCK_WAIT,  // Blocked on contended shard locks, part of EXECUTE
+        EXECUTE,
+        SERIALIZE,
+        WRITE       // Handing the reply to the connection
+    };
+
+    // Daemon-wide request instrumentation, answered by the STATS command: a latency
+    // histogram per command type and stage, plus counters. Everything is recorded with
+    // relaxed atomics from loop and worker threads, so readers see a close but not
+    // instantaneous picture.
+    class DaemonStats {
+    public:
+        static const size_t COMMAND_TYPES = 16;    // Room for every CommandType value
+        static const size_t STAGES = 6;
+        static const size_t ERROR_CODES = 32;      // Room for every ErrorCode value
+
+    private:
+        std::unique_ptr<LatencyHistogram[]> histograms;  // [command type][stage]
+        std::atomic<uint64_t> operations;
+        std::atomic<uint64_t> errors[ERROR_CODES];
+        std::atomic<uint64_t> bytesIn;
+        std::atomic<uint64_t> bytesOut;
+        std::atomic<int64_t> activeConnections;
+        std::atomic<uint64_t> totalConnections;
+        std::function<ExecutorStats()> executorSource;
+
+    public:
+        DaemonStats();
+        ~DaemonStats() = default;
+
+        DaemonStats(const DaemonStats&) = delete;
+        DaemonStats& operator=(const DaemonStats&) = delete;
+
+        // Monotonic nanoseconds for timing stages
+        static uint64_t now();
+
+        void recordStage(CommandType type, RequestStage stage, uint64_t nanos);
+        void countOperation();
+        void countError(ErrorCode code);
+        void addBytesIn(size_t bytes);
+        void addBytesOut(size_t bytes);
+        void connectionOpened();
+        void connectionClosed();
+
+        uint64_t getOperationCount() const;
+        int64_t getActiveConnections() const;
+        LatencyHistogram::Summary summarize(CommandType type, RequestStage stage) const;
+
+        // Where report() reads the command executor's counters; set once at start-up,
+        // before any client can ask for STATS
+        void setExecutorSource(std::function<ExecutorStats()> source);
+
+        // "name value" lines: the counters, the executor, background saves (save is null
+        // when the store is not durable), the store's memory use and Bloom filter hit rates,
+        // then one line per command type and stage that has samples, with count, p50, p99,
+        // p999 and max in nanoseconds
+        std::string report(uint64_t snapshotRebuilds, const StoreMemoryUsage& memory, const FilterStats& filter,
+                           const BackgroundSaver::Status* save) const;
+
+    private:
+        static const char* stageName(size_t stage);
+        static const char* errorCodeName(size_t code);
+    };
+}
+
+#endif // DAEMON_STATS_HXX
@@ -0,0 +1,109 @@
+#include "EpollReactor.hxx"
+#include "../utils/Logger.hxx"
+#include <cstring>
+#include <cerrno>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace NumberStore {
+    EpollReactor::EpollReactor(CommandProcessor& proc, WorkStealingExecutor& exec)
+        : Reactor(proc, exec), epollFd(-1) {
+    }
+
+    EpollReactor::~EpollReactor() {
+        stop();
+
+        if (epollFd >= 0) {
+            ::close(epollFd);
+        }
+    }
+
+    ErrorCode EpollReactor::initialize() {
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            Logger::getInstance().error("Failed to create event loop: " + std::string(std::strerror(errno)));
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = wakeFd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) != 0) {
+            Logger::getInstance().error("Failed to register wake descriptor: " + std::string(std::strerror(errno)));
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    void EpollReactor::run() {
+        epoll_event events[MAX_EVENTS];
+        
+        while (running.load()) {
+            int count = ::epoll_wait(epollFd, events, MAX_EVENTS, -1);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                Logger::getInstance().error("epoll_wait failed: " + std::string(std::strerror(errno)));
+                break;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                if (events[i].data.fd == wakeFd) {
+                    clearWake();
+                    adoptIncoming();
+                    drainCompletions();
+                } else {
+                    uint32_t ready = events[i].events;
+                    serviceClient(events[i].data.fd, (ready & EPOLLIN) != 0, (ready & EPOLLOUT) != 0,
+                                  (ready & (EPOLLHUP | EPOLLERR)) != 0);
+                }
+            }
+        }
+
+        waitForExecutingClients();
+        closeAllClients();
+    }
+
+    bool EpollReactor::registerClient(int fd, Client& client) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            return false;
+        }
+
+        client.events = EPOLLIN;
+        return true;
+    }
+
+    void EpollReactor::updateInterest(int fd, Client& client) {
+        if (client.detached) {
+            return;
+        }
+        
+        // Reading pauses while replies back up, so a client that stops reading cannot make
+        // the daemon queue without bound; level-triggered EPOLLOUT wakes it once they drain
+        uint32_t wanted = (client.handler->wantsRead() ? EPOLLIN : 0u) |
+                          (client.handler->wantsWrite() ? EPOLLOUT : 0u);
+        if (wanted == client.events) {
+            return;
+        }
+
+        epoll_event event{};
+        event.events = wanted;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event) == 0) {
+            client.events = wanted;
+        } else {
+            Logger::getInstance().error("Failed to update event interest: " + std::string(std::strerror(errno)));
+        }
+    }
+
+    void EpollReactor::releaseClient(int fd, Client& client) {
+        // Also silences the hangup epoll would otherwise report on every wait
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        client.events = 0;
+    }
+}
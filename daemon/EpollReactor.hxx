@@ -0,0 +1,28 @@
+#ifndef EPOLL_REACTOR_HXX
+#define EPOLL_REACTOR_HXX
+
+#include "Reactor.hxx"
+
+namespace NumberStore {
+    // Readiness-driven event loop: epoll reports which sockets can be read or written
+    // and the connections do their own non-blocking recv and sendmsg calls
+    class EpollReactor : public Reactor {
+    private:
+        int epollFd;
+
+    public:
+        EpollReactor(CommandProcessor& proc, WorkStealingExecutor& exec);
+        ~EpollReactor() override;
+
+        static const int MAX_EVENTS = 256;
+
+    protected:
+        ErrorCode initialize() override;
+        void run() override;
+        bool registerClient(int fd, Client& client) override;
+        void updateInterest(int fd, Client& client) override;
+        void releaseClient(int fd, Client& client) override;
+    };
+}
+
+#endif // EPOLL_REACTOR_HXX
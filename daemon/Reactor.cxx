@@ -0,0 +1,237 @@
+#include "Reactor.hxx"
+#include "../utils/Logger.hxx"
+#include <cstring>
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace NumberStore {
+    Reactor::Reactor(CommandProcessor& proc, WorkStealingExecutor& exec)
+        : processor(proc), executor(exec), wakeFd(-1), running(false), clientCount(0),
+          nextGeneration(0), executingClients(0) {
+    }
+
+    Reactor::~Reactor() {
+        stop();
+
+        if (wakeFd >= 0) {
+            ::close(wakeFd);
+        }
+    }
+
+    ErrorCode Reactor::start() {
+        if (running.load()) {
+            return ErrorCode::SUCCESS;
+        }
+
+        wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0) {
+            Logger::getInstance().error("Failed to create event loop: " + std::string(std::strerror(errno)));
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        ErrorCode result = initialize();
+        if (result != ErrorCode::SUCCESS) {
+            return result;
+        }
+
+        running.store(true);
+        loopThread = std::make_unique<std::thread>(&Reactor::run, this);
+        return ErrorCode::SUCCESS;
+    }
+
+    void Reactor::stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+
+        wake();
+        if (loopThread && loopThread->joinable()) {
+            loopThread->join();
+        }
+    }
+
+    void Reactor::addConnection(std::unique_ptr<IpcConnection> connection) {
+        clientCount.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(incomingMutex);
+            incoming.push_back(std::move(connection));
+        }
+        wake();
+    }
+
+    size_t Reactor::getClientCount() const {
+        return clientCount.load();
+    }
+
+    bool Reactor::acceptFrom(IpcServer&, std::function<void(std::unique_ptr<IpcConnection>)>) {
+        return false;
+    }
+
+    void Reactor::adoptIncoming() {
+        std::vector<std::unique_ptr<IpcConnection>> batch;
+        {
+            std::lock_guard<std::mutex> lock(incomingMutex);
+            batch.swap(incoming);
+        }
+
+        for (auto& connection : batch) {
+            int fd = connection->getDescriptor();
+            Client& client = clients[fd];
+            client.handler = std::make_unique<ClientHandler>(std::move(connection), processor);
+            client.generation = ++nextGeneration;
+
+            if (client.handler->attachToEventLoop() != ErrorCode::SUCCESS || !registerClient(fd, client)) {
+                Logger::getInstance().error("Failed to add client " + client.handler->getClientId() + " to the event loop");
+                client.handler->close();
+                clients.erase(fd);
+                clientCount.fetch_sub(1);
+                continue;
+            }
+
+            Logger::getInstance().info("Client handler started for client: " + client.handler->getClientId());
+        }
+    }
+
+    void Reactor::drainCompletions() {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completing.swap(completed);
+        }
+
+        for (int fd : completing) {
+            auto it = clients.find(fd);
+            if (it == clients.end()) {
+                continue;
+            }
+
+            --executingClients;
+            Client& client = it->second;
+            bool keep = client.handler->completeExecution();
+
+            // No new batches once stop() has been called
+            if (!keep || client.detached || !client.handler->isActive() || !running.load()) {
+                closeClient(fd);
+            } else {
+                dispatch(fd, client);
+            }
+        }
+        completing.clear();
+    }
+
+    void Reactor::serviceClient(int fd, bool readable, bool writable, bool hangup) {
+        auto it = clients.find(fd);
+        if (it == clients.end() || it->second.detached) {
+            return;
+        }
+
+        Client& client = it->second;
+        ClientHandler& handler = *client.handler;
+        if (hangup && handler.isExecuting()) {
+            closeClient(fd);
+            return;
+        }
+
+        bool keep = true;
+        if (writable) {
+            keep = handler.onWritable();
+        }
+        if (keep && (readable || hangup)) {
+            keep = handler.onReadable();
+        }
+
+        if (!keep || !handler.isActive()) {
+            closeClient(fd);
+            return;
+        }
+
+        dispatch(fd, client);
+    }
+
+    void Reactor::dispatch(int fd, Client& client) {
+        // At most one batch per client is ever out, which is what keeps its replies in order
+        ClientHandler* handler = client.handler.get();
+        if (handler->readyToExecute()) {
+            handler->beginExecution();
+            ++executingClients;
+            executor.submit([this, handler] {
+                handler->execute();
+                postCompletion(handler->getDescriptor());
+            }, static_cast<size_t>(fd));
+        }
+        updateInterest(fd, client);
+    }
+
+    void Reactor::closeClient(int fd) {
+        auto it = clients.find(fd);
+        if (it == clients.end()) {
+            return;
+        }
+
+        Client& client = it->second;
+        if (!client.detached) {
+            releaseClient(fd, client);
+            client.detached = true;
+        }
+        if (client.handler->isExecuting() || client.operations > 0) {
+            // A worker or the kernel still holds the client; whichever finishes last
+            // brings it back here
+            return;
+        }
+
+        client.handler->close();
+        Logger::getInstance().info("Client handler finished for client: " + client.handler->getClientId());
+
+        clients.erase(it);
+        clientCount.fetch_sub(1);
+    }
+
+    void Reactor::waitForExecutingClients() {
+        pollfd wakeEvent{};
+        wakeEvent.fd = wakeFd;
+        wakeEvent.events = POLLIN;
+
+        while (executingClients > 0) {
+            if (::poll(&wakeEvent, 1, 100) > 0) {
+                clearWake();
+            }
+            drainCompletions();
+        }
+    }
+
+    void Reactor::closeAllClients() {
+        for (auto& entry : clients) {
+            entry.second.handler->close();
+        }
+        clients.clear();
+
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        for (auto& connection : incoming) {
+            connection->disconnect();
+        }
+        incoming.clear();
+        clientCount.store(0);
+    }
+
+    void Reactor::clearWake() {
+        uint64_t signals = 0;
+        ssize_t ignored = ::read(wakeFd, &signals, sizeof(signals));
+        (void)ignored;
+    }
+
+    void Reactor::wake() {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void Reactor::postCompletion(int fd) {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completed.push_back(fd);
+        }
+        wake();
+    }
+}
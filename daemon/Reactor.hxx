@@ -0,0 +1,102 @@
+#ifndef REACTOR_HXX
+#define REACTOR_HXX
+
+#include "ClientHandler.hxx"
+#include "CommandProcessor.hxx"
+#include "WorkStealingExecutor.hxx"
+#include "../ipc/IpcConnection.hxx"
+#include "../ipc/IpcServer.hxx"
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+namespace NumberStore {
+    // One event-loop thread serving many clients (Linux only). The ConnectionManager
+    // hands each accepted client to the least loaded loop, which owns it from then on;
+    // idle clients cost a descriptor and a small buffer instead of a blocked thread.
+    // The loop only moves bytes: parsed requests run on the shared executor, and their
+    // replies come back here to be sent. Backends (EpollReactor, UringReactor) supply
+    // the I/O mechanics through the hooks below, all of which run on the loop thread.
+    class Reactor {
+    protected:
+        struct Client {
+            std::unique_ptr<ClientHandler> handler;
+            uint32_t events = 0;        // Backend bookkeeping: what is watched or in flight
+            uint32_t generation = 0;    // Tells completions for a reused descriptor from its predecessor's
+            uint32_t operations = 0;    // Backend operations in flight that point into the client
+            bool detached = false;      // Gone while still in use; closed once released
+        };
+
+        CommandProcessor& processor;
+        WorkStealingExecutor& executor;
+        int wakeFd;             // eventfd: new connections or completed batches are waiting, or stop was requested
+        std::atomic<bool> running;
+
+        // Owned by the loop thread
+        std::unordered_map<int, Client> clients;
+
+    private:
+        std::unique_ptr<std::thread> loopThread;
+        std::atomic<size_t> clientCount;
+        uint32_t nextGeneration;
+
+        std::mutex incomingMutex;
+        std::vector<std::unique_ptr<IpcConnection>> incoming;
+
+        std::mutex completionMutex;
+        std::vector<int> completed;     // Clients whose batch a worker has finished
+        std::vector<int> completing;
+        size_t executingClients;
+
+    public:
+        Reactor(CommandProcessor& proc, WorkStealingExecutor& exec);
+        virtual ~Reactor();
+
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+
+        ErrorCode start();
+        // Backends must call this from their own destructor, while their state still exists
+        void stop();
+
+        // Thread-safe; the connection is registered on the reactor's own thread
+        void addConnection(std::unique_ptr<IpcConnection> connection);
+        size_t getClientCount() const;
+
+        // Lets the loop accept clients itself instead of the ConnectionManager's accept
+        // loop; onAccepted runs on the loop thread for each one. Must be called before
+        // start(); returns false if the backend cannot
+        virtual bool acceptFrom(IpcServer& server, std::function<void(std::unique_ptr<IpcConnection>)> onAccepted);
+
+    protected:
+        virtual ErrorCode initialize() = 0;
+        // The loop; once running is cleared it waits for executing clients and closes them all
+        virtual void run() = 0;
+        virtual bool registerClient(int fd, Client& client) = 0;
+        virtual void updateInterest(int fd, Client& client) = 0;
+        // Stop watching a client that is about to be closed or detached
+        virtual void releaseClient(int fd, Client& client) = 0;
+
+        void adoptIncoming();
+        void drainCompletions();
+        void serviceClient(int fd, bool readable, bool writable, bool hangup);
+        void dispatch(int fd, Client& client);
+        // Closes now, or detaches until a running batch or backend operation lets go
+        void closeClient(int fd);
+        // Waits out batches still on workers, which point at their handlers
+        void waitForExecutingClients();
+        void closeAllClients();
+        void clearWake();
+        void wake();
+
+    private:
+        void postCompletion(int fd);
+    };
+}
+
+#endif // REACTOR_HXX
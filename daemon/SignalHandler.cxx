@@ -1,14 +1,21 @@
 #include "SignalHandler.hxx"
 #include "DaemonServer.hxx"
 #include "../utils/Logger.hxx"
-#include <windows.h>
 #include <signal.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <thread>
+#endif
+
 namespace NumberStore {
     std::atomic<bool> SignalHandler::shutdownRequested{false};
     DaemonServer* SignalHandler::serverInstance = nullptr;
     bool SignalHandler::initialized = false;
 
+#ifdef _WIN32
     BOOL WINAPI ConsoleHandler(DWORD signal) {
         if (signal == CTRL_C_EVENT || signal == CTRL_CLOSE_EVENT || signal == CTRL_BREAK_EVENT) {
             Logger::getInstance().info("Shutdown signal received");
@@ -17,12 +24,24 @@ namespace NumberStore {
         }
         return FALSE;
     }
+#else
+    namespace {
+        sigset_t shutdownSignals() {
+            sigset_t signals;
+            sigemptyset(&signals);
+            sigaddset(&signals, SIGINT);
+            sigaddset(&signals, SIGTERM);
+            return signals;
+        }
+    }
+#endif
 
     void SignalHandler::setupSignalHandlers() {
         if (initialized) {
             return;
         }
 
+#ifdef _WIN32
         // Set up console control handler for Windows
         if (!SetConsoleCtrlHandler(ConsoleHandler, TRUE)) {
             Logger::getInstance().error("Failed to set console control handler");
@@ -31,6 +50,21 @@ namespace NumberStore {
         // Set up signal handlers for standard signals
         signal(SIGINT, signalCallback);
         signal(SIGTERM, signalCallback);
+#else
+        // Shutdown stops the server, which is not async-signal-safe, so SIGINT/SIGTERM are
+        // blocked (threads started later inherit the mask) and taken by a sigwait thread
+        sigset_t signals = shutdownSignals();
+        if (pthread_sigmask(SIG_BLOCK, &signals, nullptr) != 0) {
+            Logger::getInstance().error("Failed to block shutdown signals");
+        } else {
+            std::thread([signals]() {
+                int received = 0;
+                while (sigwait(&signals, &received) == 0) {
+                    signalCallback(received);
+                }
+            }).detach();
+        }
+#endif
 
         initialized = true;
         Logger::getInstance().info("Signal handlers initialized");
@@ -48,26 +82,30 @@ namespace NumberStore {
     void SignalHandler::requestShutdown() {
         if (!shutdownRequested.exchange(true)) {
             Logger::getInstance().info("Shutdown requested");
-            serverInstance->stop();
+            if (serverInstance) {
+                serverInstance->stop();
+            }
         }
     }
 
     void SignalHandler::registerServer(DaemonServer* server) {
         serverInstance = server;
-        Logger::getInstance().debug("Daemon server registered with signal handler");
+        NS_LOG_DEBUG("Daemon server registered with signal handler");
     }
 
     void SignalHandler::cleanup() {
         if (initialized) {
+#ifdef _WIN32
             SetConsoleCtrlHandler(ConsoleHandler, FALSE);
             signal(SIGINT, SIG_DFL);
             signal(SIGTERM, SIG_DFL);
+#endif
             
             serverInstance = nullptr;
             shutdownRequested.store(false);
             initialized = false;
             
-            Logger::getInstance().debug("Signal handler cleanup completed");
+            NS_LOG_DEBUG("Signal handler cleanup completed");
         }
     }
 }
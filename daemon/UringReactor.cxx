@@ -0,0 +1,531 @@
+#include "UringReactor.hxx"
+#include "../utils/Logger.hxx"
+#include "../utils/Constants.hxx"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace NumberStore {
+    namespace {
+        // What a completion belongs to, packed into its user_data as
+        // operation << 56 | tag << 32 | descriptor; the tag is the client's generation
+        // for receives and the slot index for sends
+        enum Operation : uint64_t {
+            OP_WAKE = 1,
+            OP_ACCEPT,
+            OP_ACCEPT_RETRY,
+            OP_RECEIVE,
+            OP_SEND,
+            OP_CANCEL
+        };
+
+        // Client::events bits
+        const uint32_t RECEIVING = 1;   // Multishot recv armed
+        const uint32_t CANCELLING = 2;  // ... and asked to stop
+        const uint32_t SENDING = 4;
+        const uint32_t RECEIVE_ENDED = 8; // The peer closed or the socket failed: never re-arm
+
+        const uint32_t TAG_MASK = 0xFFFFFF;
+        const uint32_t BUFFER_GROUP = 0;
+
+        uint64_t encode(Operation operation, uint32_t tag, int fd) {
+            return (static_cast<uint64_t>(operation) << 56) | (static_cast<uint64_t>(tag & TAG_MASK) << 32) |
+                   static_cast<uint32_t>(fd);
+        }
+
+        int setupRingSyscall(unsigned entries, io_uring_params* params) {
+            return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        int enterSyscall(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+            return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+        }
+
+        const __kernel_timespec ACCEPT_RETRY_DELAY = { 0, 100 * 1000 * 1000 };
+    }
+
+    UringReactor::Ring::~Ring() {
+        // Closing the ring cancels whatever is still in flight
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (sqes) {
+            ::munmap(sqes, sqeMemorySize);
+        }
+        if (memory) {
+            ::munmap(memory, memorySize);
+        }
+        if (buffers) {
+            ::munmap(buffers, static_cast<size_t>(RECEIVE_BUFFER_COUNT) * RECEIVE_BUFFER_SIZE);
+        }
+    }
+
+    ErrorCode UringReactor::Ring::setup(unsigned entries) {
+        // Completions are only ever reaped inside io_uring_enter, so the kernel need not
+        // interrupt the loop to post them
+        io_uring_params params{};
+        params.flags = IORING_SETUP_COOP_TASKRUN;
+        fd = setupRingSyscall(entries, &params);
+        if (fd < 0 && errno == EINVAL) {
+            params = io_uring_params();
+            fd = setupRingSyscall(entries, &params);
+        }
+        if (fd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP)) {
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        memorySize = sqSize > cqSize ? sqSize : cqSize;
+        void* queues = ::mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (queues == MAP_FAILED) {
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+        memory = queues;
+
+        sqeMemorySize = params.sq_entries * sizeof(io_uring_sqe);
+        void* entriesMemory = ::mmap(nullptr, sqeMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (entriesMemory == MAP_FAILED) {
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+        sqes = static_cast<io_uring_sqe*>(entriesMemory);
+
+        char* base = static_cast<char*>(memory);
+        sqHead = reinterpret_cast<uint32_t*>(base + params.sq_off.head);
+        sqTail = reinterpret_cast<uint32_t*>(base + params.sq_off.tail);
+        sqArray = reinterpret_cast<uint32_t*>(base + params.sq_off.array);
+        sqMask = *reinterpret_cast<uint32_t*>(base + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        sqLocalTail = *sqTail;
+        cqHead = reinterpret_cast<uint32_t*>(base + params.cq_off.head);
+        cqTail = reinterpret_cast<uint32_t*>(base + params.cq_off.tail);
+        cqMask = *reinterpret_cast<uint32_t*>(base + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+
+        // One set of receive buffers for the whole loop: a client only holds one between
+        // its completion and the copy into its connection
+        void* bufferMemory = ::mmap(nullptr, static_cast<size_t>(RECEIVE_BUFFER_COUNT) * RECEIVE_BUFFER_SIZE,
+                                    PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (bufferMemory == MAP_FAILED) {
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+        buffers = static_cast<char*>(bufferMemory);
+
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = RECEIVE_BUFFER_COUNT;
+        sqe->addr = reinterpret_cast<uint64_t>(buffers);
+        sqe->len = RECEIVE_BUFFER_SIZE;
+        sqe->buf_group = BUFFER_GROUP;
+
+        io_uring_cqe cqe{};
+        if (enter(1) < 0 || !nextCompletion(cqe) || cqe.res < 0) {
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    io_uring_sqe* UringReactor::Ring::nextSqe() {
+        if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+            // Full: hand what is queued to the kernel without waiting for anything
+            enter(0);
+        }
+
+        uint32_t index = sqLocalTail & sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        ++sqLocalTail;
+        ++unsubmitted;
+        ++submitted;
+        return sqe;
+    }
+
+    int UringReactor::Ring::enter(unsigned minComplete) {
+        __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+
+        ++enterCalls;
+        int result = enterSyscall(fd, unsubmitted, minComplete, minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (result < 0) {
+            return -errno;
+        }
+        unsubmitted -= (std::min)(static_cast<uint32_t>(result), unsubmitted);
+        return result;
+    }
+
+    bool UringReactor::Ring::nextCompletion(io_uring_cqe& cqe) {
+        uint32_t head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+
+        // Copied and released before it is handled, since handling may submit and enter
+        cqe = cqes[head & cqMask];
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    char* UringReactor::Ring::buffer(uint16_t id) const {
+        return buffers + static_cast<size_t>(id) * RECEIVE_BUFFER_SIZE;
+    }
+
+    void UringReactor::Ring::recycleBuffer(uint16_t id) {
+        // Goes out with the next submission; only a failure posts a completion
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        sqe->fd = 1;
+        sqe->addr = reinterpret_cast<uint64_t>(buffer(id));
+        sqe->len = RECEIVE_BUFFER_SIZE;
+        sqe->off = id;
+        sqe->buf_group = BUFFER_GROUP;
+    }
+
+    UringReactor::UringReactor(CommandProcessor& proc, WorkStealingExecutor& exec)
+        : Reactor(proc, exec), wakeValue(0), acceptServer(nullptr), acceptArmed(false), sendsInFlight(0) {
+    }
+
+    UringReactor::~UringReactor() {
+        stop();
+    }
+
+    bool UringReactor::isSupported() {
+        static const bool supported = [] {
+            Ring probe;
+            if (probe.setup(8) != ErrorCode::SUCCESS) {
+                return false;
+            }
+
+            // Kernels without multishot receives take the flags below but answer with a
+            // single-shot recv or an error, so try one for real
+            int pair[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0) {
+                return false;
+            }
+
+            io_uring_sqe* sqe = probe.nextSqe();
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = pair[0];
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = BUFFER_GROUP;
+
+            io_uring_cqe cqe{};
+            bool works = ::write(pair[1], "x", 1) == 1 && probe.enter(1) >= 0 && probe.nextCompletion(cqe) &&
+                         cqe.res == 1 && (cqe.flags & IORING_CQE_F_BUFFER) && (cqe.flags & IORING_CQE_F_MORE);
+
+            ::close(pair[0]);
+            ::close(pair[1]);
+            return works;
+        }();
+        return supported;
+    }
+
+    bool UringReactor::acceptFrom(IpcServer& server, std::function<void(std::unique_ptr<IpcConnection>)> accepted) {
+        if (server.getDescriptor() < 0) {
+            return false;
+        }
+
+        acceptServer = &server;
+        onAccepted = std::move(accepted);
+        return true;
+    }
+
+    ErrorCode UringReactor::initialize() {
+        ErrorCode result = ring.setup(QUEUE_DEPTH);
+        if (result != ErrorCode::SUCCESS) {
+            Logger::getInstance().error("Failed to set up io_uring: " + std::string(std::strerror(errno)));
+        }
+        return result;
+    }
+
+    void UringReactor::run() {
+        armWake();
+        if (acceptServer) {
+            armAccept();
+        }
+
+        while (running.load()) {
+            // Everything queued while handling the last completions is submitted by the
+            // same call that waits for the next ones
+            int result = ring.enter(1);
+            if (result < 0 && result != -EINTR && result != -EAGAIN && result != -EBUSY) {
+                Logger::getInstance().error("io_uring_enter failed: " + std::string(std::strerror(-result)));
+                break;
+            }
+            processCompletions();
+        }
+
+        // Clients may only be closed once neither a worker nor the kernel points into them
+        waitForExecutingClients();
+        for (auto& entry : clients) {
+            if (entry.second.events & SENDING) {
+                cancelAll(entry.first);
+            }
+        }
+        while (sendsInFlight > 0 && ring.enter(1) >= 0) {
+            processCompletions();
+        }
+        closeAllClients();
+
+        Logger::getInstance().info("io_uring event loop: " + std::to_string(ring.submitted) + " operations in " +
+                                   std::to_string(ring.enterCalls) + " io_uring_enter calls");
+    }
+
+    void UringReactor::processCompletions() {
+        io_uring_cqe cqe;
+        while (ring.nextCompletion(cqe)) {
+            Operation operation = static_cast<Operation>(cqe.user_data >> 56);
+            uint32_t tag = static_cast<uint32_t>(cqe.user_data >> 32) & TAG_MASK;
+            int fd = static_cast<int>(static_cast<uint32_t>(cqe.user_data));
+
+            switch (operation) {
+                case OP_WAKE:
+                    if (running.load()) {
+                        armWake();
+                        adoptIncoming();
+                        drainCompletions();
+                    }
+                    break;
+                case OP_ACCEPT:
+                    handleAccept(cqe.res, cqe.flags);
+                    break;
+                case OP_ACCEPT_RETRY:
+                    if (running.load()) {
+                        armAccept();
+                    }
+                    break;
+                case OP_RECEIVE:
+                    handleReceive(fd, tag, cqe.res, cqe.flags);
+                    break;
+                case OP_SEND:
+                    handleSend(fd, tag, cqe.res);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    void UringReactor::handleReceive(int fd, uint32_t generation, int result, uint32_t flags) {
+        auto it = clients.find(fd);
+        bool current = it != clients.end() && (it->second.generation & TAG_MASK) == generation;
+
+        if (current && !(flags & IORING_CQE_F_MORE)) {
+            it->second.events &= ~(RECEIVING | CANCELLING);
+        }
+
+        if (flags & IORING_CQE_F_BUFFER) {
+            uint16_t id = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+            if (current && result > 0 && !it->second.detached) {
+                it->second.handler->getConnection().deliverReceived(ring.buffer(id), static_cast<size_t>(result));
+            }
+            ring.recycleBuffer(id);
+        }
+
+        if (!current || it->second.detached || !running.load()) {
+            return;
+        }
+
+        Client& client = it->second;
+        if (result == -ENOBUFS || result == -ECANCELED) {
+            // Out of buffers for a moment, or stopped for backpressure: updateInterest re-arms
+            updateInterest(fd, client);
+            return;
+        }
+        if (result <= 0) {
+            // What was delivered before the end is still answered
+            client.events |= RECEIVE_ENDED;
+            client.handler->getConnection().deliverReceived(nullptr, 0);
+        }
+        serviceClient(fd, true, false, false);
+    }
+
+    void UringReactor::handleSend(int fd, uint32_t slot, int result) {
+        freeSendSlots.push_back(slot);
+        --sendsInFlight;
+
+        auto it = clients.find(fd);
+        if (it == clients.end()) {
+            return;
+        }
+
+        Client& client = it->second;
+        --client.operations;
+        client.events &= ~SENDING;
+        if (result > 0) {
+            client.handler->getConnection().consumePending(static_cast<size_t>(result));
+        }
+
+        if (client.detached) {
+            closeClient(fd);
+            return;
+        }
+        if (!running.load()) {
+            return;
+        }
+        if (result < 0 && result != -EAGAIN && result != -EINTR) {
+            Logger::getInstance().error("Failed to write response to client " + client.handler->getClientId() + ": " +
+                                        std::string(std::strerror(-result)));
+            closeClient(fd);
+            return;
+        }
+        serviceClient(fd, false, true, false);
+    }
+
+    void UringReactor::handleAccept(int result, uint32_t flags) {
+        if (!(flags & IORING_CQE_F_MORE)) {
+            acceptArmed = false;
+        }
+
+        if (result >= 0) {
+            std::unique_ptr<IpcConnection> connection = running.load() ? acceptServer->adoptConnection(result) : nullptr;
+            if (connection) {
+                onAccepted(std::move(connection));
+            } else {
+                ::close(result);
+            }
+        } else if (result != -ECANCELED) {
+            Logger::getInstance().warning("Failed to accept connection: " + std::string(std::strerror(-result)));
+        }
+
+        if (acceptArmed || !running.load()) {
+            return;
+        }
+        if (result == -EMFILE || result == -ENFILE || result == -ENOMEM || result == -ENOBUFS) {
+            // Out of descriptors: try again shortly rather than spinning on the same error
+            io_uring_sqe* sqe = ring.nextSqe();
+            sqe->opcode = IORING_OP_TIMEOUT;
+            sqe->addr = reinterpret_cast<uint64_t>(&ACCEPT_RETRY_DELAY);
+            sqe->len = 1;
+            sqe->user_data = encode(OP_ACCEPT_RETRY, 0, 0);
+            return;
+        }
+        armAccept();
+    }
+
+    void UringReactor::armWake() {
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wakeFd;
+        sqe->addr = reinterpret_cast<uint64_t>(&wakeValue);
+        sqe->len = sizeof(wakeValue);
+        sqe->user_data = encode(OP_WAKE, 0, wakeFd);
+    }
+
+    void UringReactor::armAccept() {
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = acceptServer->getDescriptor();
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+        sqe->user_data = encode(OP_ACCEPT, 0, sqe->fd);
+        acceptArmed = true;
+    }
+
+    void UringReactor::armReceive(int fd, Client& client) {
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+        sqe->user_data = encode(OP_RECEIVE, client.generation, fd);
+        client.events |= RECEIVING;
+    }
+
+    void UringReactor::cancelReceive(int fd, Client& client) {
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = encode(OP_RECEIVE, client.generation, fd);
+        sqe->user_data = encode(OP_CANCEL, 0, fd);
+        client.events |= CANCELLING;
+    }
+
+    void UringReactor::submitSend(int fd, Client& client) {
+        uint32_t slot;
+        if (!freeSendSlots.empty()) {
+            slot = freeSendSlots.back();
+            freeSendSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(sendSlots.size());
+            sendSlots.push_back(std::make_unique<SendSlot>());
+        }
+
+        // Every reply queued so far leaves in one sendmsg
+        SendSlot& send = *sendSlots[slot];
+        send.message = ::msghdr();
+        send.message.msg_iov = send.parts;
+        send.message.msg_iovlen = client.handler->getConnection().gatherPending(send.parts, sizeof(send.parts) / sizeof(send.parts[0]));
+
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&send.message);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = encode(OP_SEND, slot, fd);
+
+        client.events |= SENDING;
+        ++client.operations;
+        ++sendsInFlight;
+    }
+
+    void UringReactor::cancelAll(int fd) {
+        // Only while a send is out, which keeps the descriptor from being closed and reused
+        // before the cancel reaches the kernel
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = fd;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = encode(OP_CANCEL, 0, fd);
+    }
+
+    bool UringReactor::registerClient(int fd, Client& client) {
+        if (client.handler->getConnection().setCompletionDriven(true) != ErrorCode::SUCCESS) {
+            return false;
+        }
+
+        client.events = 0;
+        armReceive(fd, client);
+        return true;
+    }
+
+    void UringReactor::updateInterest(int fd, Client& client) {
+        if (client.detached) {
+            return;
+        }
+
+        // Receiving stops while delivered input or queued replies back up, so a client that
+        // floods requests or stops reading cannot make the daemon buffer without bound
+        IpcConnection& connection = client.handler->getConnection();
+        bool wantReceive = connection.getReceivedBytes() < Constants::REACTOR_OUTPUT_HIGH_WATER &&
+                           connection.getPendingBytes() < Constants::REACTOR_OUTPUT_HIGH_WATER;
+        if (wantReceive && !(client.events & (RECEIVING | RECEIVE_ENDED))) {
+            armReceive(fd, client);
+        } else if (!wantReceive && (client.events & RECEIVING) && !(client.events & CANCELLING)) {
+            cancelReceive(fd, client);
+        }
+
+        if (connection.getPendingBytes() > 0 && !(client.events & SENDING)) {
+            submitSend(fd, client);
+        }
+    }
+
+    void UringReactor::releaseClient(int fd, Client& client) {
+        // A receive holds the socket open until cancelled, and a send blocked on a client
+        // that stopped reading would hold the client forever; whatever it had not sent is
+        // tried once more, without waiting, when the connection closes
+        if (client.events & SENDING) {
+            cancelAll(fd);
+            client.events |= CANCELLING;
+        } else if ((client.events & RECEIVING) && !(client.events & CANCELLING)) {
+            cancelReceive(fd, client);
+        }
+    }
+}
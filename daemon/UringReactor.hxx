@@ -0,0 +1,116 @@
+#ifndef URING_REACTOR_HXX
+#define URING_REACTOR_HXX
+
+#include "Reactor.hxx"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace NumberStore {
+    // Completion-driven event loop on io_uring (Linux 6.0+, stream sockets only). Each
+    // client has one multishot recv that picks buffers the loop provided to the kernel;
+    // the bytes are copied into the connection and the buffer is handed straight back.
+    // Replies are gathered into one sendmsg per client, and every receive, send and
+    // accept queued during a pass over the completions goes to the kernel in the single
+    // io_uring_enter that also waits for the next ones. The first loop can accept with a
+    // multishot accept as well (acceptFrom()).
+    class UringReactor : public Reactor {
+    private:
+        // The mapped queues and the receive buffers provided to the kernel, driven by raw syscalls
+        struct Ring {
+            int fd = -1;
+            void* memory = nullptr;
+            size_t memorySize = 0;
+            io_uring_sqe* sqes = nullptr;
+            size_t sqeMemorySize = 0;
+            uint32_t* sqHead = nullptr;
+            uint32_t* sqTail = nullptr;
+            uint32_t* sqArray = nullptr;
+            uint32_t sqMask = 0;
+            uint32_t sqEntries = 0;
+            uint32_t sqLocalTail = 0;
+            uint32_t* cqHead = nullptr;
+            uint32_t* cqTail = nullptr;
+            uint32_t cqMask = 0;
+            io_uring_cqe* cqes = nullptr;
+            uint32_t unsubmitted = 0;
+
+            char* buffers = nullptr;
+
+            uint64_t enterCalls = 0;
+            uint64_t submitted = 0;
+
+            Ring() = default;
+            ~Ring();
+            Ring(const Ring&) = delete;
+            Ring& operator=(const Ring&) = delete;
+
+            ErrorCode setup(unsigned entries);
+            io_uring_sqe* nextSqe();
+            // Submits everything queued and, with minComplete > 0, waits for completions;
+            // returns the number submitted or -errno
+            int enter(unsigned minComplete);
+            // Copies out the next completion, if any
+            bool nextCompletion(io_uring_cqe& cqe);
+            char* buffer(uint16_t id) const;
+            void recycleBuffer(uint16_t id);
+        };
+
+        struct SendSlot {
+            ::msghdr message;
+            ::iovec parts[64];
+        };
+
+        Ring ring;
+        uint64_t wakeValue;             // Target of the read armed on the wake eventfd
+        IpcServer* acceptServer;
+        std::function<void(std::unique_ptr<IpcConnection>)> onAccepted;
+        bool acceptArmed;
+
+        std::vector<std::unique_ptr<SendSlot>> sendSlots;
+        std::vector<uint32_t> freeSendSlots;
+        size_t sendsInFlight;
+
+    public:
+        UringReactor(CommandProcessor& proc, WorkStealingExecutor& exec);
+        ~UringReactor() override;
+
+        // Whether this kernel has everything the loop relies on (a multishot recv into a
+        // provided buffer is tried for real), so the caller can fall back to epoll
+        static bool isSupported();
+
+        bool acceptFrom(IpcServer& server, std::function<void(std::unique_ptr<IpcConnection>)> onAccepted) override;
+
+        static const unsigned QUEUE_DEPTH = 1024;
+        static const unsigned RECEIVE_BUFFER_COUNT = 256;
+        static const unsigned RECEIVE_BUFFER_SIZE = 16 * 1024;
+
+    protected:
+        ErrorCode initialize() override;
+        void run() override;
+        bool registerClient(int fd, Client& client) override;
+        void updateInterest(int fd, Client& client) override;
+        void releaseClient(int fd, Client& client) override;
+
+    private:
+        void processCompletions();
+        void handleReceive(int fd, uint32_t generation, int result, uint32_t flags);
+        void handleSend(int fd, uint32_t slot, int result);
+        void handleAccept(int result, uint32_t flags);
+        void armWake();
+        void armAccept();
+        void armReceive(int fd, Client& client);
+        void cancelReceive(int fd, Client& client);
+        void submitSend(int fd, Client& client);
+        void cancelAll(int fd);
+    };
+}
+
+#endif // URING_REACTOR_HXX
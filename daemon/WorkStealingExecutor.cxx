@@ -0,0 +1,175 @@
+#include "WorkStealingExecutor.hxx"
+#include "../utils/Logger.hxx"
+#include <chrono>
+#include <exception>
+
+namespace NumberStore {
+    WorkStealingExecutor::WorkStealingExecutor(size_t workerCount)
+        : running(false), queuedTasks(0), sleepingWorkers(0) {
+        if (workerCount == 0) {
+            workerCount = std::thread::hardware_concurrency();
+        }
+        if (workerCount == 0) {
+            workerCount = 1;
+        }
+
+        for (size_t i = 0; i < workerCount; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    WorkStealingExecutor::~WorkStealingExecutor() {
+        stop();
+    }
+
+    void WorkStealingExecutor::start() {
+        if (running.exchange(true)) {
+            return;
+        }
+
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i]->thread = std::thread(&WorkStealingExecutor::run, this, i);
+        }
+    }
+
+    void WorkStealingExecutor::stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wakeup.notify_all();
+        }
+
+        for (auto& worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+
+    void WorkStealingExecutor::submit(Task task, size_t affinity) {
+        Worker& worker = *workers[affinity % workers.size()];
+        
+        // Counted before it becomes visible, so a thief never takes it below zero
+        queuedTasks.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.tasks.push_back(std::move(task));
+
+            size_t depth = worker.tasks.size();
+            if (depth > worker.maxDepth.load(std::memory_order_relaxed)) {
+                worker.maxDepth.store(depth, std::memory_order_relaxed);
+            }
+        }
+
+        // Pairs with sleep(): either a worker sees the new count before it waits, or
+        // this side sees it counted as sleeping and wakes it
+        if (sleepingWorkers.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wakeup.notify_one();
+        }
+    }
+
+    size_t WorkStealingExecutor::getWorkerCount() const {
+        return workers.size();
+    }
+
+    ExecutorStats WorkStealingExecutor::getStats() const {
+        ExecutorStats stats;
+        stats.workers = workers.size();
+        stats.queueDepth = queuedTasks.load();
+
+        for (const auto& worker : workers) {
+            stats.tasksExecuted += worker->executed.load(std::memory_order_relaxed);
+            stats.steals += worker->steals.load(std::memory_order_relaxed);
+            stats.idleMicroseconds += worker->idleMicroseconds.load(std::memory_order_relaxed);
+
+            size_t depth = worker->maxDepth.load(std::memory_order_relaxed);
+            if (depth > stats.maxQueueDepth) {
+                stats.maxQueueDepth = depth;
+            }
+        }
+        return stats;
+    }
+
+    void WorkStealingExecutor::run(size_t index) {
+        Worker& worker = *workers[index];
+        Task task;
+        size_t emptyRounds = 0;
+
+        while (true) {
+            if (popLocal(worker, task) || steal(index, task)) {
+                emptyRounds = 0;
+                queuedTasks.fetch_sub(1);
+
+                try {
+                    task();
+                }
+                catch (const std::exception& e) {
+                    Logger::getInstance().error("Exception in executor task: " + std::string(e.what()));
+                }
+                task = nullptr;
+                worker.executed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // Nothing queued anywhere: stop only once the queues are drained, so work
+            // submitted before stop() still gets its completion
+            if (!running.load() && queuedTasks.load() == 0) {
+                break;
+            }
+
+            if (++emptyRounds < STEAL_ATTEMPTS) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            emptyRounds = 0;
+            sleep(worker);
+        }
+    }
+
+    bool WorkStealingExecutor::popLocal(Worker& worker, Task& task) {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+        return true;
+    }
+
+    bool WorkStealingExecutor::steal(size_t thief, Task& task) {
+        // Start with the next worker over so thieves spread across victims
+        for (size_t offset = 1; offset < workers.size(); ++offset) {
+            Worker& victim = *workers[(thief + offset) % workers.size()];
+
+            std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || victim.tasks.empty()) {
+                continue;
+            }
+
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            workers[thief]->steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void WorkStealingExecutor::sleep(Worker& worker) {
+        auto started = std::chrono::steady_clock::now();
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepingWorkers.fetch_add(1);
+            wakeup.wait(lock, [this] { return queuedTasks.load() > 0 || !running.load(); });
+            sleepingWorkers.fetch_sub(1);
+        }
+
+        auto idle = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+        worker.idleMicroseconds.fetch_add(static_cast<uint64_t>(idle.count()), std::memory_order_relaxed);
+    }
+}
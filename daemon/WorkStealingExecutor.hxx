@@ -0,0 +1,80 @@
+#ifndef WORK_STEALING_EXECUTOR_HXX
+#define WORK_STEALING_EXECUTOR_HXX
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+namespace NumberStore {
+    // Scheduling counters for tuning the worker count; all totals since start()
+    struct ExecutorStats {
+        size_t workers = 0;
+        uint64_t tasksExecuted = 0;
+        uint64_t steals = 0;            // Tasks run by a worker other than the one they were queued on
+        size_t queueDepth = 0;          // Tasks waiting right now, across all workers
+        size_t maxQueueDepth = 0;       // Deepest any single worker queue has been
+        uint64_t idleMicroseconds = 0;  // Time workers spent asleep, summed over workers
+    };
+
+    // Fixed pool of worker threads with one deque each. Every task is submitted from
+    // outside the pool, so a worker runs its own tasks oldest first and no connection's
+    // batch waits behind newer ones; once its deque is empty it steals the oldest task
+    // from another worker before going to sleep. Callers pick the deque with an affinity
+    // hint, so related work (one connection's requests) keeps landing on the same worker.
+    class WorkStealingExecutor {
+    public:
+        using Task = std::function<void()>;
+
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+            std::thread thread;
+            std::atomic<uint64_t> executed{0};
+            std::atomic<uint64_t> steals{0};
+            std::atomic<uint64_t> idleMicroseconds{0};
+            std::atomic<size_t> maxDepth{0};
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<bool> running;
+        std::atomic<size_t> queuedTasks;
+
+        // Idle workers sleep here; submit() only takes the mutex when someone is asleep
+        std::mutex sleepMutex;
+        std::condition_variable wakeup;
+        std::atomic<size_t> sleepingWorkers;
+
+    public:
+        // A worker count of 0 uses one worker per hardware thread
+        explicit WorkStealingExecutor(size_t workerCount);
+        ~WorkStealingExecutor();
+
+        WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+        WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+        void start();
+        // Runs every task already queued, then joins the workers
+        void stop();
+
+        void submit(Task task, size_t affinity);
+        size_t getWorkerCount() const;
+        ExecutorStats getStats() const;
+
+        static const size_t STEAL_ATTEMPTS = 64;  // Empty rounds a worker spins through before sleeping
+
+    private:
+        void run(size_t index);
+        bool popLocal(Worker& worker, Task& task);
+        bool steal(size_t thief, Task& task);
+        void sleep(Worker& worker);
+    };
+}
+
+#endif // WORK_STEALING_EXECUTOR_HXX
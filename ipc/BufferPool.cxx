@@ -0,0 +1,47 @@
+#include "BufferPool.hxx"
+#include "../utils/Constants.hxx"
+
+namespace NumberStore {
+    std::unique_ptr<BufferPool> BufferPool::instance = nullptr;
+    std::mutex BufferPool::instanceMutex;
+
+    BufferPool& BufferPool::getInstance() {
+        std::lock_guard<std::mutex> lock(instanceMutex);
+        if (!instance) {
+            instance = std::unique_ptr<BufferPool>(new BufferPool());
+        }
+        return *instance;
+    }
+
+    std::vector<char> BufferPool::acquire(size_t size) {
+        std::vector<char> buffer;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (!buffers.empty()) {
+                buffer.swap(buffers.back());
+                buffers.pop_back();
+            }
+        }
+
+        buffer.resize(size);
+        return buffer;
+    }
+
+    void BufferPool::release(std::vector<char>& buffer) {
+        std::vector<char> released;
+        released.swap(buffer);
+        if (released.capacity() == 0 || released.capacity() > Constants::BUFFER_POOL_MAX_CAPACITY) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (buffers.size() < Constants::BUFFER_POOL_LIMIT) {
+            buffers.push_back(std::move(released));
+        }
+    }
+
+    size_t BufferPool::getPooledCount() const {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        return buffers.size();
+    }
+}
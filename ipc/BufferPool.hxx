@@ -0,0 +1,42 @@
+#ifndef BUFFER_POOL_HXX
+#define BUFFER_POOL_HXX
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+
+namespace NumberStore {
+    // Process-wide free list of byte buffers for connection I/O. Connections come and
+    // go (the CLI opens one per command) and queue replies by the thousand, so their
+    // receive buffers and queued messages are taken from here and handed back instead
+    // of being allocated each time. Only buffers up to BUFFER_POOL_MAX_CAPACITY are
+    // kept, and at most BUFFER_POOL_LIMIT of them.
+    class BufferPool {
+    private:
+        static std::unique_ptr<BufferPool> instance;
+        static std::mutex instanceMutex;
+
+        mutable std::mutex poolMutex;
+        std::vector<std::vector<char>> buffers;
+
+        BufferPool() = default;
+
+    public:
+        ~BufferPool() = default;
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+        BufferPool(BufferPool&&) = delete;
+        BufferPool& operator=(BufferPool&&) = delete;
+
+        static BufferPool& getInstance();
+
+        // A buffer of the given size; its contents are unspecified
+        std::vector<char> acquire(size_t size);
+        // Takes the buffer's memory and leaves it empty
+        void release(std::vector<char>& buffer);
+        size_t getPooledCount() const;
+    };
+}
+
+#endif // BUFFER_POOL_HXX
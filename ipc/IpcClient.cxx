@@ -1,20 +1,22 @@
-#include "NamedPipeClient.hxx"
+#include "IpcClient.hxx"
+#include "IpcTransport.hxx"
 #include "../utils/Logger.hxx"
+#include "../utils/Config.hxx"
 
 namespace NumberStore {
-    NamedPipeClient::NamedPipeClient() : connection(std::make_unique<NamedPipeConnection>()) {
+    IpcClient::IpcClient() {
     }
 
-    NamedPipeClient::~NamedPipeClient() {
+    IpcClient::~IpcClient() {
         disconnect();
     }
 
-    ErrorCode NamedPipeClient::connect(const std::string& pipeName) {
-        if (connection->isConnected()) {
+    ErrorCode IpcClient::connect(const std::string& address) {
+        if (isConnected()) {
             return ErrorCode::SUCCESS;
         }
 
-        ErrorCode result = connection->connect(pipeName);
+        ErrorCode result = IpcTransport::connect(Config::getInstance().getTransportType(), address, connection);
         if (result == ErrorCode::SUCCESS) {
             Logger::getInstance().info("Client connected to daemon");
         } else {
@@ -24,8 +26,8 @@ namespace NumberStore {
         return result;
     }
 
-    ErrorCode NamedPipeClient::disconnect() {
-        if (!connection->isConnected()) {
+    ErrorCode IpcClient::disconnect() {
+        if (!isConnected()) {
             return ErrorCode::SUCCESS;
         }
 
@@ -37,23 +39,31 @@ namespace NumberStore {
         return result;
     }
 
-    ErrorCode NamedPipeClient::sendMessage(const std::string& message) {
-        if (!connection->isConnected()) {
+    ErrorCode IpcClient::sendMessage(const std::string& message) {
+        if (!isConnected()) {
             return ErrorCode::CONNECTION_FAILED;
         }
 
         return connection->write(message);
     }
 
-    ErrorCode NamedPipeClient::receiveMessage(std::string& message) {
-        if (!connection->isConnected()) {
+    ErrorCode IpcClient::receiveMessage(std::string& message) {
+        if (!isConnected()) {
             return ErrorCode::CONNECTION_FAILED;
         }
 
         return connection->read(message);
     }
 
-    bool NamedPipeClient::isConnected() const {
+    ErrorCode IpcClient::receiveFrame(std::string& frame) {
+        if (!isConnected()) {
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        return connection->readFrame(frame);
+    }
+
+    bool IpcClient::isConnected() const {
         return connection && connection->isConnected();
     }
 }
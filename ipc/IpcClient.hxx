@@ -0,0 +1,33 @@
+#ifndef IPC_CLIENT_HXX
+#define IPC_CLIENT_HXX
+
+#include "IpcConnection.hxx"
+#include "../utils/ErrorCodes.hxx"
+#include <memory>
+#include <string>
+
+namespace NumberStore {
+    // Client side of the configured transport (see IpcTransport)
+    class IpcClient {
+    private:
+        std::unique_ptr<IpcConnection> connection;
+
+    public:
+        IpcClient();
+        ~IpcClient();
+
+        IpcClient(const IpcClient&) = delete;
+        IpcClient& operator=(const IpcClient&) = delete;
+
+        ErrorCode connect(const std::string& address);
+        ErrorCode disconnect();
+        
+        ErrorCode sendMessage(const std::string& message);
+        ErrorCode receiveMessage(std::string& message);
+        ErrorCode receiveFrame(std::string& frame);
+        
+        bool isConnected() const;
+    };
+}
+
+#endif // IPC_CLIENT_HXX
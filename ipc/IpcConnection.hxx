@@ -0,0 +1,51 @@
+#ifndef IPC_CONNECTION_HXX
+#define IPC_CONNECTION_HXX
+
+#include <string>
+#include <cstddef>
+#include "../utils/ErrorCodes.hxx"
+
+struct iovec;
+
+namespace NumberStore {
+    // One end of a daemon <-> client channel. Every transport delivers whole
+    // messages: a write() on one side is returned by exactly one read() or
+    // readFrame() on the other, whatever the underlying byte stream does.
+    class IpcConnection {
+    public:
+        virtual ~IpcConnection() = default;
+
+        virtual ErrorCode disconnect() = 0;
+        
+        virtual ErrorCode write(const std::string& data) = 0;
+        // Reads one text message (terminated by '\n')
+        virtual ErrorCode read(std::string& data) = 0;
+        // Reads one frame that starts with a 4-byte little-endian length of the rest of the frame
+        virtual ErrorCode readFrame(std::string& frame) = 0;
+        
+        virtual bool isConnected() const = 0;
+        
+        // Readiness-driven use by the daemon's event loop. In non-blocking mode read() and
+        // readFrame() return WOULD_BLOCK until a whole message has arrived, and write()
+        // queues what the transport cannot take yet; flushPending() sends the queue and
+        // returns WOULD_BLOCK while bytes remain. Backends without a pollable descriptor
+        // return -1 and are only used through the blocking calls.
+        virtual int getDescriptor() const { return -1; }
+        virtual ErrorCode setNonBlocking(bool enabled) { return enabled ? ErrorCode::INVALID_COMMAND : ErrorCode::SUCCESS; }
+        virtual ErrorCode flushPending() { return ErrorCode::SUCCESS; }
+        virtual size_t getPendingBytes() const { return 0; }
+        
+        // Completion-driven use (daemon/UringReactor): the event loop does the socket I/O
+        // itself. Bytes it received are handed over with deliverReceived(), a size of 0
+        // meaning the peer closed, and read() parses only what was delivered; write()
+        // just queues, and the loop sends the queue as gathered by gatherPending(),
+        // retiring whatever the kernel took with consumePending().
+        virtual ErrorCode setCompletionDriven(bool enabled) { return enabled ? ErrorCode::INVALID_COMMAND : ErrorCode::SUCCESS; }
+        virtual void deliverReceived(const char*, size_t) {}
+        virtual size_t getReceivedBytes() const { return 0; }
+        virtual size_t gatherPending(::iovec*, size_t) const { return 0; }
+        virtual void consumePending(size_t) {}
+    };
+}
+
+#endif // IPC_CONNECTION_HXX
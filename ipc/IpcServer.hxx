@@ -0,0 +1,32 @@
+#ifndef IPC_SERVER_HXX
+#define IPC_SERVER_HXX
+
+#include <string>
+#include <memory>
+#include "IpcConnection.hxx"
+#include "../utils/ErrorCodes.hxx"
+
+namespace NumberStore {
+    // Listening side of a transport, owned by the daemon's ConnectionManager
+    class IpcServer {
+    public:
+        virtual ~IpcServer() = default;
+
+        virtual ErrorCode start(const std::string& address) = 0;
+        virtual ErrorCode stop() = 0;
+        
+        // Returns the next client, or nullptr if none arrived (backends may wait a
+        // bounded time so the caller can keep polling for shutdown)
+        virtual std::unique_ptr<IpcConnection> acceptConnection() = 0;
+        
+        virtual bool isListening() const = 0;
+        
+        // For event loops that accept on their own (daemon/UringReactor): the listening
+        // descriptor, or -1 if the backend has none, and a connection for a descriptor
+        // they accepted from it
+        virtual int getDescriptor() const { return -1; }
+        virtual std::unique_ptr<IpcConnection> adoptConnection(int) { return nullptr; }
+    };
+}
+
+#endif // IPC_SERVER_HXX
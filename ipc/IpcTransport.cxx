@@ -0,0 +1,86 @@
+#include "IpcTransport.hxx"
+#include "../utils/Logger.hxx"
+
+#ifdef _WIN32
+#include "NamedPipeServer.hxx"
+#include "NamedPipeConnection.hxx"
+#else
+#include "UnixSocketServer.hxx"
+#include "UnixSocketConnection.hxx"
+#endif
+#ifdef __linux__
+#include "SharedMemoryServer.hxx"
+#include "SharedMemoryConnection.hxx"
+#endif
+
+namespace NumberStore {
+    std::unique_ptr<IpcServer> IpcTransport::createServer(TransportType type) {
+#ifdef _WIN32
+        if (type == TransportType::NAMED_PIPE) {
+            return std::make_unique<NamedPipeServer>();
+        }
+#else
+        if (type == TransportType::UNIX_STREAM || type == TransportType::UNIX_SEQPACKET) {
+            return std::make_unique<UnixSocketServer>(type == TransportType::UNIX_SEQPACKET);
+        }
+#endif
+#ifdef __linux__
+        if (type == TransportType::SHARED_MEMORY) {
+            return std::make_unique<SharedMemoryServer>();
+        }
+#endif
+
+        Logger::getInstance().error("Transport not available on this platform: " + getTransportName(type));
+        return nullptr;
+    }
+
+    ErrorCode IpcTransport::connect(TransportType type, const std::string& address, std::unique_ptr<IpcConnection>& outConnection) {
+#ifdef _WIN32
+        if (type == TransportType::NAMED_PIPE) {
+            auto connection = std::make_unique<NamedPipeConnection>();
+            ErrorCode result = connection->connect(address);
+            if (result == ErrorCode::SUCCESS) {
+                outConnection = std::move(connection);
+            }
+            return result;
+        }
+#else
+        if (type == TransportType::UNIX_STREAM || type == TransportType::UNIX_SEQPACKET) {
+            auto connection = std::make_unique<UnixSocketConnection>(type == TransportType::UNIX_SEQPACKET);
+            ErrorCode result = connection->connect(address);
+            if (result == ErrorCode::SUCCESS) {
+                outConnection = std::move(connection);
+            }
+            return result;
+        }
+#endif
+#ifdef __linux__
+        if (type == TransportType::SHARED_MEMORY) {
+            auto connection = std::make_unique<SharedMemoryConnection>();
+            ErrorCode result = connection->connect(address);
+            if (result == ErrorCode::SUCCESS) {
+                outConnection = std::move(connection);
+            }
+            return result;
+        }
+#endif
+
+        Logger::getInstance().error("Transport not available on this platform: " + getTransportName(type));
+        return ErrorCode::PIPE_CONNECT_FAILED;
+    }
+
+    const std::string& IpcTransport::getAddress() {
+        Config& config = Config::getInstance();
+        return config.getTransportType() == TransportType::NAMED_PIPE ? config.getPipeName() : config.getSocketPath();
+    }
+
+    std::string IpcTransport::getTransportName(TransportType type) {
+        switch (type) {
+            case TransportType::NAMED_PIPE: return "named pipe";
+            case TransportType::UNIX_STREAM: return "unix stream socket";
+            case TransportType::UNIX_SEQPACKET: return "unix seqpacket socket";
+            case TransportType::SHARED_MEMORY: return "shared memory";
+            default: return "unknown";
+        }
+    }
+}
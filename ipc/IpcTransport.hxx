@@ -0,0 +1,25 @@
+#ifndef IPC_TRANSPORT_HXX
+#define IPC_TRANSPORT_HXX
+
+#include <string>
+#include <memory>
+#include "IpcConnection.hxx"
+#include "IpcServer.hxx"
+#include "../utils/Config.hxx"
+#include "../utils/ErrorCodes.hxx"
+
+namespace NumberStore {
+    // Creates the backend selected by Config::getTransportType()
+    class IpcTransport {
+    public:
+        // Returns nullptr if the transport is not available on this platform
+        static std::unique_ptr<IpcServer> createServer(TransportType type);
+        static ErrorCode connect(TransportType type, const std::string& address, std::unique_ptr<IpcConnection>& outConnection);
+        
+        // Pipe name or socket path for the configured transport
+        static const std::string& getAddress();
+        static std::string getTransportName(TransportType type);
+    };
+}
+
+#endif // IPC_TRANSPORT_HXX
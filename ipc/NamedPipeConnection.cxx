@@ -1,15 +1,19 @@
 #include "NamedPipeConnection.hxx"
+#include "BufferPool.hxx"
 #include "../utils/Logger.hxx"
 #include "../utils/Config.hxx"
+#include "../utils/Constants.hxx"
+#include "../utils/ByteOrder.hxx"
+#include <cstring>
 #include <iostream>
 
 namespace NumberStore {
     NamedPipeConnection::NamedPipeConnection() 
-        : pipeHandle(INVALID_HANDLE_VALUE), connected(false) {
+        : pipeHandle(INVALID_HANDLE_VALUE), connected(false), receiveStart(0), receiveEnd(0) {
     }
 
     NamedPipeConnection::NamedPipeConnection(HANDLE handle) 
-        : pipeHandle(handle), connected(handle != INVALID_HANDLE_VALUE) {
+        : pipeHandle(handle), connected(handle != INVALID_HANDLE_VALUE), receiveStart(0), receiveEnd(0) {
     }
 
     NamedPipeConnection::~NamedPipeConnection() {
@@ -17,9 +21,12 @@ namespace NumberStore {
     }
 
     NamedPipeConnection::NamedPipeConnection(NamedPipeConnection&& other) noexcept
-        : pipeHandle(other.pipeHandle), connected(other.connected), pipeName(std::move(other.pipeName)) {
+        : pipeHandle(other.pipeHandle), connected(other.connected), pipeName(std::move(other.pipeName)),
+          receiveBuffer(std::move(other.receiveBuffer)), receiveStart(other.receiveStart), receiveEnd(other.receiveEnd) {
         other.pipeHandle = INVALID_HANDLE_VALUE;
         other.connected = false;
+        other.receiveBuffer.clear();
+        other.receiveStart = other.receiveEnd = 0;
     }
 
     NamedPipeConnection& NamedPipeConnection::operator=(NamedPipeConnection&& other) noexcept {
@@ -28,9 +35,14 @@ namespace NumberStore {
             pipeHandle = other.pipeHandle;
             connected = other.connected;
             pipeName = std::move(other.pipeName);
+            receiveBuffer = std::move(other.receiveBuffer);
+            receiveStart = other.receiveStart;
+            receiveEnd = other.receiveEnd;
             
             other.pipeHandle = INVALID_HANDLE_VALUE;
             other.connected = false;
+            other.receiveBuffer.clear();
+            other.receiveStart = other.receiveEnd = 0;
         }
         return *this;
     }
@@ -95,14 +107,9 @@ namespace NumberStore {
             return ErrorCode::CONNECTION_FAILED;
         }
 
+        // Message mode keeps boundaries, so there is no header to gather with the payload
         DWORD bytesWritten;
-        ErrorCode result = writeExact(data.c_str(), static_cast<DWORD>(data.length()), bytesWritten);
-        
-        if (result == ErrorCode::SUCCESS) {
-            Logger::getInstance().debug("Sent: " + data.substr(0, data.length() - 1)); // Remove newline for logging
-        }
-        
-        return result;
+        return writeExact(data.c_str(), static_cast<DWORD>(data.length()), bytesWritten);
     }
 
     ErrorCode NamedPipeConnection::read(std::string& data) {
@@ -110,39 +117,52 @@ namespace NumberStore {
             return ErrorCode::CONNECTION_FAILED;
         }
 
-        data.clear();
-        char buffer[4096];
-        
-        // Read until we find the message terminator (\n)
+        // Read until a message ends with the terminator (\n). Messages arrive whole, so a
+        // newline inside a DATA frame cannot end the command early.
+        do {
+            ErrorCode result = receiveMessage();
+            if (result != ErrorCode::SUCCESS) {
+                return result;
+            }
+        } while (receiveBuffer[receiveEnd - 1] != '\n');
+
+        data.assign(receiveBuffer.data() + receiveStart, receiveEnd - receiveStart);
+        receiveStart = receiveEnd = 0;
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode NamedPipeConnection::readFrame(std::string& frame) {
+        if (!connected || pipeHandle == INVALID_HANDLE_VALUE) {
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        // A pipe message may carry several frames; whatever follows this one stays buffered
         while (true) {
-            DWORD bytesRead;
-            
-            if (!ReadFile(pipeHandle, buffer, sizeof(buffer) - 1, &bytesRead, nullptr)) {
-                DWORD error = GetLastError();
-                if (error == ERROR_BROKEN_PIPE || error == ERROR_PIPE_NOT_CONNECTED) {
-                    connected = false;
-                    return ErrorCode::CONNECTION_FAILED;
+            size_t available = receiveEnd - receiveStart;
+            if (available >= 4) {
+                uint32_t length = ByteOrder::getUint32(receiveBuffer.data() + receiveStart);
+                if (length > Constants::MAX_FRAME_SIZE) {
+                    Logger::getInstance().error("Frame too large: " + std::to_string(length) + " bytes");
+                    return ErrorCode::READ_FAILED;
                 }
-                Logger::getInstance().error("ReadFile failed: " + std::to_string(error));
-                return ErrorCode::READ_FAILED;
-            }
 
-            if (bytesRead == 0) {
-                connected = false;
-                return ErrorCode::CONNECTION_FAILED;
+                // Keep the prefix so decoders see the frame exactly as it was sent
+                size_t needed = 4 + static_cast<size_t>(length);
+                if (available >= needed) {
+                    frame.assign(receiveBuffer.data() + receiveStart, needed);
+                    receiveStart += needed;
+                    if (receiveStart == receiveEnd) {
+                        receiveStart = receiveEnd = 0;
+                    }
+                    return ErrorCode::SUCCESS;
+                }
             }
 
-            buffer[bytesRead] = '\0';
-            data += std::string(buffer, bytesRead);
-            
-            // Check if we have received the complete message (ends with \n)
-            if (!data.empty() && data.back() == '\n') {
-                break;
+            ErrorCode result = receiveMessage();
+            if (result != ErrorCode::SUCCESS) {
+                return result;
             }
         }
-        
-        Logger::getInstance().debug("Received: " + data.substr(0, data.length() - 1)); // Remove newline for logging
-        return ErrorCode::SUCCESS;
     }
 
     bool NamedPipeConnection::isConnected() const {
@@ -159,28 +179,54 @@ namespace NumberStore {
             pipeHandle = INVALID_HANDLE_VALUE;
         }
         connected = false;
+        receiveStart = receiveEnd = 0;
+        BufferPool::getInstance().release(receiveBuffer);
     }
 
-    ErrorCode NamedPipeConnection::readExact(char* buffer, DWORD bytesToRead, DWORD& bytesRead) {
-        bytesRead = 0;
-        
-        while (bytesRead < bytesToRead) {
-            DWORD currentBytesRead;
-            if (!ReadFile(pipeHandle, buffer + bytesRead, bytesToRead - bytesRead, &currentBytesRead, nullptr)) {
-                DWORD error = GetLastError();
-                Logger::getInstance().error("ReadFile failed: " + std::to_string(error));
-                return ErrorCode::READ_FAILED;
+    ErrorCode NamedPipeConnection::receiveMessage() {
+        if (receiveBuffer.empty()) {
+            receiveBuffer = BufferPool::getInstance().acquire(Constants::BUFFER_SIZE);
+        }
+        if (receiveStart > 0) {
+            std::memmove(receiveBuffer.data(), receiveBuffer.data() + receiveStart, receiveEnd - receiveStart);
+            receiveEnd -= receiveStart;
+            receiveStart = 0;
+        }
+
+        while (true) {
+            if (receiveEnd == receiveBuffer.size()) {
+                receiveBuffer.resize(receiveBuffer.size() * 2);
             }
-            
-            if (currentBytesRead == 0) {
-                // Connection closed
+
+            DWORD bytesRead = 0;
+            DWORD room = static_cast<DWORD>(receiveBuffer.size() - receiveEnd);
+            if (ReadFile(pipeHandle, receiveBuffer.data() + receiveEnd, room, &bytesRead, nullptr)) {
+                if (bytesRead == 0) {
+                    connected = false;
+                    return ErrorCode::CONNECTION_FAILED;
+                }
+                receiveEnd += bytesRead;
+                return ErrorCode::SUCCESS;
+            }
+
+            DWORD error = GetLastError();
+            if (error == ERROR_MORE_DATA) {
+                // Grow once to what is left of the message rather than reading it in pieces
+                receiveEnd += bytesRead;
+                DWORD remaining = 0;
+                if (PeekNamedPipe(pipeHandle, nullptr, 0, nullptr, nullptr, &remaining) && remaining > 0) {
+                    receiveBuffer.resize(receiveEnd + remaining);
+                }
+                continue;
+            }
+
+            if (error == ERROR_BROKEN_PIPE || error == ERROR_PIPE_NOT_CONNECTED) {
+                connected = false;
                 return ErrorCode::CONNECTION_FAILED;
             }
-            
-            bytesRead += currentBytesRead;
+            Logger::getInstance().error("ReadFile failed: " + std::to_string(error));
+            return ErrorCode::READ_FAILED;
         }
-        
-        return ErrorCode::SUCCESS;
     }
 
     ErrorCode NamedPipeConnection::writeExact(const char* buffer, DWORD bytesToWrite, DWORD& bytesWritten) {
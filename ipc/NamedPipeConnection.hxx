@@ -3,19 +3,24 @@
 
 #include <windows.h>
 #include <string>
+#include <vector>
+#include "IpcConnection.hxx"
 #include "../utils/ErrorCodes.hxx"
 
 namespace NumberStore {
-    class NamedPipeConnection {
+    class NamedPipeConnection : public IpcConnection {
     private:
         HANDLE pipeHandle;
         bool connected;
         std::string pipeName;
+        std::vector<char> receiveBuffer; // Whole pipe messages not yet returned (from BufferPool)
+        size_t receiveStart;
+        size_t receiveEnd;
 
     public:
         NamedPipeConnection();
         explicit NamedPipeConnection(HANDLE handle);
-        ~NamedPipeConnection();
+        ~NamedPipeConnection() override;
 
         NamedPipeConnection(const NamedPipeConnection&) = delete;
         NamedPipeConnection& operator=(const NamedPipeConnection&) = delete;
@@ -24,17 +29,19 @@ namespace NumberStore {
         NamedPipeConnection& operator=(NamedPipeConnection&& other) noexcept;
 
         ErrorCode connect(const std::string& name);
-        ErrorCode disconnect();
+        ErrorCode disconnect() override;
         
-        ErrorCode write(const std::string& data);
-        ErrorCode read(std::string& data);
+        ErrorCode write(const std::string& data) override;
+        ErrorCode read(std::string& data) override;
+        ErrorCode readFrame(std::string& frame) override;
         
-        bool isConnected() const;
+        bool isConnected() const override;
         HANDLE getHandle() const;
         
     private:
         void cleanup();
-        ErrorCode readExact(char* buffer, DWORD bytesToRead, DWORD& bytesRead);
+        // Appends the next whole pipe message to receiveBuffer, growing it to the message's size
+        ErrorCode receiveMessage();
         ErrorCode writeExact(const char* buffer, DWORD bytesToWrite, DWORD& bytesWritten);
     };
 }
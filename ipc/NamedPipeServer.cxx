@@ -32,7 +32,7 @@ namespace NumberStore {
         return ErrorCode::SUCCESS;
     }
 
-    std::unique_ptr<NamedPipeConnection> NamedPipeServer::acceptConnection() {
+    std::unique_ptr<IpcConnection> NamedPipeServer::acceptConnection() {
         if (!listening) {
             return nullptr;
         }
@@ -4,28 +4,30 @@
 #include <windows.h>
 #include <string>
 #include <memory>
+#include "IpcServer.hxx"
 #include "NamedPipeConnection.hxx"
 #include "../utils/ErrorCodes.hxx"
 
 namespace NumberStore {
-    class NamedPipeServer {
+    class NamedPipeServer : public IpcServer {
     private:
         std::string pipeName;
         bool listening;
 
     public:
         NamedPipeServer();
-        ~NamedPipeServer();
+        ~NamedPipeServer() override;
 
         NamedPipeServer(const NamedPipeServer&) = delete;
         NamedPipeServer& operator=(const NamedPipeServer&) = delete;
 
-        ErrorCode start(const std::string& name);
-        ErrorCode stop();
+        ErrorCode start(const std::string& name) override;
+        ErrorCode stop() override;
         
-        std::unique_ptr<NamedPipeConnection> acceptConnection();
+        // Blocks until a client connects to a fresh pipe instance
+        std::unique_ptr<IpcConnection> acceptConnection() override;
         
-        bool isListening() const;
+        bool isListening() const override;
         const std::string& getPipeName() const;
         
     private:
@@ -0,0 +1,454 @@
+#include "SharedMemoryConnection.hxx"
+#include "../utils/Logger.hxx"
+#include "../utils/Constants.hxx"
+#include "../utils/ByteOrder.hxx"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <new>
+#include <thread>
+
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace NumberStore {
+    // Positions count every byte ever written or read, so a ring is empty when they are
+    // equal and full when they are a ring apart; each lives on its own cache line so
+    // the two sides do not invalidate each other's writes
+    struct SharedRing {
+        alignas(64) std::atomic<uint64_t> head;         // Written by the producer
+        alignas(64) std::atomic<uint64_t> tail;         // Written by the consumer
+        alignas(64) std::atomic<uint32_t> dataSignal;   // Futex words, bumped only when someone sleeps
+        std::atomic<uint32_t> dataWaiters;
+        std::atomic<uint32_t> spaceSignal;
+        std::atomic<uint32_t> spaceWaiters;
+    };
+
+    // Start of the memfd; the request ring's bytes follow it, then the response ring's
+    struct SharedRegion {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t ringBytes;
+        std::atomic<uint32_t> closed;   // Set by whichever side disconnects first
+        SharedRing requests;            // Client to daemon
+        SharedRing responses;           // Daemon to client
+    };
+
+    namespace {
+        const uint32_t REGION_MAGIC = 0x4E534D52; // "NSMR"
+        const uint32_t REGION_VERSION = 1;
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                      "ring positions must be lock-free to be shared between processes");
+
+        size_t regionHeaderSize() {
+            return (sizeof(SharedRegion) + 63) & ~static_cast<size_t>(63);
+        }
+
+        void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
+        }
+
+        // Shared (not process-private) futexes: the word lives in another process's mapping too
+        void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int milliseconds) {
+            timespec timeout{};
+            timeout.tv_sec = milliseconds / 1000;
+            timeout.tv_nsec = static_cast<long>(milliseconds % 1000) * 1000000L;
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+        }
+
+        void futexWake(std::atomic<uint32_t>& word) {
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+        }
+
+        void signal(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiters) {
+            // Pairs with waitUntil(): a sleeper has announced itself before its last look
+            // at the ring, so either it saw our update or we see it here
+            if (waiters.load() > 0) {
+                word.fetch_add(1);
+                futexWake(word);
+            }
+        }
+    }
+
+    SharedMemoryConnection::SharedMemoryConnection()
+        : region(nullptr), regionSize(0), ringBytes(0), connected(false),
+          spinCeiling(std::thread::hardware_concurrency() > 1 ? MAX_SPIN : 0) {
+        spinLimit = spinCeiling / 4;
+    }
+
+    SharedMemoryConnection::~SharedMemoryConnection() {
+        cleanup();
+    }
+
+    ErrorCode SharedMemoryConnection::connect(const std::string& path) {
+        if (connected) {
+            return ErrorCode::SUCCESS;
+        }
+
+        auto socket = std::make_unique<UnixSocketConnection>(false);
+        ErrorCode result = socket->connect(path);
+        if (result != ErrorCode::SUCCESS) {
+            return result;
+        }
+
+        // The daemon speaks first: one byte of payload carrying the region's descriptor
+        char payload = 0;
+        iovec part{&payload, sizeof(payload)};
+        alignas(cmsghdr) char controlBuffer[CMSG_SPACE(sizeof(int))];
+        msghdr message{};
+        message.msg_iov = &part;
+        message.msg_iovlen = 1;
+        message.msg_control = controlBuffer;
+        message.msg_controllen = sizeof(controlBuffer);
+
+        ssize_t received;
+        do {
+            received = ::recvmsg(socket->getDescriptor(), &message, MSG_CMSG_CLOEXEC);
+        } while (received < 0 && errno == EINTR);
+
+        cmsghdr* header = received > 0 ? CMSG_FIRSTHDR(&message) : nullptr;
+        if (!header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            Logger::getInstance().error("Daemon did not offer a shared-memory region");
+            return ErrorCode::PIPE_CONNECT_FAILED;
+        }
+
+        int memoryFd = -1;
+        std::memcpy(&memoryFd, CMSG_DATA(header), sizeof(memoryFd));
+        result = mapRegion(memoryFd, false);
+        ::close(memoryFd);
+        if (result != ErrorCode::SUCCESS) {
+            return result;
+        }
+
+        control = std::move(socket);
+        outbound.ring = &region->requests;
+        outbound.data = reinterpret_cast<char*>(region) + regionHeaderSize();
+        inbound.ring = &region->responses;
+        inbound.data = outbound.data + ringBytes;
+        connected = true;
+
+        Logger::getInstance().info("Connected to shared memory through: " + path);
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode SharedMemoryConnection::accept(std::unique_ptr<UnixSocketConnection> socket) {
+        int memoryFd = static_cast<int>(::syscall(SYS_memfd_create, "numberstore-ring", MFD_CLOEXEC));
+        if (memoryFd < 0) {
+            Logger::getInstance().error("memfd_create failed: " + std::string(std::strerror(errno)));
+            return ErrorCode::PIPE_CREATE_FAILED;
+        }
+
+        ErrorCode result = mapRegion(memoryFd, true);
+        if (result == ErrorCode::SUCCESS) {
+            char payload = 0;
+            iovec part{&payload, sizeof(payload)};
+            alignas(cmsghdr) char controlBuffer[CMSG_SPACE(sizeof(int))] = {};
+            msghdr message{};
+            message.msg_iov = &part;
+            message.msg_iovlen = 1;
+            message.msg_control = controlBuffer;
+            message.msg_controllen = sizeof(controlBuffer);
+
+            cmsghdr* header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(header), &memoryFd, sizeof(memoryFd));
+
+            if (::sendmsg(socket->getDescriptor(), &message, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(payload))) {
+                Logger::getInstance().error("Failed to pass shared-memory region: " + std::string(std::strerror(errno)));
+                result = ErrorCode::PIPE_CREATE_FAILED;
+            }
+        }
+        ::close(memoryFd);
+
+        if (result != ErrorCode::SUCCESS) {
+            cleanup();
+            return result;
+        }
+
+        control = std::move(socket);
+        inbound.ring = &region->requests;
+        inbound.data = reinterpret_cast<char*>(region) + regionHeaderSize();
+        outbound.ring = &region->responses;
+        outbound.data = inbound.data + ringBytes;
+        connected = true;
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode SharedMemoryConnection::disconnect() {
+        if (!connected) {
+            return ErrorCode::SUCCESS;
+        }
+
+        cleanup();
+        Logger::getInstance().info("Disconnected from shared memory");
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode SharedMemoryConnection::write(const std::string& data) {
+        if (!connected) {
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        char header[4];
+        ByteOrder::putUint32(header, static_cast<uint32_t>(data.size()));
+
+        ErrorCode result = produce(header, sizeof(header));
+        if (result == ErrorCode::SUCCESS) {
+            result = produce(data.data(), data.size());
+        }
+        if (result != ErrorCode::SUCCESS) {
+            return result;
+        }
+
+        publishProduced();
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode SharedMemoryConnection::read(std::string& data) {
+        return readMessage(data);
+    }
+
+    ErrorCode SharedMemoryConnection::readFrame(std::string& frame) {
+        // Binary frames are ordinary messages here; their own length prefix travels inside
+        ErrorCode result = readMessage(frame);
+        if (result == ErrorCode::SUCCESS && (frame.size() < 4 || ByteOrder::getUint32(frame.data()) != frame.size() - 4)) {
+            Logger::getInstance().error("Received frame does not match its length prefix");
+            return ErrorCode::READ_FAILED;
+        }
+        return result;
+    }
+
+    bool SharedMemoryConnection::isConnected() const {
+        return connected;
+    }
+
+    void SharedMemoryConnection::cleanup() {
+        if (region) {
+            // Wake a peer sleeping on either ring so it sees the close straight away
+            region->closed.store(1);
+            for (SharedRing* ring : {&region->requests, &region->responses}) {
+                ring->dataSignal.fetch_add(1);
+                ring->spaceSignal.fetch_add(1);
+                futexWake(ring->dataSignal);
+                futexWake(ring->spaceSignal);
+            }
+
+            ::munmap(region, regionSize);
+            region = nullptr;
+        }
+
+        if (control) {
+            control->disconnect();
+            control.reset();
+        }
+
+        inbound = RingCursor();
+        outbound = RingCursor();
+        connected = false;
+    }
+
+    ErrorCode SharedMemoryConnection::mapRegion(int memoryFd, bool create) {
+        uint64_t bytes = Constants::SHARED_MEMORY_RING_SIZE;
+        if (!create) {
+            // The daemon picked the ring size; read it from the header before mapping the rest
+            void* header = ::mmap(nullptr, regionHeaderSize(), PROT_READ, MAP_SHARED, memoryFd, 0);
+            if (header == MAP_FAILED) {
+                Logger::getInstance().error("mmap failed: " + std::string(std::strerror(errno)));
+                return ErrorCode::PIPE_CONNECT_FAILED;
+            }
+            const SharedRegion* offered = static_cast<const SharedRegion*>(header);
+            bool valid = offered->magic == REGION_MAGIC && offered->version == REGION_VERSION;
+            bytes = offered->ringBytes;
+            ::munmap(header, regionHeaderSize());
+
+            if (!valid || bytes == 0 || (bytes & (bytes - 1)) != 0) {
+                Logger::getInstance().error("Shared-memory region has an unknown layout");
+                return ErrorCode::PIPE_CONNECT_FAILED;
+            }
+        }
+
+        size_t size = regionHeaderSize() + 2 * static_cast<size_t>(bytes);
+        if (create && ::ftruncate(memoryFd, static_cast<off_t>(size)) != 0) {
+            Logger::getInstance().error("ftruncate failed: " + std::string(std::strerror(errno)));
+            return ErrorCode::PIPE_CREATE_FAILED;
+        }
+
+        void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+        if (mapping == MAP_FAILED) {
+            Logger::getInstance().error("mmap failed: " + std::string(std::strerror(errno)));
+            return create ? ErrorCode::PIPE_CREATE_FAILED : ErrorCode::PIPE_CONNECT_FAILED;
+        }
+
+        region = create ? new (mapping) SharedRegion() : static_cast<SharedRegion*>(mapping);
+        regionSize = size;
+        ringBytes = bytes;
+        if (create) {
+            region->magic = REGION_MAGIC;
+            region->version = REGION_VERSION;
+            region->ringBytes = bytes;
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode SharedMemoryConnection::readMessage(std::string& message) {
+        if (!connected) {
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        char header[4];
+        ErrorCode result = consume(header, sizeof(header));
+        if (result != ErrorCode::SUCCESS) {
+            return result;
+        }
+
+        uint32_t size = ByteOrder::getUint32(header);
+        if (size > Constants::MAX_FRAME_SIZE) {
+            Logger::getInstance().error("Shared-memory message of " + std::to_string(size) + " bytes is too large");
+            return ErrorCode::READ_FAILED;
+        }
+
+        message.resize(size);
+        result = size > 0 ? consume(&message[0], size) : ErrorCode::SUCCESS;
+        if (result != ErrorCode::SUCCESS) {
+            return result;
+        }
+
+        publishConsumed();
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode SharedMemoryConnection::produce(const char* data, size_t size) {
+        while (size > 0) {
+            uint64_t space = ringBytes - (outbound.position - outbound.peerPosition);
+            if (space == 0) {
+                // Let the reader have what is there before waiting for it to make room
+                publishProduced();
+                ErrorCode result = waitForSpace();
+                if (result != ErrorCode::SUCCESS) {
+                    return result;
+                }
+                continue;
+            }
+
+            size_t offset = static_cast<size_t>(outbound.position & (ringBytes - 1));
+            size_t count = static_cast<size_t>((std::min<uint64_t>)({size, space, ringBytes - offset}));
+            std::memcpy(outbound.data + offset, data, count);
+            outbound.position += count;
+            data += count;
+            size -= count;
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode SharedMemoryConnection::consume(char* data, size_t size) {
+        while (size > 0) {
+            uint64_t available = inbound.peerPosition - inbound.position;
+            if (available == 0) {
+                // Hand back the room already read before waiting, or a writer larger than
+                // the ring would wait on us forever
+                publishConsumed();
+                ErrorCode result = waitForData();
+                if (result != ErrorCode::SUCCESS) {
+                    return result;
+                }
+                continue;
+            }
+
+            size_t offset = static_cast<size_t>(inbound.position & (ringBytes - 1));
+            size_t count = static_cast<size_t>((std::min<uint64_t>)({size, available, ringBytes - offset}));
+            std::memcpy(data, inbound.data + offset, count);
+            inbound.position += count;
+            data += count;
+            size -= count;
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    void SharedMemoryConnection::publishProduced() {
+        outbound.ring->head.store(outbound.position);
+        signal(outbound.ring->dataSignal, outbound.ring->dataWaiters);
+    }
+
+    void SharedMemoryConnection::publishConsumed() {
+        if (inbound.ring->tail.load(std::memory_order_relaxed) == inbound.position) {
+            return;
+        }
+        inbound.ring->tail.store(inbound.position);
+        signal(inbound.ring->spaceSignal, inbound.ring->spaceWaiters);
+    }
+
+    ErrorCode SharedMemoryConnection::waitForData() {
+        SharedRing& ring = *inbound.ring;
+        return waitUntil(ring.dataSignal, ring.dataWaiters, [this, &ring] {
+            inbound.peerPosition = ring.head.load(std::memory_order_acquire);
+            return inbound.peerPosition != inbound.position;
+        });
+    }
+
+    ErrorCode SharedMemoryConnection::waitForSpace() {
+        SharedRing& ring = *outbound.ring;
+        return waitUntil(ring.spaceSignal, ring.spaceWaiters, [this, &ring] {
+            outbound.peerPosition = ring.tail.load(std::memory_order_acquire);
+            return outbound.position - outbound.peerPosition < ringBytes;
+        });
+    }
+
+    template <typename Ready>
+    ErrorCode SharedMemoryConnection::waitUntil(std::atomic<uint32_t>& signal, std::atomic<uint32_t>& waiters, Ready ready) {
+        // A peer on another core usually answers within the spin, which is what keeps a
+        // round trip out of the kernel; spins that keep failing shrink the next budget so
+        // an idle or descheduled peer costs little CPU
+        for (uint32_t spin = 0; spin < spinLimit; ++spin) {
+            if (ready()) {
+                spinLimit = (std::min)(spinLimit * 2, spinCeiling);
+                return ErrorCode::SUCCESS;
+            }
+            cpuRelax();
+        }
+        spinLimit = (std::max)(spinLimit / 2, (std::min)(MIN_SPIN, spinCeiling));
+
+        while (true) {
+            waiters.fetch_add(1);
+            uint32_t expected = signal.load();
+            bool sleep = !ready() && region->closed.load() == 0;
+            if (sleep) {
+                futexWait(signal, expected, SLEEP_SLICE_MILLISECONDS);
+            }
+            waiters.fetch_sub(1);
+
+            if (!sleep || ready()) {
+                return ready() ? ErrorCode::SUCCESS : ErrorCode::CONNECTION_FAILED;
+            }
+            if (isPeerGone()) {
+                return ErrorCode::CONNECTION_FAILED;
+            }
+        }
+    }
+
+    bool SharedMemoryConnection::isPeerGone() const {
+        if (region->closed.load() != 0) {
+            return true;
+        }
+
+        // A peer that died without disconnecting never set the flag, but its socket closed
+        pollfd socketEvent{};
+        socketEvent.fd = control->getDescriptor();
+        socketEvent.events = POLLRDHUP;
+        return ::poll(&socketEvent, 1, 0) > 0 && (socketEvent.revents & (POLLRDHUP | POLLHUP | POLLERR)) != 0;
+    }
+}
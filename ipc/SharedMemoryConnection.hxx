@@ -0,0 +1,86 @@
+#ifndef SHARED_MEMORY_CONNECTION_HXX
+#define SHARED_MEMORY_CONNECTION_HXX
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "IpcConnection.hxx"
+#include "UnixSocketConnection.hxx"
+#include "../utils/ErrorCodes.hxx"
+
+namespace NumberStore {
+    struct SharedRegion;
+    struct SharedRing;
+
+    // Linux shared-memory connection for clients on the daemon's host.
+    //
+    // The client connects to the daemon's stream socket as usual; the daemon answers
+    // by passing a memfd (SCM_RIGHTS) holding two single-producer/single-consumer byte
+    // rings, one per direction, and from then on messages are copied through the rings
+    // without entering the kernel. Each message is a 4-byte little-endian length and
+    // its bytes, and a message larger than a ring simply flows through it in pieces.
+    // A reader spins for a while, with a limit that adapts to how often spinning paid
+    // off, before sleeping on a futex. The socket stays open so either side notices
+    // the other going away.
+    class SharedMemoryConnection : public IpcConnection {
+    private:
+        // This side's view of one ring
+        struct RingCursor {
+            SharedRing* ring = nullptr;
+            char* data = nullptr;
+            uint64_t position = 0;      // Our index (head when producing, tail when consuming)
+            uint64_t peerPosition = 0;  // Last index seen from the other side
+        };
+
+        std::unique_ptr<UnixSocketConnection> control;
+        SharedRegion* region;
+        size_t regionSize;
+        uint64_t ringBytes;
+        RingCursor inbound;
+        RingCursor outbound;
+        bool connected;
+        uint32_t spinLimit;
+        uint32_t spinCeiling;   // 0 on a single CPU, where the peer cannot run while we spin
+
+    public:
+        SharedMemoryConnection();
+        ~SharedMemoryConnection() override;
+
+        SharedMemoryConnection(const SharedMemoryConnection&) = delete;
+        SharedMemoryConnection& operator=(const SharedMemoryConnection&) = delete;
+
+        // Client side: connects to the daemon's socket and maps the region it sends
+        ErrorCode connect(const std::string& path);
+        // Daemon side: creates a region for a freshly accepted socket and passes it over
+        ErrorCode accept(std::unique_ptr<UnixSocketConnection> socket);
+        ErrorCode disconnect() override;
+
+        ErrorCode write(const std::string& data) override;
+        ErrorCode read(std::string& data) override;
+        ErrorCode readFrame(std::string& frame) override;
+
+        bool isConnected() const override;
+
+        static constexpr uint32_t MIN_SPIN = 64;
+        static constexpr uint32_t MAX_SPIN = 16384;
+        static const int SLEEP_SLICE_MILLISECONDS = 100; // Futex waits are cut into slices to notice a dead peer
+
+    private:
+        void cleanup();
+        ErrorCode mapRegion(int memoryFd, bool create);
+        ErrorCode readMessage(std::string& message);
+        ErrorCode produce(const char* data, size_t size);
+        ErrorCode consume(char* data, size_t size);
+        void publishProduced();
+        void publishConsumed();
+        ErrorCode waitForData();
+        ErrorCode waitForSpace();
+        template <typename Ready>
+        ErrorCode waitUntil(std::atomic<uint32_t>& signal, std::atomic<uint32_t>& waiters, Ready ready);
+        bool isPeerGone() const;
+    };
+}
+
+#endif // SHARED_MEMORY_CONNECTION_HXX
@@ -0,0 +1,40 @@
+#include "SharedMemoryServer.hxx"
+#include "SharedMemoryConnection.hxx"
+#include "../utils/Logger.hxx"
+
+namespace NumberStore {
+    SharedMemoryServer::SharedMemoryServer() : listener(false) {
+    }
+
+    SharedMemoryServer::~SharedMemoryServer() {
+        stop();
+    }
+
+    ErrorCode SharedMemoryServer::start(const std::string& path) {
+        return listener.start(path);
+    }
+
+    ErrorCode SharedMemoryServer::stop() {
+        return listener.stop();
+    }
+
+    std::unique_ptr<IpcConnection> SharedMemoryServer::acceptConnection() {
+        std::unique_ptr<IpcConnection> accepted = listener.acceptConnection();
+        if (!accepted) {
+            return nullptr;
+        }
+
+        // UnixSocketServer only ever hands out UnixSocketConnections
+        std::unique_ptr<UnixSocketConnection> socket(static_cast<UnixSocketConnection*>(accepted.release()));
+        auto connection = std::make_unique<SharedMemoryConnection>();
+        if (connection->accept(std::move(socket)) != ErrorCode::SUCCESS) {
+            Logger::getInstance().error("Failed to set up shared memory for a new client");
+            return nullptr;
+        }
+        return connection;
+    }
+
+    bool SharedMemoryServer::isListening() const {
+        return listener.isListening();
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef SHARED_MEMORY_SERVER_HXX
+#define SHARED_MEMORY_SERVER_HXX
+
+#include <string>
+#include <memory>
+#include "IpcServer.hxx"
+#include "UnixSocketServer.hxx"
+#include "../utils/ErrorCodes.hxx"
+
+namespace NumberStore {
+    // Accepts clients on a Unix stream socket and moves each one onto a shared-memory
+    // region (see SharedMemoryConnection). The connections have no pollable descriptor,
+    // so the daemon serves each from a thread of its own that waits on the ring.
+    class SharedMemoryServer : public IpcServer {
+    private:
+        UnixSocketServer listener;
+
+    public:
+        SharedMemoryServer();
+        ~SharedMemoryServer() override;
+
+        SharedMemoryServer(const SharedMemoryServer&) = delete;
+        SharedMemoryServer& operator=(const SharedMemoryServer&) = delete;
+
+        ErrorCode start(const std::string& path) override;
+        ErrorCode stop() override;
+        
+        std::unique_ptr<IpcConnection> acceptConnection() override;
+        
+        bool isListening() const override;
+    };
+}
+
+#endif // SHARED_MEMORY_SERVER_HXX
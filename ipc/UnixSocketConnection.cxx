@@ -0,0 +1,572 @@
+#include "UnixSocketConnection.hxx"
+#include "../utils/Logger.hxx"
+#include "../utils/Config.hxx"
+#include "../utils/Constants.hxx"
+#include "../utils/ByteOrder.hxx"
+#include "BufferPool.hxx"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace NumberStore {
+    namespace {
+        const auto CONNECT_RETRY_INTERVAL = std::chrono::milliseconds(50);
+    }
+
+    UnixSocketConnection::UnixSocketConnection(bool seqpacket)
+        : UnixSocketConnection(-1, seqpacket) {
+    }
+
+    UnixSocketConnection::UnixSocketConnection(int fd, bool seqpacket)
+        : socketFd(fd), connected(fd >= 0), packetMode(seqpacket), nonBlocking(false),
+          completionDriven(false), endOfStream(false), receiveStart(0), receiveEnd(0), pendingOffset(0), pendingBytes(0) {
+        if (packetMode && fd >= 0) {
+            configurePacketSocket(fd);
+        }
+    }
+
+    UnixSocketConnection::~UnixSocketConnection() {
+        cleanup();
+    }
+
+    ErrorCode UnixSocketConnection::connect(const std::string& path) {
+        if (connected) {
+            return ErrorCode::SUCCESS;
+        }
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            Logger::getInstance().error("Socket path too long: " + path);
+            return ErrorCode::PIPE_CONNECT_FAILED;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        socketPath = path;
+
+        // Like WaitNamedPipe: a daemon that is still starting up gets until the timeout to listen
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(Config::getInstance().getConnectionTimeout());
+        while (true) {
+            int fd = ::socket(AF_UNIX, (packetMode ? SOCK_SEQPACKET : SOCK_STREAM) | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                Logger::getInstance().error("socket failed: " + std::string(std::strerror(errno)));
+                return ErrorCode::PIPE_CONNECT_FAILED;
+            }
+
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+                socketFd = fd;
+                if (packetMode) {
+                    configurePacketSocket(fd);
+                }
+                break;
+            }
+
+            int error = errno;
+            ::close(fd);
+            bool retryable = error == ENOENT || error == ECONNREFUSED || error == EAGAIN;
+            if (!retryable || std::chrono::steady_clock::now() >= deadline) {
+                Logger::getInstance().error("connect to " + path + " failed: " + std::strerror(error));
+                return ErrorCode::PIPE_CONNECT_FAILED;
+            }
+            std::this_thread::sleep_for(CONNECT_RETRY_INTERVAL);
+        }
+
+        connected = true;
+        receiveStart = receiveEnd = 0;
+        Logger::getInstance().info("Connected to socket: " + path);
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode UnixSocketConnection::disconnect() {
+        if (!connected) {
+            return ErrorCode::SUCCESS;
+        }
+
+        cleanup();
+        Logger::getInstance().info("Disconnected from socket: " + socketPath);
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode UnixSocketConnection::write(const std::string& data) {
+        if (!connected) {
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        char header[4];
+        size_t headerSize = 0;
+        if (!packetMode) {
+            ByteOrder::putUint32(header, static_cast<uint32_t>(data.size()));
+            headerSize = sizeof(header);
+        }
+
+        return nonBlocking ? queueMessage(header, headerSize, data.data(), data.size())
+                           : sendAll(header, headerSize, data.data(), data.size());
+    }
+
+    ErrorCode UnixSocketConnection::read(std::string& data) {
+        return readMessage(data);
+    }
+
+    ErrorCode UnixSocketConnection::readFrame(std::string& frame) {
+        // Binary frames are ordinary messages here; their own length prefix travels inside
+        ErrorCode result = readMessage(frame);
+        if (result == ErrorCode::SUCCESS && (frame.size() < 4 || ByteOrder::getUint32(frame.data()) != frame.size() - 4)) {
+            Logger::getInstance().error("Received frame does not match its length prefix");
+            return ErrorCode::READ_FAILED;
+        }
+        return result;
+    }
+
+    bool UnixSocketConnection::isConnected() const {
+        return connected && socketFd >= 0;
+    }
+
+    int UnixSocketConnection::getDescriptor() const {
+        return socketFd;
+    }
+
+    ErrorCode UnixSocketConnection::setNonBlocking(bool enabled) {
+        int flags = ::fcntl(socketFd, F_GETFL, 0);
+        if (flags < 0 || ::fcntl(socketFd, F_SETFL, enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) != 0) {
+            Logger::getInstance().error("fcntl failed: " + std::string(std::strerror(errno)));
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        nonBlocking = enabled;
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode UnixSocketConnection::flushPending() {
+        if (completionDriven) {
+            // The event loop sends the queue itself
+            return pendingBytes > 0 ? ErrorCode::WOULD_BLOCK : ErrorCode::SUCCESS;
+        }
+        return sendPending();
+    }
+
+    size_t UnixSocketConnection::getPendingBytes() const {
+        return pendingBytes;
+    }
+
+    ErrorCode UnixSocketConnection::setCompletionDriven(bool enabled) {
+        if (enabled && packetMode) {
+            return ErrorCode::INVALID_COMMAND;
+        }
+
+        // Non-blocking as well, so the best-effort flush on disconnect cannot stall the loop
+        ErrorCode result = setNonBlocking(enabled);
+        if (result == ErrorCode::SUCCESS) {
+            completionDriven = enabled;
+        }
+        return result;
+    }
+
+    void UnixSocketConnection::deliverReceived(const char* data, size_t size) {
+        if (size == 0) {
+            endOfStream = true;
+            return;
+        }
+
+        size_t available = receiveEnd - receiveStart;
+        if (receiveBuffer.size() - receiveEnd < size && receiveStart > 0) {
+            std::memmove(receiveBuffer.data(), receiveBuffer.data() + receiveStart, available);
+            receiveStart = 0;
+            receiveEnd = available;
+        }
+        if (receiveBuffer.size() - receiveEnd < size) {
+            growReceiveBuffer((std::max)(receiveEnd + size, Constants::BUFFER_SIZE));
+        }
+
+        std::memcpy(receiveBuffer.data() + receiveEnd, data, size);
+        receiveEnd += size;
+    }
+
+    size_t UnixSocketConnection::getReceivedBytes() const {
+        return receiveEnd - receiveStart;
+    }
+
+    size_t UnixSocketConnection::gatherPending(iovec* parts, size_t maxParts) const {
+        // Stream mode hands many queued replies to one send; packets go one at a time
+        size_t count = 0;
+        for (auto it = pendingMessages.begin(); it != pendingMessages.end() && count < (packetMode ? 1 : maxParts); ++it) {
+            size_t skip = count == 0 ? pendingOffset : 0;
+            parts[count].iov_base = const_cast<char*>(it->data()) + skip;
+            parts[count].iov_len = it->size() - skip;
+            ++count;
+        }
+        return count;
+    }
+
+    void UnixSocketConnection::consumePending(size_t bytes) {
+        pendingBytes -= bytes;
+        bytes += pendingOffset;
+        while (!pendingMessages.empty() && bytes >= pendingMessages.front().size()) {
+            bytes -= pendingMessages.front().size();
+            recycleMessageBuffer(pendingMessages.front());
+            pendingMessages.pop_front();
+        }
+        pendingOffset = bytes;
+    }
+
+    ErrorCode UnixSocketConnection::sendPending() {
+        const size_t MAX_PARTS = 64;
+        iovec parts[MAX_PARTS];
+
+        while (!pendingMessages.empty()) {
+            msghdr message{};
+            message.msg_iov = parts;
+            message.msg_iovlen = gatherPending(parts, MAX_PARTS);
+
+            size_t sent = 0;
+            ErrorCode result = sendOnce(message, sent);
+            if (result != ErrorCode::SUCCESS) {
+                return result;
+            }
+            consumePending(sent);
+        }
+
+        return ErrorCode::SUCCESS;
+    }
+
+    void UnixSocketConnection::configurePacketSocket(int fd) {
+        int size = Constants::SEQPACKET_SEND_BUFFER;
+        if (::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) != 0) {
+            Logger::getInstance().warning("Failed to raise socket send buffer: " + std::string(std::strerror(errno)));
+        }
+    }
+
+    void UnixSocketConnection::cleanup() {
+        if (completionDriven && connected && pendingBytes > 0) {
+            // Best effort for what the event loop had not sent yet, such as the EXIT answer
+            sendPending();
+        }
+        
+        if (socketFd >= 0) {
+            ::close(socketFd);
+            socketFd = -1;
+        }
+        connected = false;
+        endOfStream = false;
+        receiveStart = receiveEnd = 0;
+        pendingOffset = pendingBytes = 0;
+        
+        // The next connection, whichever it is, picks up the memory
+        BufferPool& pool = BufferPool::getInstance();
+        pool.release(receiveBuffer);
+        for (auto& buffer : pendingMessages) {
+            pool.release(buffer);
+        }
+        for (auto& buffer : spareMessages) {
+            pool.release(buffer);
+        }
+        pendingMessages.clear();
+        spareMessages.clear();
+    }
+
+    void UnixSocketConnection::growReceiveBuffer(size_t size) {
+        if (receiveBuffer.empty()) {
+            receiveBuffer = BufferPool::getInstance().acquire(size);
+        } else {
+            receiveBuffer.resize(size);
+        }
+    }
+
+    std::vector<char> UnixSocketConnection::takeMessageBuffer() {
+        if (spareMessages.empty()) {
+            return BufferPool::getInstance().acquire(0);
+        }
+
+        std::vector<char> buffer = std::move(spareMessages.back());
+        spareMessages.pop_back();
+        return buffer;
+    }
+
+    void UnixSocketConnection::recycleMessageBuffer(std::vector<char>& buffer) {
+        // Kept here first, so a busy connection reuses its own buffers without locking the pool
+        if (spareMessages.size() < Constants::SPARE_MESSAGE_BUFFERS && buffer.capacity() <= Constants::BUFFER_POOL_MAX_CAPACITY) {
+            buffer.clear();
+            spareMessages.push_back(std::move(buffer));
+        } else {
+            BufferPool::getInstance().release(buffer);
+        }
+    }
+
+    ErrorCode UnixSocketConnection::readMessage(std::string& message) {
+        if (!connected) {
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        if (packetMode) {
+            // Peek with MSG_TRUNC to learn the packet size, then take the packet in one call
+            ssize_t size;
+            do {
+                size = ::recv(socketFd, nullptr, 0, MSG_PEEK | MSG_TRUNC);
+            } while (size < 0 && errno == EINTR);
+
+            if (size <= 0) {
+                if (size == 0 || errno == ECONNRESET) {
+                    connected = false;
+                    return ErrorCode::CONNECTION_FAILED;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return ErrorCode::WOULD_BLOCK;
+                }
+                Logger::getInstance().error("recv failed: " + std::string(std::strerror(errno)));
+                return ErrorCode::READ_FAILED;
+            }
+
+            message.resize(static_cast<size_t>(size));
+            size_t received = 0;
+            return receiveSome(&message[0], message.size(), received);
+        }
+
+        if (nonBlocking) {
+            return readBufferedMessage(message);
+        }
+
+        char header[4];
+        ErrorCode result = receiveExact(header, sizeof(header));
+        if (result != ErrorCode::SUCCESS) {
+            return result;
+        }
+
+        uint32_t length = ByteOrder::getUint32(header);
+        if (length > Constants::MAX_FRAME_SIZE) {
+            Logger::getInstance().error("Message too large: " + std::to_string(length) + " bytes");
+            return ErrorCode::READ_FAILED;
+        }
+
+        message.resize(length);
+        return length == 0 ? ErrorCode::SUCCESS : receiveExact(&message[0], length);
+    }
+
+    ErrorCode UnixSocketConnection::readBufferedMessage(std::string& message) {
+        // Nothing is consumed until a whole message is buffered, so a WOULD_BLOCK can be
+        // resumed on the next readiness event. The buffer starts small because an event
+        // loop may hold thousands of mostly idle connections
+        while (true) {
+            size_t available = receiveEnd - receiveStart;
+            size_t needed = 4;
+
+            if (available >= 4) {
+                uint32_t length = ByteOrder::getUint32(receiveBuffer.data() + receiveStart);
+                if (length > Constants::MAX_FRAME_SIZE) {
+                    Logger::getInstance().error("Message too large: " + std::to_string(length) + " bytes");
+                    return ErrorCode::READ_FAILED;
+                }
+
+                needed += length;
+                if (available >= needed) {
+                    message.assign(receiveBuffer.data() + receiveStart + 4, length);
+                    receiveStart += needed;
+
+                    if (receiveStart == receiveEnd) {
+                        receiveStart = receiveEnd = 0;
+                        if (receiveBuffer.size() > Constants::SOCKET_RECEIVE_BUFFER) {
+                            // Give back the room an oversized message needed
+                            BufferPool::getInstance().release(receiveBuffer);
+                        }
+                    }
+                    return ErrorCode::SUCCESS;
+                }
+            }
+
+            if (receiveStart > 0) {
+                std::memmove(receiveBuffer.data(), receiveBuffer.data() + receiveStart, available);
+                receiveStart = 0;
+                receiveEnd = available;
+            }
+            if (receiveBuffer.size() < needed) {
+                growReceiveBuffer((std::max)(needed, Constants::BUFFER_SIZE));
+            }
+
+            if (completionDriven) {
+                // Only what the event loop delivered can be parsed
+                if (endOfStream) {
+                    connected = false;
+                    return ErrorCode::CONNECTION_FAILED;
+                }
+                return ErrorCode::WOULD_BLOCK;
+            }
+
+            size_t received = 0;
+            ErrorCode result = receiveSome(receiveBuffer.data() + receiveEnd, receiveBuffer.size() - receiveEnd, received);
+            if (result != ErrorCode::SUCCESS) {
+                return result;
+            }
+            receiveEnd += received;
+        }
+    }
+
+    ErrorCode UnixSocketConnection::receiveExact(char* buffer, size_t size) {
+        if (receiveBuffer.size() < Constants::SOCKET_RECEIVE_BUFFER) {
+            growReceiveBuffer(Constants::SOCKET_RECEIVE_BUFFER);
+        }
+
+        while (size > 0) {
+            if (receiveStart == receiveEnd) {
+                size_t received = 0;
+                ErrorCode result;
+
+                if (size >= receiveBuffer.size()) {
+                    // Large remainder: read straight into the destination
+                    result = receiveSome(buffer, size, received);
+                    if (result != ErrorCode::SUCCESS) {
+                        return result;
+                    }
+                    buffer += received;
+                    size -= received;
+                    continue;
+                }
+
+                result = receiveSome(receiveBuffer.data(), receiveBuffer.size(), received);
+                if (result != ErrorCode::SUCCESS) {
+                    return result;
+                }
+                receiveStart = 0;
+                receiveEnd = received;
+            }
+
+            size_t available = (std::min)(size, receiveEnd - receiveStart);
+            std::memcpy(buffer, receiveBuffer.data() + receiveStart, available);
+            receiveStart += available;
+            buffer += available;
+            size -= available;
+        }
+
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode UnixSocketConnection::receiveSome(char* buffer, size_t capacity, size_t& outReceived) {
+        ssize_t received;
+        do {
+            received = ::recv(socketFd, buffer, capacity, 0);
+        } while (received < 0 && errno == EINTR);
+
+        if (received > 0) {
+            outReceived = static_cast<size_t>(received);
+            return ErrorCode::SUCCESS;
+        }
+
+        if (received == 0 || errno == ECONNRESET) {
+            connected = false;
+            return ErrorCode::CONNECTION_FAILED;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return ErrorCode::WOULD_BLOCK;
+        }
+
+        Logger::getInstance().error("recv failed: " + std::string(std::strerror(errno)));
+        return ErrorCode::READ_FAILED;
+    }
+
+    ErrorCode UnixSocketConnection::sendAll(const char* header, size_t headerSize, const char* data, size_t size) {
+        // Header and payload leave in one sendmsg; partial stream writes resume where they stopped
+        iovec parts[2];
+        parts[0].iov_base = const_cast<char*>(header);
+        parts[0].iov_len = headerSize;
+        parts[1].iov_base = const_cast<char*>(data);
+        parts[1].iov_len = size;
+
+        msghdr message{};
+        message.msg_iov = headerSize > 0 ? parts : parts + 1;
+        message.msg_iovlen = headerSize > 0 ? 2 : 1;
+
+        while (message.msg_iovlen > 0) {
+            size_t sent = 0;
+            ErrorCode result = sendOnce(message, sent);
+            if (result != ErrorCode::SUCCESS) {
+                return result;
+            }
+
+            while (message.msg_iovlen > 0 && sent >= message.msg_iov->iov_len) {
+                sent -= message.msg_iov->iov_len;
+                ++message.msg_iov;
+                --message.msg_iovlen;
+            }
+            if (message.msg_iovlen > 0) {
+                message.msg_iov->iov_base = static_cast<char*>(message.msg_iov->iov_base) + sent;
+                message.msg_iov->iov_len -= sent;
+            }
+        }
+
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode UnixSocketConnection::queueMessage(const char* header, size_t headerSize, const char* data, size_t size) {
+        size_t sent = 0;
+
+        // Try the socket first so that replies to a client that keeps up never touch the queue
+        if (pendingMessages.empty() && !completionDriven) {
+            iovec parts[2];
+            parts[0].iov_base = const_cast<char*>(header);
+            parts[0].iov_len = headerSize;
+            parts[1].iov_base = const_cast<char*>(data);
+            parts[1].iov_len = size;
+
+            msghdr message{};
+            message.msg_iov = headerSize > 0 ? parts : parts + 1;
+            message.msg_iovlen = headerSize > 0 ? 2 : 1;
+
+            ErrorCode result = sendOnce(message, sent);
+            if (result == ErrorCode::WOULD_BLOCK) {
+                sent = 0;
+            } else if (result != ErrorCode::SUCCESS) {
+                return result;
+            }
+
+            if (sent == headerSize + size) {
+                return ErrorCode::SUCCESS;
+            }
+        }
+
+        // Queue the unsent tail, in a recycled buffer; a packet is either sent whole or not at all
+        std::vector<char> remainder = takeMessageBuffer();
+        if (sent < headerSize) {
+            remainder.insert(remainder.end(), header + sent, header + headerSize);
+            remainder.insert(remainder.end(), data, data + size);
+        } else {
+            remainder.insert(remainder.end(), data + (sent - headerSize), data + size);
+        }
+
+        pendingBytes += remainder.size();
+        pendingMessages.push_back(std::move(remainder));
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode UnixSocketConnection::sendOnce(msghdr& message, size_t& outSent) {
+        ssize_t sent;
+        do {
+            sent = ::sendmsg(socketFd, &message, MSG_NOSIGNAL);
+        } while (sent < 0 && errno == EINTR);
+
+        if (sent >= 0) {
+            outSent = static_cast<size_t>(sent);
+            return ErrorCode::SUCCESS;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return ErrorCode::WOULD_BLOCK;
+        }
+        if (errno == EPIPE || errno == ECONNRESET) {
+            connected = false;
+            return ErrorCode::CONNECTION_FAILED;
+        }
+        if (errno == EMSGSIZE || errno == ENOBUFS) {
+            Logger::getInstance().error("Message exceeds the seqpacket socket buffer; use the stream transport");
+            return ErrorCode::WRITE_FAILED;
+        }
+
+        Logger::getInstance().error("sendmsg failed: " + std::string(std::strerror(errno)));
+        return ErrorCode::WRITE_FAILED;
+    }
+}
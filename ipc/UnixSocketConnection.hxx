@@ -0,0 +1,89 @@
+#ifndef UNIX_SOCKET_CONNECTION_HXX
+#define UNIX_SOCKET_CONNECTION_HXX
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include "IpcConnection.hxx"
+#include "../utils/ErrorCodes.hxx"
+
+struct msghdr;
+
+namespace NumberStore {
+    // AF_UNIX socket connection.
+    //
+    // SOCK_SEQPACKET keeps message boundaries in the kernel, like a message-mode
+    // pipe, so each message is sent as one packet. SOCK_STREAM has no boundaries,
+    // so every message goes out behind a 4-byte little-endian length; received
+    // bytes are buffered so that pipelined messages cost one recv between them.
+    class UnixSocketConnection : public IpcConnection {
+    private:
+        int socketFd;
+        bool connected;
+        bool packetMode;
+        bool nonBlocking;
+        bool completionDriven;
+        bool endOfStream;       // Completion-driven mode: the loop saw the peer close
+        std::string socketPath;
+        std::vector<char> receiveBuffer; // Stream mode: bytes received but not yet returned (from BufferPool)
+        size_t receiveStart;
+        size_t receiveEnd;
+        // Non-blocking mode: messages the socket could not take yet (framed in stream
+        // mode), and how much of the front one has already gone out
+        std::deque<std::vector<char>> pendingMessages;
+        size_t pendingOffset;
+        size_t pendingBytes;
+        std::vector<std::vector<char>> spareMessages; // Sent messages' buffers, for the next ones
+
+    public:
+        explicit UnixSocketConnection(bool seqpacket);
+        UnixSocketConnection(int fd, bool seqpacket);
+        ~UnixSocketConnection() override;
+
+        UnixSocketConnection(const UnixSocketConnection&) = delete;
+        UnixSocketConnection& operator=(const UnixSocketConnection&) = delete;
+
+        // Retries until the daemon's socket accepts or the configured connection timeout passes
+        ErrorCode connect(const std::string& path);
+        ErrorCode disconnect() override;
+        
+        ErrorCode write(const std::string& data) override;
+        ErrorCode read(std::string& data) override;
+        ErrorCode readFrame(std::string& frame) override;
+        
+        bool isConnected() const override;
+        
+        int getDescriptor() const override;
+        ErrorCode setNonBlocking(bool enabled) override;
+        ErrorCode flushPending() override;
+        size_t getPendingBytes() const override;
+        
+        // Stream sockets only; packets would need a receive buffer per message
+        ErrorCode setCompletionDriven(bool enabled) override;
+        void deliverReceived(const char* data, size_t size) override;
+        size_t getReceivedBytes() const override;
+        size_t gatherPending(::iovec* parts, size_t maxParts) const override;
+        void consumePending(size_t bytes) override;
+        
+        // Raises the send buffer of a seqpacket socket so whole batches fit in one packet
+        static void configurePacketSocket(int fd);
+        
+    private:
+        void cleanup();
+        ErrorCode readMessage(std::string& message);
+        ErrorCode readBufferedMessage(std::string& message);
+        ErrorCode receiveExact(char* buffer, size_t size);
+        ErrorCode receiveSome(char* buffer, size_t capacity, size_t& outReceived);
+        ErrorCode sendAll(const char* header, size_t headerSize, const char* data, size_t size);
+        ErrorCode queueMessage(const char* header, size_t headerSize, const char* data, size_t size);
+        void growReceiveBuffer(size_t size);
+        std::vector<char> takeMessageBuffer();
+        void recycleMessageBuffer(std::vector<char>& buffer);
+        ErrorCode sendPending();
+        // One sendmsg() attempt; WOULD_BLOCK if the socket buffer is full
+        ErrorCode sendOnce(::msghdr& message, size_t& outSent);
+    };
+}
+
+#endif // UNIX_SOCKET_CONNECTION_HXX
@@ -0,0 +1,111 @@
+#include "UnixSocketServer.hxx"
+#include "../utils/Logger.hxx"
+#include "../utils/Config.hxx"
+#include <cstring>
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace NumberStore {
+    UnixSocketServer::UnixSocketServer(bool seqpacket)
+        : listenFd(-1), listening(false), packetMode(seqpacket) {
+    }
+
+    UnixSocketServer::~UnixSocketServer() {
+        stop();
+    }
+
+    ErrorCode UnixSocketServer::start(const std::string& path) {
+        if (listening) {
+            return ErrorCode::SUCCESS;
+        }
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            Logger::getInstance().error("Socket path too long: " + path);
+            return ErrorCode::PIPE_CREATE_FAILED;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        listenFd = ::socket(AF_UNIX, (packetMode ? SOCK_SEQPACKET : SOCK_STREAM) | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) {
+            Logger::getInstance().error("socket failed: " + std::string(std::strerror(errno)));
+            return ErrorCode::PIPE_CREATE_FAILED;
+        }
+
+        // The single-instance lock is already held, so a leftover socket file can only
+        // belong to a daemon that died without cleaning up
+        ::unlink(path.c_str());
+
+        if (::bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd, static_cast<int>(Config::getInstance().getMaxConnections())) != 0) {
+            Logger::getInstance().error("Failed to listen on " + path + ": " + std::strerror(errno));
+            ::close(listenFd);
+            listenFd = -1;
+            return ErrorCode::PIPE_CREATE_FAILED;
+        }
+
+        socketPath = path;
+        listening = true;
+        Logger::getInstance().info("Unix socket server started on: " + socketPath);
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode UnixSocketServer::stop() {
+        if (!listening) {
+            return ErrorCode::SUCCESS;
+        }
+
+        listening = false;
+        ::close(listenFd);
+        listenFd = -1;
+        ::unlink(socketPath.c_str());
+        Logger::getInstance().info("Unix socket server stopped");
+        return ErrorCode::SUCCESS;
+    }
+
+    std::unique_ptr<IpcConnection> UnixSocketServer::acceptConnection() {
+        if (!listening) {
+            return nullptr;
+        }
+
+        pollfd waiter{};
+        waiter.fd = listenFd;
+        waiter.events = POLLIN;
+        if (::poll(&waiter, 1, ACCEPT_POLL_MILLISECONDS) <= 0 || !(waiter.revents & POLLIN)) {
+            return nullptr;
+        }
+
+        int clientFd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            // EBADF: stop() closed the socket while this call was waiting
+            if (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED && errno != EBADF) {
+                Logger::getInstance().error("accept failed: " + std::string(std::strerror(errno)));
+            }
+            return nullptr;
+        }
+
+        Logger::getInstance().info("Client connected to socket: " + socketPath);
+        return std::make_unique<UnixSocketConnection>(clientFd, packetMode);
+    }
+
+    bool UnixSocketServer::isListening() const {
+        return listening;
+    }
+
+    int UnixSocketServer::getDescriptor() const {
+        return listenFd;
+    }
+
+    std::unique_ptr<IpcConnection> UnixSocketServer::adoptConnection(int fd) {
+        return std::make_unique<UnixSocketConnection>(fd, packetMode);
+    }
+
+    const std::string& UnixSocketServer::getSocketPath() const {
+        return socketPath;
+    }
+}
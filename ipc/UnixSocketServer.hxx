@@ -0,0 +1,40 @@
+#ifndef UNIX_SOCKET_SERVER_HXX
+#define UNIX_SOCKET_SERVER_HXX
+
+#include <string>
+#include <memory>
+#include "IpcServer.hxx"
+#include "UnixSocketConnection.hxx"
+#include "../utils/ErrorCodes.hxx"
+
+namespace NumberStore {
+    class UnixSocketServer : public IpcServer {
+    private:
+        std::string socketPath;
+        int listenFd;
+        bool listening;
+        bool packetMode;
+
+    public:
+        explicit UnixSocketServer(bool seqpacket);
+        ~UnixSocketServer() override;
+
+        UnixSocketServer(const UnixSocketServer&) = delete;
+        UnixSocketServer& operator=(const UnixSocketServer&) = delete;
+
+        ErrorCode start(const std::string& path) override;
+        ErrorCode stop() override;
+        
+        // Waits up to ACCEPT_POLL_MILLISECONDS for a client, then returns nullptr
+        std::unique_ptr<IpcConnection> acceptConnection() override;
+        
+        bool isListening() const override;
+        int getDescriptor() const override;
+        std::unique_ptr<IpcConnection> adoptConnection(int fd) override;
+        const std::string& getSocketPath() const;
+        
+        static const int ACCEPT_POLL_MILLISECONDS = 100;
+    };
+}
+
+#endif // UNIX_SOCKET_SERVER_HXX
@@ -0,0 +1,236 @@
+#include "BinaryCodec.hxx"
+#include "../utils/ByteOrder.hxx"
+#include "../utils/Logger.hxx"
+
+namespace NumberStore {
+    namespace {
+        enum class Opcode : uint8_t {
+            INSERT = 0x01,
+            DELETE_NUM = 0x02,
+            PRINT_ALL = 0x03,
+            DELETE_ALL = 0x04,
+            EXIT = 0x05,
+            RANGE = 0x06,
+            PAGE = 0x07,
+            COUNT = 0x08,
+            STREAM_ALL = 0x09,
+            HELLO = 0x0A,
+            INSERT_MANY = 0x0B,
+            DELETE_MANY = 0x0C,
+            STATS = 0x0D,
+            SAVE = 0x0E,
+
+            RESP_SUCCESS = 0x81,
+            RESP_ERROR = 0x82,
+            RESP_DATA = 0x83,
+            RESP_CHUNK = 0x84
+        };
+
+        const size_t OFFSET_OPCODE = 4;
+        const size_t OFFSET_FLAGS = 5;
+        const size_t OFFSET_REQUEST_ID = 8;
+
+        bool commandToOpcode(CommandType type, Opcode& outOpcode) {
+            switch (type) {
+                case CommandType::INSERT: outOpcode = Opcode::INSERT; return true;
+                case CommandType::DELETE_NUM: outOpcode = Opcode::DELETE_NUM; return true;
+                case CommandType::PRINT_ALL: outOpcode = Opcode::PRINT_ALL; return true;
+                case CommandType::DELETE_ALL: outOpcode = Opcode::DELETE_ALL; return true;
+                case CommandType::EXIT: outOpcode = Opcode::EXIT; return true;
+                case CommandType::RANGE: outOpcode = Opcode::RANGE; return true;
+                case CommandType::PAGE: outOpcode = Opcode::PAGE; return true;
+                case CommandType::COUNT: outOpcode = Opcode::COUNT; return true;
+                case CommandType::STREAM_ALL: outOpcode = Opcode::STREAM_ALL; return true;
+                case CommandType::HELLO: outOpcode = Opcode::HELLO; return true;
+                case CommandType::INSERT_MANY: outOpcode = Opcode::INSERT_MANY; return true;
+                case CommandType::DELETE_MANY: outOpcode = Opcode::DELETE_MANY; return true;
+                case CommandType::STATS: outOpcode = Opcode::STATS; return true;
+                case CommandType::SAVE: outOpcode = Opcode::SAVE; return true;
+                default: return false;
+            }
+        }
+
+        bool opcodeToCommand(uint8_t opcode, CommandType& outType) {
+            switch (static_cast<Opcode>(opcode)) {
+                case Opcode::INSERT: outType = CommandType::INSERT; return true;
+                case Opcode::DELETE_NUM: outType = CommandType::DELETE_NUM; return true;
+                case Opcode::PRINT_ALL: outType = CommandType::PRINT_ALL; return true;
+                case Opcode::DELETE_ALL: outType = CommandType::DELETE_ALL; return true;
+                case Opcode::EXIT: outType = CommandType::EXIT; return true;
+                case Opcode::RANGE: outType = CommandType::RANGE; return true;
+                case Opcode::PAGE: outType = CommandType::PAGE; return true;
+                case Opcode::COUNT: outType = CommandType::COUNT; return true;
+                case Opcode::STREAM_ALL: outType = CommandType::STREAM_ALL; return true;
+                case Opcode::HELLO: outType = CommandType::HELLO; return true;
+                case Opcode::INSERT_MANY: outType = CommandType::INSERT_MANY; return true;
+                case Opcode::DELETE_MANY: outType = CommandType::DELETE_MANY; return true;
+                case Opcode::STATS: outType = CommandType::STATS; return true;
+                case Opcode::SAVE: outType = CommandType::SAVE; return true;
+                default: return false;
+            }
+        }
+
+        size_t operandCount(CommandType type) {
+            switch (type) {
+                case CommandType::INSERT:
+                case CommandType::DELETE_NUM:
+                case CommandType::HELLO:
+                    return 1;
+                case CommandType::RANGE:
+                case CommandType::PAGE:
+                case CommandType::COUNT:
+                    return 2;
+                default:
+                    return 0;
+            }
+        }
+    }
+
+    void BinaryCodec::encodeCommand(const Command& command, uint32_t requestId, std::string& out) {
+        Opcode opcode = Opcode::EXIT;
+        if (!commandToOpcode(command.getCommandType(), opcode)) {
+            Logger::getInstance().error("Command type has no binary opcode");
+        }
+
+        if (command.isBatch()) {
+            const std::vector<uint64_t>& values = command.getValues();
+            writeHeader(out, static_cast<uint8_t>(opcode), requestId, values.size() * 8);
+
+            char* payload = &out[HEADER_SIZE];
+            for (size_t i = 0; i < values.size(); ++i) {
+                ByteOrder::putUint64(payload + i * 8, values[i]);
+            }
+            return;
+        }
+
+        size_t operands = operandCount(command.getCommandType());
+        writeHeader(out, static_cast<uint8_t>(opcode), requestId, operands * 8);
+
+        char* payload = &out[HEADER_SIZE];
+        if (operands >= 1) {
+            ByteOrder::putUint64(payload, command.getNumber());
+        }
+        if (operands == 2) {
+            ByteOrder::putUint64(payload + 8, command.getArgument());
+        }
+    }
+
+    void BinaryCodec::encodeResponse(const Response& response, uint32_t requestId, std::string& out) {
+        const std::string& data = response.getData();
+
+        switch (response.getResponseType()) {
+            case ResponseType::ERROR_RESPONSE:
+                writeHeader(out, static_cast<uint8_t>(Opcode::RESP_ERROR), requestId, 4 + data.size());
+                ByteOrder::putUint32(&out[HEADER_SIZE], static_cast<uint32_t>(response.getErrorCode()));
+                out.replace(HEADER_SIZE + 4, data.size(), data);
+                return;
+            case ResponseType::DATA:
+                writeHeader(out, static_cast<uint8_t>(Opcode::RESP_DATA), requestId, data.size());
+                break;
+            case ResponseType::CHUNK:
+                writeHeader(out, static_cast<uint8_t>(Opcode::RESP_CHUNK), requestId, data.size());
+                break;
+            default:
+                writeHeader(out, static_cast<uint8_t>(Opcode::RESP_SUCCESS), requestId, data.size());
+                break;
+        }
+
+        out.replace(HEADER_SIZE, data.size(), data);
+    }
+
+    std::unique_ptr<Command> BinaryCodec::decodeCommand(const std::string& frame, uint32_t& outRequestId) {
+        auto command = std::make_unique<Command>(CommandType::EXIT);
+        if (!decodeCommand(std::string_view(frame), *command, outRequestId)) {
+            return nullptr;
+        }
+        return command;
+    }
+
+    bool BinaryCodec::decodeCommand(std::string_view frame, Command& outCommand, uint32_t& outRequestId) {
+        uint8_t opcode;
+        CommandType type;
+        if (!readHeader(frame, opcode, outRequestId) || !opcodeToCommand(opcode, type)) {
+            Logger::getInstance().error("Malformed binary command frame");
+            return false;
+        }
+
+        const char* payload = frame.data() + HEADER_SIZE;
+        size_t payloadSize = frame.size() - HEADER_SIZE;
+
+        if (type == CommandType::INSERT_MANY || type == CommandType::DELETE_MANY) {
+            if (payloadSize == 0 || payloadSize % 8 != 0) {
+                Logger::getInstance().error("Binary batch frame has the wrong payload size");
+                return false;
+            }
+
+            std::vector<uint64_t> values(payloadSize / 8);
+            for (size_t i = 0; i < values.size(); ++i) {
+                values[i] = ByteOrder::getUint64(payload + i * 8);
+            }
+            outCommand = Command(type, std::move(values));
+            return true;
+        }
+
+        size_t operands = operandCount(type);
+        if (payloadSize != operands * 8) {
+            Logger::getInstance().error("Binary command frame has the wrong payload size");
+            return false;
+        }
+
+        uint64_t number = operands >= 1 ? ByteOrder::getUint64(payload) : 0;
+        uint64_t argument = operands == 2 ? ByteOrder::getUint64(payload + 8) : 0;
+        outCommand = Command(type, number, argument);
+        return true;
+    }
+
+    std::unique_ptr<Response> BinaryCodec::decodeResponse(const std::string& frame, uint32_t& outRequestId) {
+        uint8_t opcode;
+        if (!readHeader(frame, opcode, outRequestId)) {
+            Logger::getInstance().error("Malformed binary response frame");
+            return nullptr;
+        }
+
+        const char* payload = frame.data() + HEADER_SIZE;
+        size_t payloadSize = frame.size() - HEADER_SIZE;
+
+        switch (static_cast<Opcode>(opcode)) {
+            case Opcode::RESP_SUCCESS:
+                return std::make_unique<Response>(ResponseType::SUCCESS, ErrorCode::SUCCESS, std::string(payload, payloadSize));
+            case Opcode::RESP_DATA:
+                return std::make_unique<Response>(ResponseType::DATA, ErrorCode::SUCCESS, std::string(payload, payloadSize));
+            case Opcode::RESP_CHUNK:
+                return std::make_unique<Response>(ResponseType::CHUNK, ErrorCode::SUCCESS, std::string(payload, payloadSize));
+            case Opcode::RESP_ERROR:
+                if (payloadSize < 4) {
+                    break;
+                }
+                return std::make_unique<Response>(ResponseType::ERROR_RESPONSE,
+                                                  static_cast<ErrorCode>(ByteOrder::getUint32(payload)),
+                                                  std::string(payload + 4, payloadSize - 4));
+            default:
+                break;
+        }
+
+        Logger::getInstance().error("Unknown binary response opcode: " + std::to_string(opcode));
+        return nullptr;
+    }
+
+    void BinaryCodec::writeHeader(std::string& out, uint8_t opcode, uint32_t requestId, size_t payloadSize) {
+        out.assign(HEADER_SIZE + payloadSize, '\0');
+        ByteOrder::putUint32(&out[0], static_cast<uint32_t>(HEADER_SIZE - LENGTH_PREFIX_SIZE + payloadSize));
+        out[OFFSET_OPCODE] = static_cast<char>(opcode);
+        ByteOrder::putUint32(&out[OFFSET_REQUEST_ID], requestId);
+    }
+
+    bool BinaryCodec::readHeader(std::string_view frame, uint8_t& outOpcode, uint32_t& outRequestId) {
+        if (frame.size() < HEADER_SIZE ||
+            ByteOrder::getUint32(frame.data()) != frame.size() - LENGTH_PREFIX_SIZE ||
+            frame[OFFSET_FLAGS] != 0) {
+            return false;
+        }
+
+        outOpcode = static_cast<uint8_t>(frame[OFFSET_OPCODE]);
+        outRequestId = ByteOrder::getUint32(frame.data() + OFFSET_REQUEST_ID);
+        return true;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef BINARY_CODEC_HXX
+#define BINARY_CODEC_HXX
+
+#include "Command.hxx"
+#include "Response.hxx"
+#include <string>
+#include <memory>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+namespace NumberStore {
+    // Compact binary framing, negotiated per connection with HELLO.
+    //
+    // Every frame starts with a fixed 12-byte header (all integers little-endian):
+    //   [0, 4)   length of the rest of the frame (header remainder + payload)
+    //   [4]      opcode
+    //   [5]      flags (reserved, 0)
+    //   [6, 8)   reserved, 0
+    //   [8, 12)  request id, echoed back in the response
+    // followed by the payload:
+    //   INSERT, DELETE_NUM       number (u64)
+    //   RANGE, PAGE, COUNT       number (u64), argument (u64)
+    //   HELLO                    requested protocol version (u64)
+    //   INSERT_MANY, DELETE_MANY the numbers (u64 each), count implied by the length
+    //   other commands           empty
+    //   ERROR response           error code (u32), message bytes
+    //   other responses          data bytes
+    class BinaryCodec {
+    public:
+        static constexpr uint32_t PROTOCOL_VERSION = 1;
+        static constexpr size_t LENGTH_PREFIX_SIZE = 4;
+        static constexpr size_t HEADER_SIZE = 12;
+
+        static void encodeCommand(const Command& command, uint32_t requestId, std::string& out);
+        static void encodeResponse(const Response& response, uint32_t requestId, std::string& out);
+
+        // Return nullptr for malformed frames or unknown opcodes
+        static std::unique_ptr<Command> decodeCommand(const std::string& frame, uint32_t& outRequestId);
+        static bool decodeCommand(std::string_view frame, Command& outCommand, uint32_t& outRequestId);
+        static std::unique_ptr<Response> decodeResponse(const std::string& frame, uint32_t& outRequestId);
+
+    private:
+        static void writeHeader(std::string& out, uint8_t opcode, uint32_t requestId, size_t payloadSize);
+        static bool readHeader(std::string_view frame, uint8_t& outOpcode, uint32_t& outRequestId);
+    };
+}
+
+#endif // BINARY_CODEC_HXX
@@ -2,10 +2,15 @@
 #include "../utils/Constants.hxx"
 #include "../utils/Logger.hxx"
 #include <sstream>
+#include <charconv>
 
 namespace NumberStore {
-    Command::Command(CommandType cmdType, uint64_t num)
-        : Message(MessageType::COMMAND, ""), commandType(cmdType), number(num) {
+    Command::Command(CommandType cmdType, uint64_t num, uint64_t arg)
+        : Message(MessageType::COMMAND, ""), commandType(cmdType), number(num), argument(arg) {
+    }
+
+    Command::Command(CommandType cmdType, std::vector<uint64_t> batchValues)
+        : Message(MessageType::COMMAND, ""), commandType(cmdType), number(0), argument(0), values(std::move(batchValues)) {
     }
 
     CommandType Command::getCommandType() const {
@@ -16,14 +21,36 @@ namespace NumberStore {
         return number;
     }
 
+    uint64_t Command::getArgument() const {
+        return argument;
+    }
+
+    const std::vector<uint64_t>& Command::getValues() const {
+        return values;
+    }
+
+    bool Command::isBatch() const {
+        return isBatchType(commandType);
+    }
+
     std::string Command::serialize() const {
         std::ostringstream oss;
-        oss << "CMD:" << commandTypeToString(commandType);
+        oss << "CMD:" << getTypeName(commandType);
         
-        if (commandType == CommandType::INSERT || commandType == CommandType::DELETE_NUM) {
+        if (hasNumber(commandType)) {
             oss << " " << number;
         }
         
+        if (hasArgument(commandType)) {
+            oss << " " << argument;
+        }
+        
+        if (isBatchType(commandType)) {
+            for (uint64_t value : values) {
+                oss << " " << value;
+            }
+        }
+        
         return oss.str();
     }
 
@@ -34,16 +61,81 @@ namespace NumberStore {
 
         CommandType cmdType = stringToCommandType(commandStr);
         
-        if (cmdType == CommandType::INSERT || cmdType == CommandType::DELETE_NUM) {
-            uint64_t num;
-            if (!(iss >> num)) {
-                Logger::getInstance().error("Missing number for command: " + commandStr);
+        uint64_t num = 0;
+        uint64_t arg = 0;
+        
+        if (hasNumber(cmdType) && !(iss >> num)) {
+            Logger::getInstance().error("Missing number for command: " + commandStr);
+            return nullptr;
+        }
+        
+        if (hasArgument(cmdType) && !(iss >> arg)) {
+            Logger::getInstance().error("Missing second operand for command: " + commandStr);
+            return nullptr;
+        }
+        
+        if (isBatchType(cmdType)) {
+            std::vector<uint64_t> batch;
+            while (iss >> num) {
+                batch.push_back(num);
+            }
+            if (batch.empty() || !iss.eof()) {
+                Logger::getInstance().error("Malformed number list for command: " + commandStr);
                 return nullptr;
             }
-            return std::make_unique<Command>(cmdType, num);
-        } else {
-            return std::make_unique<Command>(cmdType);
+            return std::make_unique<Command>(cmdType, std::move(batch));
         }
+        
+        return std::make_unique<Command>(cmdType, num, arg);
+    }
+
+    bool Command::parse(std::string_view content, Command& outCommand) {
+        size_t wordEnd = content.find(' ');
+        CommandType cmdType;
+        if (!parseCommandType(content.substr(0, wordEnd), cmdType)) {
+            return false;
+        }
+
+        uint64_t operands[2] = {0, 0};
+        size_t operandCount = hasArgument(cmdType) ? 2 : (hasNumber(cmdType) ? 1 : 0);
+        std::string_view rest = wordEnd == std::string_view::npos ? std::string_view() : content.substr(wordEnd);
+
+        for (size_t i = 0; i < operandCount; ++i) {
+            size_t start = rest.find_first_not_of(' ');
+            if (start == std::string_view::npos) {
+                return false;
+            }
+            rest.remove_prefix(start);
+
+            auto parsed = std::from_chars(rest.data(), rest.data() + rest.size(), operands[i]);
+            if (parsed.ec != std::errc()) {
+                return false;
+            }
+            rest.remove_prefix(static_cast<size_t>(parsed.ptr - rest.data()));
+        }
+
+        outCommand.commandType = cmdType;
+        outCommand.number = operands[0];
+        outCommand.argument = operands[1];
+        outCommand.values.clear();
+
+        if (isBatchType(cmdType)) {
+            // Every remaining token is a number; the buffer keeps its capacity between commands
+            for (size_t start = rest.find_first_not_of(' '); start != std::string_view::npos; start = rest.find_first_not_of(' ')) {
+                rest.remove_prefix(start);
+
+                uint64_t value;
+                auto parsed = std::from_chars(rest.data(), rest.data() + rest.size(), value);
+                if (parsed.ec != std::errc()) {
+                    return false;
+                }
+                outCommand.values.push_back(value);
+                rest.remove_prefix(static_cast<size_t>(parsed.ptr - rest.data()));
+            }
+            return !outCommand.values.empty();
+        }
+
+        return true;
     }
 
     std::unique_ptr<Command> Command::createInsertCommand(uint64_t number) {
@@ -66,24 +158,101 @@ namespace NumberStore {
         return std::make_unique<Command>(CommandType::EXIT);
     }
 
+    std::unique_ptr<Command> Command::createRangeCommand(uint64_t low, uint64_t high) {
+        return std::make_unique<Command>(CommandType::RANGE, low, high);
+    }
+
+    std::unique_ptr<Command> Command::createPageCommand(uint64_t cursor, uint64_t limit) {
+        return std::make_unique<Command>(CommandType::PAGE, cursor, limit);
+    }
+
+    std::unique_ptr<Command> Command::createCountCommand(uint64_t low, uint64_t high) {
+        return std::make_unique<Command>(CommandType::COUNT, low, high);
+    }
+
+    std::unique_ptr<Command> Command::createStreamAllCommand() {
+        return std::make_unique<Command>(CommandType::STREAM_ALL);
+    }
+
+    std::unique_ptr<Command> Command::createHelloCommand(uint64_t protocolVersion) {
+        return std::make_unique<Command>(CommandType::HELLO, protocolVersion);
+    }
+
+    std::unique_ptr<Command> Command::createInsertManyCommand(std::vector<uint64_t> numbers) {
+        return std::make_unique<Command>(CommandType::INSERT_MANY, std::move(numbers));
+    }
+
+    std::unique_ptr<Command> Command::createDeleteManyCommand(std::vector<uint64_t> numbers) {
+        return std::make_unique<Command>(CommandType::DELETE_MANY, std::move(numbers));
+    }
+
+    std::unique_ptr<Command> Command::createStatsCommand() {
+        return std::make_unique<Command>(CommandType::STATS);
+    }
+
+    std::unique_ptr<Command> Command::createSaveCommand() {
+        return std::make_unique<Command>(CommandType::SAVE);
+    }
+
+    bool Command::hasNumber(CommandType type) {
+        return type == CommandType::INSERT || type == CommandType::DELETE_NUM || type == CommandType::HELLO ||
+               hasArgument(type);
+    }
+
+    bool Command::hasArgument(CommandType type) {
+        return type == CommandType::RANGE || type == CommandType::PAGE || type == CommandType::COUNT;
+    }
+
+    bool Command::isBatchType(CommandType type) {
+        return type == CommandType::INSERT_MANY || type == CommandType::DELETE_MANY;
+    }
+
+    bool Command::parseCommandType(std::string_view str, CommandType& outType) {
+        if (str == Constants::CMD_INSERT) outType = CommandType::INSERT;
+        else if (str == Constants::CMD_DELETE) outType = CommandType::DELETE_NUM;
+        else if (str == Constants::CMD_PRINT_ALL) outType = CommandType::PRINT_ALL;
+        else if (str == Constants::CMD_DELETE_ALL) outType = CommandType::DELETE_ALL;
+        else if (str == Constants::CMD_EXIT) outType = CommandType::EXIT;
+        else if (str == Constants::CMD_RANGE) outType = CommandType::RANGE;
+        else if (str == Constants::CMD_PAGE) outType = CommandType::PAGE;
+        else if (str == Constants::CMD_COUNT) outType = CommandType::COUNT;
+        else if (str == Constants::CMD_STREAM_ALL) outType = CommandType::STREAM_ALL;
+        else if (str == Constants::CMD_HELLO) outType = CommandType::HELLO;
+        else if (str == Constants::CMD_INSERT_MANY) outType = CommandType::INSERT_MANY;
+        else if (str == Constants::CMD_DELETE_MANY) outType = CommandType::DELETE_MANY;
+        else if (str == Constants::CMD_STATS) outType = CommandType::STATS;
+        else if (str == Constants::CMD_SAVE) outType = CommandType::SAVE;
+        else return false;
+        
+        return true;
+    }
+
     CommandType Command::stringToCommandType(const std::string& str) {
-        if (str == Constants::CMD_INSERT) return CommandType::INSERT;
-        if (str == Constants::CMD_DELETE) return CommandType::DELETE_NUM;
-        if (str == Constants::CMD_PRINT_ALL) return CommandType::PRINT_ALL;
-        if (str == Constants::CMD_DELETE_ALL) return CommandType::DELETE_ALL;
-        if (str == Constants::CMD_EXIT) return CommandType::EXIT;
+        CommandType type;
+        if (parseCommandType(str, type)) {
+            return type;
+        }
         
         Logger::getInstance().error("Unknown command type: " + str);
         return CommandType::EXIT;
     }
 
-    std::string Command::commandTypeToString(CommandType type) {
+    std::string Command::getTypeName(CommandType type) {
         switch (type) {
             case CommandType::INSERT: return Constants::CMD_INSERT;
             case CommandType::DELETE_NUM: return Constants::CMD_DELETE;
             case CommandType::PRINT_ALL: return Constants::CMD_PRINT_ALL;
             case CommandType::DELETE_ALL: return Constants::CMD_DELETE_ALL;
             case CommandType::EXIT: return Constants::CMD_EXIT;
+            case CommandType::RANGE: return Constants::CMD_RANGE;
+            case CommandType::PAGE: return Constants::CMD_PAGE;
+            case CommandType::COUNT: return Constants::CMD_COUNT;
+            case CommandType::STREAM_ALL: return Constants::CMD_STREAM_ALL;
+            case CommandType::HELLO: return Constants::CMD_HELLO;
+            case CommandType::INSERT_MANY: return Constants::CMD_INSERT_MANY;
+            case CommandType::DELETE_MANY: return Constants::CMD_DELETE_MANY;
+            case CommandType::STATS: return Constants::CMD_STATS;
+            case CommandType::SAVE: return Constants::CMD_SAVE;
             default: return Constants::CMD_EXIT;
         }
     }
@@ -2,6 +2,8 @@
 #define COMMAND_HXX
 
 #include "Message.hxx"
+#include <string_view>
+#include <vector>
 #include "../utils/ErrorCodes.hxx"
 
 namespace NumberStore {
@@ -10,32 +12,65 @@ namespace NumberStore {
         DELETE_NUM,
         PRINT_ALL,
         DELETE_ALL,
-        EXIT
+        EXIT,
+        RANGE,
+        PAGE,
+        COUNT,
+        STREAM_ALL, // Like PRINT_ALL, answered with CHUNK frames and a final DATA frame
+        HELLO,      // Protocol negotiation; number is the highest binary protocol version the client speaks
+        INSERT_MANY,
+        DELETE_MANY,
+        STATS,      // Latency percentiles and counters from DaemonStats, as a DATA response
+        SAVE        // Starts a background checkpoint now; progress shows in STATS
     };
 
     class Command : public Message {
     private:
         CommandType commandType;
-        uint64_t number; // Used for INSERT and DELETE commands
+        uint64_t number;   // Used for INSERT and DELETE commands; lower bound or cursor for RANGE, PAGE and COUNT
+        uint64_t argument; // Upper bound for RANGE and COUNT, page size for PAGE
+        std::vector<uint64_t> values; // Operands of INSERT_MANY and DELETE_MANY
 
     public:
-        Command(CommandType cmdType, uint64_t num = 0);
+        Command(CommandType cmdType, uint64_t num = 0, uint64_t arg = 0);
+        Command(CommandType cmdType, std::vector<uint64_t> batchValues);
         
         CommandType getCommandType() const;
         uint64_t getNumber() const;
+        uint64_t getArgument() const;
+        const std::vector<uint64_t>& getValues() const;
+        bool isBatch() const;
         
         std::string serialize() const override;
         static std::unique_ptr<Command> deserialize(const std::string& content);
+        // Allocation-free parse of "TYPE [number [argument]]" into an existing command;
+        // batch commands reuse the command's value buffer
+        static bool parse(std::string_view content, Command& outCommand);
         
         static std::unique_ptr<Command> createInsertCommand(uint64_t number);
         static std::unique_ptr<Command> createDeleteCommand(uint64_t number);
         static std::unique_ptr<Command> createPrintAllCommand();
         static std::unique_ptr<Command> createDeleteAllCommand();
         static std::unique_ptr<Command> createExitCommand();
+        static std::unique_ptr<Command> createRangeCommand(uint64_t low, uint64_t high);
+        static std::unique_ptr<Command> createPageCommand(uint64_t cursor, uint64_t limit);
+        static std::unique_ptr<Command> createCountCommand(uint64_t low, uint64_t high);
+        static std::unique_ptr<Command> createStreamAllCommand();
+        static std::unique_ptr<Command> createHelloCommand(uint64_t protocolVersion);
+        static std::unique_ptr<Command> createInsertManyCommand(std::vector<uint64_t> numbers);
+        static std::unique_ptr<Command> createDeleteManyCommand(std::vector<uint64_t> numbers);
+        static std::unique_ptr<Command> createStatsCommand();
+        static std::unique_ptr<Command> createSaveCommand();
+        
+        // Protocol keyword of a command type, e.g. "INSERT"
+        static std::string getTypeName(CommandType type);
         
     private:
+        static bool hasNumber(CommandType type);
+        static bool hasArgument(CommandType type);
+        static bool isBatchType(CommandType type);
+        static bool parseCommandType(std::string_view str, CommandType& outType);
         static CommandType stringToCommandType(const std::string& str);
-        static std::string commandTypeToString(CommandType type);
     };
 }
 
@@ -1,8 +1,10 @@
 #include "MessageSerializer.hxx"
 #include "../utils/Logger.hxx"
+#include <charconv>
 
 namespace NumberStore {
     const std::string MESSAGE_TERMINATOR = "\n";
+    const char REQUEST_TAG = '#';
 
     std::string MessageSerializer::serialize(const Message& message) {
         return addMessageTerminator(message.serialize());
@@ -46,6 +48,80 @@ namespace NumberStore {
         return std::unique_ptr<Response>(static_cast<Response*>(message.release()));
     }
 
+    std::string MessageSerializer::serializeCommand(const Command& command, uint32_t requestId) {
+        std::string message = command.serialize();
+        if (requestId != 0) {
+            message.insert(message.find(':'), REQUEST_TAG + std::to_string(requestId));
+        }
+        return addMessageTerminator(message);
+    }
+
+    std::unique_ptr<Response> MessageSerializer::deserializeResponse(const std::string& data, uint32_t& outRequestId) {
+        std::string_view content(data);
+        if (!consumePrefix(content, "RESP", outRequestId)) {
+            Logger::getInstance().error("Invalid response format");
+            return nullptr;
+        }
+
+        if (outRequestId == 0) {
+            return deserializeResponse(data);
+        }
+        return deserializeResponse("RESP:" + std::string(content));
+    }
+
+    bool MessageSerializer::parseCommand(std::string_view data, Command& outCommand) {
+        uint32_t requestId = 0;
+        return parseCommand(data, outCommand, requestId);
+    }
+
+    bool MessageSerializer::parseCommand(std::string_view data, Command& outCommand, uint32_t& outRequestId) {
+        if (data.empty() || data.back() != '\n' || !consumePrefix(data, "CMD", outRequestId)) {
+            return false;
+        }
+
+        data.remove_suffix(MESSAGE_TERMINATOR.size());
+        return Command::parse(data, outCommand);
+    }
+
+    void MessageSerializer::serializeResponseInto(const Response& response, std::string& out) {
+        serializeResponseInto(response, 0, out);
+    }
+
+    void MessageSerializer::serializeResponseInto(const Response& response, uint32_t requestId, std::string& out) {
+        response.serializeInto(out);
+        if (requestId != 0) {
+            // Tag goes between "RESP" and the colon
+            char digits[12];
+            digits[0] = REQUEST_TAG;
+            auto converted = std::to_chars(digits + 1, digits + sizeof(digits), requestId);
+            out.insert(4, digits, static_cast<size_t>(converted.ptr - digits));
+        }
+        out += MESSAGE_TERMINATOR;
+    }
+
+    bool MessageSerializer::consumePrefix(std::string_view& data, std::string_view type, uint32_t& outRequestId) {
+        outRequestId = 0;
+        if (data.compare(0, type.size(), type) != 0) {
+            return false;
+        }
+        data.remove_prefix(type.size());
+
+        if (!data.empty() && data.front() == REQUEST_TAG) {
+            data.remove_prefix(1);
+            auto parsed = std::from_chars(data.data(), data.data() + data.size(), outRequestId);
+            if (parsed.ec != std::errc()) {
+                return false;
+            }
+            data.remove_prefix(static_cast<size_t>(parsed.ptr - data.data()));
+        }
+
+        if (data.empty() || data.front() != ':') {
+            return false;
+        }
+        data.remove_prefix(1);
+        return true;
+    }
+
     bool MessageSerializer::isValidMessageFormat(const std::string& data) {
         if (data.empty()) {
             return false;
@@ -6,6 +6,7 @@
 #include "Response.hxx"
 #include "../utils/ErrorCodes.hxx"
 #include <memory>
+#include <string_view>
 
 namespace NumberStore {
     class MessageSerializer {
@@ -20,12 +21,26 @@ namespace NumberStore {
         static std::unique_ptr<Command> deserializeCommand(const std::string& data);
         static std::unique_ptr<Response> deserializeResponse(const std::string& data);
         
+        // Tagged messages ("CMD#17:..." / "RESP#17:...") let a client pipeline requests and
+        // match each reply to its request; untagged messages carry request id 0
+        static std::string serializeCommand(const Command& command, uint32_t requestId);
+        static std::unique_ptr<Response> deserializeResponse(const std::string& data, uint32_t& outRequestId);
+        
+        // Allocation-free variants for the daemon's request loop: parse a command into a
+        // caller-owned object and serialize a response into a reused buffer
+        static bool parseCommand(std::string_view data, Command& outCommand);
+        static bool parseCommand(std::string_view data, Command& outCommand, uint32_t& outRequestId);
+        static void serializeResponseInto(const Response& response, std::string& out);
+        static void serializeResponseInto(const Response& response, uint32_t requestId, std::string& out);
+        
         // Validation
         static bool isValidMessageFormat(const std::string& data);
         
     private:
         static std::string addMessageTerminator(const std::string& message);
         static std::string removeMessageTerminator(const std::string& message);
+        // Consumes "<type>[#id]:" from the front of data
+        static bool consumePrefix(std::string_view& data, std::string_view type, uint32_t& outRequestId);
     };
 }
 
@@ -2,6 +2,7 @@
 #include "../utils/Constants.hxx"
 #include "../utils/Logger.hxx"
 #include <sstream>
+#include <charconv>
 
 namespace NumberStore {
     Response::Response(ResponseType respType, ErrorCode code, const std::string& responseData)
@@ -21,26 +22,54 @@ namespace NumberStore {
     }
 
     bool Response::isSuccess() const {
-        return responseType == ResponseType::SUCCESS || responseType == ResponseType::DATA;
+        return responseType == ResponseType::SUCCESS || responseType == ResponseType::DATA ||
+               responseType == ResponseType::CHUNK;
+    }
+
+    void Response::assign(ResponseType respType, ErrorCode code) {
+        responseType = respType;
+        errorCode = code;
+        data.clear();
+        
+        if (respType == ResponseType::ERROR_RESPONSE) {
+            data += ErrorHandler::getErrorText(code);
+        }
+    }
+
+    std::string& Response::getDataBuffer() {
+        return data;
     }
 
     std::string Response::serialize() const {
-        std::ostringstream oss;
-        oss << "RESP:" << responseTypeToString(responseType);
+        std::string out;
+        serializeInto(out);
+        return out;
+    }
+
+    void Response::serializeInto(std::string& out) const {
+        out.assign("RESP:");
+        switch (responseType) {
+            case ResponseType::SUCCESS: out += Constants::RESP_SUCCESS; break;
+            case ResponseType::DATA: out += Constants::RESP_DATA; break;
+            case ResponseType::CHUNK: out += Constants::RESP_CHUNK; break;
+            default: out += Constants::RESP_ERROR; break;
+        }
         
         if (responseType == ResponseType::ERROR_RESPONSE) {
-            oss << " " << static_cast<int>(errorCode);
+            char digits[16];
+            auto converted = std::to_chars(digits, digits + sizeof(digits), static_cast<int>(errorCode));
+            out += ' ';
+            out.append(digits, converted.ptr);
         }
         
         if (!data.empty()) {
-            if (responseType == ResponseType::DATA) {
-                oss << "\n" << data;  // Put data on new line for DATA responses
+            if (responseType == ResponseType::DATA || responseType == ResponseType::CHUNK) {
+                out += '\n';  // Put data on new line for DATA and CHUNK responses
             } else {
-                oss << " " << data;   // Space separator for other responses
+                out += ' ';   // Space separator for other responses
             }
+            out += data;
         }
-        
-        return oss.str();
     }
 
     std::unique_ptr<Response> Response::deserialize(const std::string& content) {
@@ -66,8 +95,8 @@ namespace NumberStore {
             return std::make_unique<Response>(respType, static_cast<ErrorCode>(errorCodeInt), remainingData);
         } else {
             std::string remainingData;
-            if (respType == ResponseType::DATA) {
-                // For DATA responses, read everything after the first line
+            if (respType == ResponseType::DATA || respType == ResponseType::CHUNK) {
+                // For DATA and CHUNK responses, read everything after the first line
                 std::string line;
                 while (std::getline(iss, line)) {
                     if (!remainingData.empty()) {
@@ -100,10 +129,15 @@ namespace NumberStore {
         return std::make_unique<Response>(ResponseType::DATA, ErrorCode::SUCCESS, data);
     }
 
+    std::unique_ptr<Response> Response::createChunkResponse(const std::string& data) {
+        return std::make_unique<Response>(ResponseType::CHUNK, ErrorCode::SUCCESS, data);
+    }
+
     ResponseType Response::stringToResponseType(const std::string& str) {
         if (str == Constants::RESP_SUCCESS) return ResponseType::SUCCESS;
         if (str == Constants::RESP_ERROR) return ResponseType::ERROR_RESPONSE;
         if (str == Constants::RESP_DATA) return ResponseType::DATA;
+        if (str == Constants::RESP_CHUNK) return ResponseType::CHUNK;
         
         Logger::getInstance().error("Unknown response type: " + str);
         return ResponseType::ERROR_RESPONSE; // Default fallback
@@ -114,6 +148,7 @@ namespace NumberStore {
             case ResponseType::SUCCESS: return Constants::RESP_SUCCESS;
             case ResponseType::ERROR_RESPONSE: return Constants::RESP_ERROR;
             case ResponseType::DATA: return Constants::RESP_DATA;
+            case ResponseType::CHUNK: return Constants::RESP_CHUNK;
             default: return Constants::RESP_ERROR;
         }
     }
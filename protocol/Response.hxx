@@ -8,7 +8,8 @@ namespace NumberStore {
     enum class ResponseType {
         SUCCESS,
         ERROR_RESPONSE,
-        DATA
+        DATA,
+        CHUNK   // One frame of a streamed result; more frames follow, the last one is DATA
     };
 
     class Response : public Message {
@@ -25,13 +26,22 @@ namespace NumberStore {
         const std::string& getData() const;
         bool isSuccess() const;
         
+        // Reuse one response across requests: assign() clears the data but keeps its
+        // capacity, and getDataBuffer() lets the payload be written in place. Error
+        // responses get the standard message for their code, as createErrorResponse() does
+        void assign(ResponseType respType, ErrorCode code);
+        std::string& getDataBuffer();
+        
         std::string serialize() const override;
+        // Same as serialize(), written into a caller-owned buffer
+        void serializeInto(std::string& out) const;
         static std::unique_ptr<Response> deserialize(const std::string& content);
         
         // Factory methods for creating specific responses
         static std::unique_ptr<Response> createSuccessResponse(const std::string& message = "");
         static std::unique_ptr<Response> createErrorResponse(ErrorCode code, const std::string& message = "");
         static std::unique_ptr<Response> createDataResponse(const std::string& data);
+        static std::unique_ptr<Response> createChunkResponse(const std::string& data);
         
     private:
         static ResponseType stringToResponseType(const std::string& str);
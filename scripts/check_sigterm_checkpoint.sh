@@ -0,0 +1,49 @@
+#!/bin/sh
+# Starts the daemon in a scratch directory, inserts a number through the CLI, stops
+# the daemon with SIGTERM and checks that it shut down cleanly and wrote a checkpoint.
+# Linux only; no other daemon may be running. Usage: check_sigterm_checkpoint.sh [build dir]
+set -u
+
+BIN="$(cd "${1:-build}" && pwd)/bin"
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+"$BIN/numberstore-daemon" > daemon.log 2>&1 &
+DAEMON=$!
+
+# Wait for the socket rather than guessing how long recovery takes
+for _ in $(seq 50); do
+    [ -S /tmp/numberstore.sock ] && break
+    sleep 0.1
+done
+
+printf '1\n42\n8\n' | "$BIN/numberstore-cli" > cli.log 2>&1
+if ! grep -q "Number 42 inserted" cli.log; then
+    echo "FAIL: insert through the CLI did not succeed"
+    cat cli.log
+    kill -KILL "$DAEMON" 2>/dev/null
+    exit 1
+fi
+
+kill -TERM "$DAEMON"
+wait "$DAEMON"
+STATUS=$?
+
+if [ "$STATUS" -ne 0 ]; then
+    echo "FAIL: daemon exited with status $STATUS after SIGTERM"
+    tail -n 20 daemon.log
+    exit 1
+fi
+if ! grep -q "Daemon server stopped" daemon.log; then
+    echo "FAIL: daemon did not run its shutdown"
+    tail -n 20 daemon.log
+    exit 1
+fi
+if [ ! -s numberstore.ckpt ]; then
+    echo "FAIL: no checkpoint written on SIGTERM"
+    ls -l
+    exit 1
+fi
+
+echo "OK: SIGTERM stopped the daemon and wrote numberstore.ckpt"
@@ -0,0 +1,110 @@
+#include "BackgroundSaver.hxx"
+#include "../utils/Logger.hxx"
+#include "../utils/TimeUtils.hxx"
+
+namespace NumberStore {
+    namespace {
+        // How often the saver thread re-checks the triggers
+        const std::chrono::seconds POLL_INTERVAL(1);
+    }
+
+    BackgroundSaver::BackgroundSaver(NumberStore& store, uint64_t writesPerSave, std::chrono::seconds saveInterval)
+        : numberStore(store), writeThreshold(writesPerSave), interval(saveInterval),
+          status{false, ErrorCode::SUCCESS, 0, 0, 0, CheckpointStats{0, 0, 0, 0, 0}},
+          saveRequested(false), stopping(false) {
+    }
+
+    BackgroundSaver::~BackgroundSaver() {
+        stop();
+    }
+
+    void BackgroundSaver::start() {
+        if (saverThread.joinable()) {
+            return;
+        }
+
+        stopping = false;
+        saverThread = std::thread(&BackgroundSaver::saverLoop, this);
+        Logger::getInstance().info("Background saver started (every " + std::to_string(writeThreshold) +
+                                   " writes or " + std::to_string(interval.count()) + " seconds)");
+    }
+
+    void BackgroundSaver::stop() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+
+        if (saverThread.joinable()) {
+            saverThread.join();
+            Logger::getInstance().info("Background saver stopped");
+        }
+    }
+
+    void BackgroundSaver::requestSave() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            saveRequested = true;
+        }
+        wakeUp.notify_all();
+    }
+
+    BackgroundSaver::Status BackgroundSaver::getStatus() const {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        return status;
+    }
+
+    void BackgroundSaver::saverLoop() {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        uint64_t savedVersion = numberStore.getDataVersion();
+        auto lastSave = std::chrono::steady_clock::now();
+
+        while (true) {
+            wakeUp.wait_for(lock, POLL_INTERVAL, [this] { return stopping || saveRequested; });
+            if (stopping) {
+                break;
+            }
+
+            uint64_t version = numberStore.getDataVersion();
+            uint64_t writes = version - savedVersion;
+            auto now = std::chrono::steady_clock::now();
+
+            bool due = saveRequested
+                    || (writeThreshold > 0 && writes >= writeThreshold)
+                    || (interval.count() > 0 && writes > 0 && now - lastSave >= interval);
+            if (!due) {
+                continue;
+            }
+
+            saveRequested = false;
+            status.inProgress = true;
+            lock.unlock();
+
+            CheckpointStats stats;
+            ErrorCode result = numberStore.checkpoint(stats);
+
+            lock.lock();
+            status.inProgress = false;
+            status.lastResult = result;
+            status.lastStats = stats;
+
+            // A failed save is retried on the next trigger; until then the log still holds everything
+            savedVersion = version;
+            lastSave = std::chrono::steady_clock::now();
+
+            if (result == ErrorCode::SUCCESS) {
+                ++status.completedSaves;
+                status.lastSaveTime = TimeUtils::getCurrentUnixTimestamp();
+                Logger::getInstance().info("Background save completed: " + std::to_string(stats.entryCount) +
+                                           " numbers, snapshot " + std::to_string(stats.captureMicros) +
+                                           " us, write " + std::to_string(stats.writeMillis) +
+                                           " ms, copied node bytes " + std::to_string(stats.copiedNodeBytes));
+            } else {
+                ++status.failedSaves;
+                Logger::getInstance().error("Background save failed after " + std::to_string(writes) +
+                                            " writes; changes remain in the write-ahead log");
+            }
+        }
+    }
+}
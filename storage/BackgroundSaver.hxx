@@ -0,0 +1,62 @@
+#ifndef BACKGROUND_SAVER_HXX
+#define BACKGROUND_SAVER_HXX
+
+#include "NumberStore.hxx"
+#include "../utils/ErrorCodes.hxx"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+namespace NumberStore {
+    // Writes checkpoints from a background thread once enough writes have
+    // accumulated or enough time has passed since the last one. Each save works
+    // from an O(1) snapshot of the store, so writers are never blocked for the
+    // duration of the file write; they only copy the tree nodes they modify.
+    class BackgroundSaver {
+    public:
+        struct Status {
+            bool inProgress;
+            ErrorCode lastResult;
+            int64_t lastSaveTime;     // Unix timestamp of the last successful save, 0 if none
+            uint64_t completedSaves;
+            uint64_t failedSaves;
+            CheckpointStats lastStats;
+        };
+
+    private:
+        NumberStore& numberStore;
+        uint64_t writeThreshold;         // 0 disables the write trigger
+        std::chrono::seconds interval;   // 0 disables the time trigger
+
+        mutable std::mutex stateMutex;
+        std::condition_variable wakeUp;
+        Status status;
+        bool saveRequested;
+        bool stopping;
+        std::thread saverThread;
+
+    public:
+        BackgroundSaver(NumberStore& store, uint64_t writesPerSave, std::chrono::seconds saveInterval);
+        ~BackgroundSaver();
+
+        BackgroundSaver(const BackgroundSaver&) = delete;
+        BackgroundSaver& operator=(const BackgroundSaver&) = delete;
+        BackgroundSaver(BackgroundSaver&&) = delete;
+        BackgroundSaver& operator=(BackgroundSaver&&) = delete;
+
+        void start();
+        // Waits for a save in progress to finish
+        void stop();
+
+        // Starts a save as soon as the saver thread wakes, regardless of the triggers
+        void requestSave();
+        Status getStatus() const;
+
+    private:
+        void saverLoop();
+    };
+}
+
+#endif // BACKGROUND_SAVER_HXX
@@ -0,0 +1,220 @@
+#include "BloomFilter.hxx"
+#include <algorithm>
+#include <cmath>
+
+namespace NumberStore {
+    namespace {
+        const size_t COUNTERS_PER_BLOCK = 128;
+        const size_t COUNTERS_PER_WORD = 16;
+        const uint64_t COUNTER_MAX = 15;
+        const unsigned PROBES = 4;
+        const unsigned PROBE_BITS = 7;          // Picks one of the block's 128 counters
+
+        // Ten counters per entry at full load gives about 1% false positives with four
+        // probes. Rebuilt tables get a quarter more room than they start with, and block
+        // counts are not rounded, so a table costs about 6 bytes per entry.
+        const size_t COUNTERS_PER_ENTRY = 10;
+        const size_t HEADROOM_DIVISOR = 4;
+        const size_t MIN_BLOCKS = 16;
+
+        // Blocks read to estimate the false positive rate, spread over the table
+        const size_t SAMPLED_BLOCKS = 4096;
+    }
+
+    BloomFilter::Table::Table(size_t entries) : blockCount(0), capacity(0) {
+        entries += entries / HEADROOM_DIVISOR;
+        blockCount = std::max((entries * COUNTERS_PER_ENTRY + COUNTERS_PER_BLOCK - 1) / COUNTERS_PER_BLOCK, MIN_BLOCKS);
+        capacity = blockCount * COUNTERS_PER_BLOCK / COUNTERS_PER_ENTRY;
+
+        blocks.reset(new Block[blockCount]);
+        for (size_t i = 0; i < blockCount; ++i) {
+            for (auto& word : blocks[i].words) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    BloomFilter::BloomFilter(EpochManager& epochManager)
+        : epochs(epochManager), table(new Table(0)), entryCount(0), rebuildQueued(false), rebuilding(false),
+          stagedEntries(0), definiteMisses(0), falsePositives(0), rebuilds(0) {
+    }
+
+    BloomFilter::~BloomFilter() {
+        delete table.load(std::memory_order_relaxed);
+    }
+
+    bool BloomFilter::mayContain(uint64_t number, bool& outFiltered) const {
+        const Table* current = table.load(std::memory_order_seq_cst);
+        outFiltered = current != nullptr;
+        if (!current) {
+            return true;
+        }
+
+        uint64_t bits = hash(number);
+        const Block& block = current->blocks[blockFor(bits, current->blockCount)];
+        for (unsigned probe = 0; probe < PROBES; ++probe, bits >>= PROBE_BITS) {
+            size_t counter = bits & (COUNTERS_PER_BLOCK - 1);
+            uint64_t word = block.words[counter / COUNTERS_PER_WORD].load(std::memory_order_acquire);
+            if (((word >> ((counter % COUNTERS_PER_WORD) * 4)) & COUNTER_MAX) == 0) {
+                definiteMisses.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void BloomFilter::recordFalsePositive() {
+        falsePositives.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void BloomFilter::insert(uint64_t number) {
+        if (Table* current = table.load(std::memory_order_relaxed)) {
+            adjust(*current, number, true);
+        }
+        ++entryCount;
+        if (rebuilding) {
+            pending.push_back(PendingChange{number, true});
+        }
+    }
+
+    void BloomFilter::erase(uint64_t number) {
+        if (Table* current = table.load(std::memory_order_relaxed)) {
+            adjust(*current, number, false);
+        }
+        --entryCount;
+        if (rebuilding) {
+            pending.push_back(PendingChange{number, false});
+        }
+    }
+
+    void BloomFilter::invalidate() {
+        rebuilding = false;
+        pending.clear();
+        publish(nullptr);
+    }
+
+    bool BloomFilter::isOverloaded() const {
+        const Table* current = table.load(std::memory_order_relaxed);
+        return !rebuilding && current && entryCount > current->capacity;
+    }
+
+    bool BloomFilter::markRebuildQueued() {
+        if (rebuildQueued) {
+            return false;
+        }
+        rebuildQueued = true;
+        return true;
+    }
+
+    void BloomFilter::beginRebuild() {
+        rebuildQueued = false;
+        rebuilding = true;
+        pending.clear();
+    }
+
+    void BloomFilter::buildFrom(const PersistentTree& numbers) {
+        staged.reset(new Table(numbers.size()));
+        stagedEntries = numbers.size();
+        for (auto it = numbers.begin(); it.isValid(); ++it) {
+            adjust(*staged, it.getNumber(), true);
+        }
+    }
+
+    void BloomFilter::finishRebuild() {
+        if (!rebuilding) {
+            staged.reset();
+            return;
+        }
+
+        // Entries cleared since the snapshot are still counted, which is safe; the next
+        // rebuild drops them
+        entryCount = stagedEntries;
+        for (const PendingChange& change : pending) {
+            adjust(*staged, change.number, change.inserted);
+            if (change.inserted) {
+                ++entryCount;
+            } else {
+                --entryCount;
+            }
+        }
+
+        rebuilding = false;
+        pending.clear();
+        pending.shrink_to_fit();
+        rebuilds.fetch_add(1, std::memory_order_relaxed);
+        publish(staged.release());
+    }
+
+    BloomFilter::Stats BloomFilter::getStats() const {
+        Stats stats{definiteMisses.load(std::memory_order_relaxed), falsePositives.load(std::memory_order_relaxed),
+                    rebuilds.load(std::memory_order_relaxed), 0, 1.0};
+
+        EpochManager::Guard guard(epochs);
+        const Table* current = guard.isPinned() ? table.load(std::memory_order_seq_cst) : nullptr;
+        if (!current) {
+            return stats;
+        }
+
+        // An absent number passes when all four of its counters are non-zero
+        size_t blockCount = current->blockCount;
+        size_t step = std::max<size_t>(blockCount / SAMPLED_BLOCKS, 1);
+        size_t examined = 0;
+        size_t occupied = 0;
+        for (size_t i = 0; i < blockCount; i += step) {
+            for (const auto& word : current->blocks[i].words) {
+                uint64_t value = word.load(std::memory_order_relaxed);
+                for (size_t counter = 0; counter < COUNTERS_PER_WORD; ++counter, value >>= 4) {
+                    occupied += (value & COUNTER_MAX) != 0;
+                }
+            }
+            examined += COUNTERS_PER_BLOCK;
+        }
+
+        stats.bytes = blockCount * sizeof(Block);
+        stats.expectedFalsePositiveRate = std::pow(static_cast<double>(occupied) / static_cast<double>(examined), PROBES);
+        return stats;
+    }
+
+    uint64_t BloomFilter::hash(uint64_t number) {
+        // Mixed differently from the shard choice, whose low bits are fixed within a shard
+        uint64_t bits = number * 0x9E3779B97F4A7C15ULL;
+        bits ^= bits >> 32;
+        bits *= 0xD6E8FEB86659FD93ULL;
+        bits ^= bits >> 32;
+        return bits;
+    }
+
+    size_t BloomFilter::blockFor(uint64_t bits, size_t blockCount) {
+        // The high half scaled onto the block count; the probes use the low bits
+        return static_cast<size_t>(((bits >> 32) * static_cast<uint64_t>(blockCount)) >> 32);
+    }
+
+    void BloomFilter::adjust(Table& target, uint64_t number, bool increment) {
+        uint64_t bits = hash(number);
+        Block& block = target.blocks[blockFor(bits, target.blockCount)];
+        for (unsigned probe = 0; probe < PROBES; ++probe, bits >>= PROBE_BITS) {
+            size_t counter = bits & (COUNTERS_PER_BLOCK - 1);
+            unsigned shift = static_cast<unsigned>(counter % COUNTERS_PER_WORD) * 4;
+            std::atomic<uint64_t>& word = block.words[counter / COUNTERS_PER_WORD];
+
+            // A table has one writer at a time (the shard lock holder, or the rebuilding
+            // thread before publishing), so a plain load and store suffice.
+            // A saturated counter may stand for more numbers than it can count, so it stays put.
+            uint64_t value = word.load(std::memory_order_relaxed);
+            uint64_t count = (value >> shift) & COUNTER_MAX;
+            if (count == COUNTER_MAX || (!increment && count == 0)) {
+                continue;
+            }
+            word.store(increment ? value + (uint64_t(1) << shift) : value - (uint64_t(1) << shift),
+                       std::memory_order_release);
+        }
+    }
+
+    void BloomFilter::publish(Table* replacement) {
+        // Sequentially consistent so a reader that pins after retire() sees the new table
+        Table* previous = table.exchange(replacement, std::memory_order_seq_cst);
+        if (previous) {
+            epochs.retire([previous] { delete previous; });
+        }
+    }
+}
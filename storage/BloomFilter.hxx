@@ -0,0 +1,110 @@
+#ifndef BLOOM_FILTER_HXX
+#define BLOOM_FILTER_HXX
+
+#include "EpochManager.hxx"
+#include "PersistentTree.hxx"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace NumberStore {
+    // Counting blocked Bloom filter over the numbers in one shard, checked before the
+    // shard lock so that lookups of absent numbers are answered without taking it.
+    // Each number maps to one 64-byte block and bumps four 4-bit counters inside it, so
+    // a check reads a single cache line. Counters stop at 15 and are never decremented
+    // from there, which can only add false positives.
+    //
+    // Writers hold the shard lock. mayContain() takes no lock but must run inside a
+    // pinned EpochManager Guard: resizing and rebuilding publish a new table and retire
+    // the old one. While no table is published every number may be present.
+    class BloomFilter {
+    public:
+        struct Stats {
+            uint64_t definiteMisses;           // Checks answered "absent" by the filter
+            uint64_t falsePositives;           // Checks it passed for numbers that were absent
+            uint64_t rebuilds;
+            size_t bytes;
+            double expectedFalsePositiveRate;  // From the share of non-zero counters
+        };
+
+    private:
+        static const size_t WORDS_PER_BLOCK = 8;
+
+        struct alignas(64) Block {
+            std::atomic<uint64_t> words[WORDS_PER_BLOCK];
+        };
+
+        struct Table {
+            size_t blockCount;
+            size_t capacity;    // Entries the table was sized for
+            std::unique_ptr<Block[]> blocks;
+
+            explicit Table(size_t entries);
+        };
+
+        // A change made while a rebuild was reading its snapshot
+        struct PendingChange {
+            uint64_t number;
+            bool inserted;
+        };
+
+        EpochManager& epochs;
+        std::atomic<Table*> table;
+        // Only writers (under the shard lock) and the rebuilding thread touch these
+        size_t entryCount;
+        bool rebuildQueued;
+        bool rebuilding;
+        std::vector<PendingChange> pending;
+        std::unique_ptr<Table> staged;
+        size_t stagedEntries;
+
+        mutable std::atomic<uint64_t> definiteMisses;
+        std::atomic<uint64_t> falsePositives;
+        std::atomic<uint64_t> rebuilds;
+
+    public:
+        explicit BloomFilter(EpochManager& epochManager);
+        ~BloomFilter();
+
+        BloomFilter(const BloomFilter&) = delete;
+        BloomFilter& operator=(const BloomFilter&) = delete;
+
+        // False only if the number is certainly not in the shard. outFiltered is set when a
+        // table gave the answer; with none published every number passes unchecked.
+        bool mayContain(uint64_t number, bool& outFiltered) const;
+        // A lookup a table passed found nothing
+        void recordFalsePositive();
+
+        // Writers hold the shard lock. insert() is only called for absent numbers and
+        // erase() for present ones, as the tree reports them.
+        void insert(uint64_t number);
+        void erase(uint64_t number);
+        // Withdraws the table after the shard was filled without the filter seeing it;
+        // checks pass until the next rebuild completes
+        void invalidate();
+        // The table holds more entries than it was sized for
+        bool isOverloaded() const;
+        // Returns false if a rebuild is already queued
+        bool markRebuildQueued();
+
+        // A rebuild reads a snapshot of the shard without its lock. beginRebuild() and
+        // finishRebuild() are called under the shard lock; changes made in between are
+        // kept and replayed into the new table before it is published. An invalidate()
+        // in between discards the rebuild.
+        void beginRebuild();
+        void buildFrom(const PersistentTree& numbers);
+        void finishRebuild();
+
+        Stats getStats() const;
+
+    private:
+        static uint64_t hash(uint64_t number);
+        static size_t blockFor(uint64_t bits, size_t blockCount);
+        static void adjust(Table& target, uint64_t number, bool increment);
+        void publish(Table* replacement);
+    };
+}
+
+#endif // BLOOM_FILTER_HXX
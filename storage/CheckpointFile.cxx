@@ -0,0 +1,315 @@
+#include "CheckpointFile.hxx"
+#include "StoreSnapshot.hxx"
+#include "../utils/ByteOrder.hxx"
+#include "../utils/Checksum.hxx"
+#include "../utils/Logger.hxx"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace NumberStore {
+    namespace {
+        const char CHECKPOINT_MAGIC[8] = {'N', 'S', 'C', 'K', 'P', 'T', '\0', '\0'};
+        const size_t WRITE_CHUNK_ENTRIES = 8192;
+
+        // Header field offsets
+        const size_t OFFSET_VERSION = 8;
+        const size_t OFFSET_COUNT = 16;
+        const size_t OFFSET_WAL_SEQUENCE = 24;
+        const size_t OFFSET_NUMBERS_CRC = 32;
+        const size_t OFFSET_TIMESTAMPS_CRC = 36;
+        const size_t OFFSET_HEADER_CRC = 60;
+
+        bool syncFile(std::FILE* file) {
+            if (std::fflush(file) != 0) {
+                return false;
+            }
+#ifdef _WIN32
+            return _commit(_fileno(file)) == 0;
+#else
+            return fsync(fileno(file)) == 0;
+#endif
+        }
+    }
+
+    CheckpointFile::CheckpointFile()
+        : mappedData(nullptr), mappedSize(0), entryCount(0), walSequence(0),
+          numbersChecksum(0), timestampsChecksum(0),
+#ifdef _WIN32
+          fileHandle(nullptr), mappingHandle(nullptr) {
+#else
+          fileDescriptor(-1) {
+#endif
+    }
+
+    CheckpointFile::~CheckpointFile() {
+        close();
+    }
+
+    ErrorCode CheckpointFile::write(const std::string& path, const StoreSnapshot& snapshot) {
+        std::string tempPath = path + ".tmp";
+        std::FILE* out = std::fopen(tempPath.c_str(), "wb");
+        if (!out) {
+            Logger::getInstance().error("Failed to create checkpoint file: " + tempPath);
+            return ErrorCode::PERSISTENCE_FAILED;
+        }
+
+        char header[HEADER_SIZE] = {};
+        bool ok = std::fwrite(header, 1, HEADER_SIZE, out) == HEADER_SIZE;
+
+        // Two passes over the immutable snapshot write the two columns back to back
+        std::vector<char> chunk(WRITE_CHUNK_ENTRIES * 8);
+        uint32_t columnChecksums[2] = {0, 0};
+        uint64_t count = 0;
+
+        for (int column = 0; column < 2 && ok; ++column) {
+            size_t used = 0;
+            count = 0;
+
+            for (auto it = snapshot.begin(); it.isValid() && ok; ++it) {
+                uint64_t value = column == 0 ? it.getNumber() : static_cast<uint64_t>(it.getTimestamp());
+                ByteOrder::putUint64(chunk.data() + used, value);
+                used += 8;
+                ++count;
+
+                if (used == chunk.size()) {
+                    columnChecksums[column] = Checksum::crc32(chunk.data(), used, columnChecksums[column]);
+                    ok = std::fwrite(chunk.data(), 1, used, out) == used;
+                    used = 0;
+                }
+            }
+
+            if (ok && used > 0) {
+                columnChecksums[column] = Checksum::crc32(chunk.data(), used, columnChecksums[column]);
+                ok = std::fwrite(chunk.data(), 1, used, out) == used;
+            }
+        }
+
+        std::memcpy(header, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        ByteOrder::putUint32(header + OFFSET_VERSION, FORMAT_VERSION);
+        ByteOrder::putUint64(header + OFFSET_COUNT, count);
+        ByteOrder::putUint64(header + OFFSET_WAL_SEQUENCE, snapshot.getWalSequence());
+        ByteOrder::putUint32(header + OFFSET_NUMBERS_CRC, columnChecksums[0]);
+        ByteOrder::putUint32(header + OFFSET_TIMESTAMPS_CRC, columnChecksums[1]);
+        ByteOrder::putUint32(header + OFFSET_HEADER_CRC, Checksum::crc32(header, OFFSET_HEADER_CRC));
+
+        ok = ok && std::fseek(out, 0, SEEK_SET) == 0
+                && std::fwrite(header, 1, HEADER_SIZE, out) == HEADER_SIZE
+                && syncFile(out);
+        ok = (std::fclose(out) == 0) && ok;
+
+        if (!ok) {
+            Logger::getInstance().error("Failed to write checkpoint file: " + tempPath);
+            std::remove(tempPath.c_str());
+            return ErrorCode::PERSISTENCE_FAILED;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            Logger::getInstance().error("Failed to install checkpoint file " + path + ": " + error.message());
+            std::remove(tempPath.c_str());
+            return ErrorCode::PERSISTENCE_FAILED;
+        }
+
+        Logger::getInstance().info("Wrote checkpoint with " + std::to_string(count) + " numbers to " + path);
+        return ErrorCode::SUCCESS;
+    }
+
+    bool CheckpointFile::exists(const std::string& path) {
+        std::error_code error;
+        return std::filesystem::exists(path, error);
+    }
+
+    ErrorCode CheckpointFile::open(const std::string& filePath) {
+        close();
+
+        if (!ByteOrder::isLittleEndianHost()) {
+            Logger::getInstance().error("Checkpoint columns can only be mapped on little-endian hosts");
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        if (!mapFile(filePath)) {
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        const char* header = mappedData;
+        bool valid = mappedSize >= HEADER_SIZE
+                  && std::memcmp(header, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0
+                  && ByteOrder::getUint32(header + OFFSET_VERSION) == FORMAT_VERSION
+                  && ByteOrder::getUint32(header + OFFSET_HEADER_CRC) == Checksum::crc32(header, OFFSET_HEADER_CRC);
+
+        if (valid) {
+            entryCount = ByteOrder::getUint64(header + OFFSET_COUNT);
+            valid = mappedSize == HEADER_SIZE + entryCount * 16;
+        }
+
+        if (!valid) {
+            Logger::getInstance().error("Checkpoint file is corrupt or has an unknown format: " + filePath);
+            close();
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        path = filePath;
+        walSequence = ByteOrder::getUint64(header + OFFSET_WAL_SEQUENCE);
+        numbersChecksum = ByteOrder::getUint32(header + OFFSET_NUMBERS_CRC);
+        timestampsChecksum = ByteOrder::getUint32(header + OFFSET_TIMESTAMPS_CRC);
+
+        Logger::getInstance().info("Mapped checkpoint with " + std::to_string(entryCount) + " numbers from " + path);
+        return ErrorCode::SUCCESS;
+    }
+
+    void CheckpointFile::close() {
+        unmapFile();
+        entryCount = 0;
+        walSequence = 0;
+    }
+
+    bool CheckpointFile::isOpen() const {
+        return mappedData != nullptr;
+    }
+
+    size_t CheckpointFile::size() const {
+        return static_cast<size_t>(entryCount);
+    }
+
+    uint64_t CheckpointFile::getWalSequence() const {
+        return walSequence;
+    }
+
+    uint32_t CheckpointFile::getNumbersChecksum() const {
+        return numbersChecksum;
+    }
+
+    uint32_t CheckpointFile::getTimestampsChecksum() const {
+        return timestampsChecksum;
+    }
+
+    const uint64_t* CheckpointFile::getNumbers() const {
+        return reinterpret_cast<const uint64_t*>(mappedData + HEADER_SIZE);
+    }
+
+    const int64_t* CheckpointFile::getTimestamps() const {
+        return reinterpret_cast<const int64_t*>(mappedData + HEADER_SIZE + entryCount * 8);
+    }
+
+    bool CheckpointFile::find(uint64_t number, int64_t& outTimestamp) const {
+        size_t index = lowerBoundIndex(number);
+        if (index == size() || getNumbers()[index] != number) {
+            return false;
+        }
+
+        outTimestamp = getTimestamps()[index];
+        return true;
+    }
+
+    size_t CheckpointFile::lowerBoundIndex(uint64_t number) const {
+        const uint64_t* numbers = getNumbers();
+        return static_cast<size_t>(std::lower_bound(numbers, numbers + size(), number) - numbers);
+    }
+
+#ifdef _WIN32
+    bool CheckpointFile::mapFile(const std::string& filePath) {
+        HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            Logger::getInstance().error("Failed to open checkpoint file: " + std::to_string(GetLastError()));
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            Logger::getInstance().error("CreateFileMapping failed: " + std::to_string(GetLastError()));
+            CloseHandle(file);
+            return false;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) {
+            Logger::getInstance().error("MapViewOfFile failed: " + std::to_string(GetLastError()));
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        fileHandle = file;
+        mappingHandle = mapping;
+        mappedData = static_cast<const char*>(view);
+        mappedSize = static_cast<size_t>(fileSize.QuadPart);
+        return true;
+    }
+
+    void CheckpointFile::unmapFile() {
+        if (mappedData) {
+            UnmapViewOfFile(mappedData);
+            mappedData = nullptr;
+            mappedSize = 0;
+        }
+        if (mappingHandle) {
+            CloseHandle(mappingHandle);
+            mappingHandle = nullptr;
+        }
+        if (fileHandle) {
+            CloseHandle(fileHandle);
+            fileHandle = nullptr;
+        }
+    }
+#else
+    bool CheckpointFile::mapFile(const std::string& filePath) {
+        int fd = ::open(filePath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            Logger::getInstance().error("Failed to open checkpoint file: " + filePath);
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            Logger::getInstance().error("mmap of checkpoint file failed: " + filePath);
+            ::close(fd);
+            return false;
+        }
+
+        fileDescriptor = fd;
+        mappedData = static_cast<const char*>(view);
+        mappedSize = static_cast<size_t>(fileStat.st_size);
+        return true;
+    }
+
+    void CheckpointFile::unmapFile() {
+        if (mappedData) {
+            munmap(const_cast<char*>(mappedData), mappedSize);
+            mappedData = nullptr;
+            mappedSize = 0;
+        }
+        if (fileDescriptor >= 0) {
+            ::close(fileDescriptor);
+            fileDescriptor = -1;
+        }
+    }
+#endif
+}
@@ -0,0 +1,80 @@
+#ifndef CHECKPOINT_FILE_HXX
+#define CHECKPOINT_FILE_HXX
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "../utils/ErrorCodes.hxx"
+
+namespace NumberStore {
+    class StoreSnapshot;
+
+    // Compact, sorted binary image of the store that can be memory-mapped and
+    // served from directly.
+    //
+    // Layout (all integers little-endian):
+    //   [0, 64)                  header: magic, format version, entry count, WAL sequence,
+    //                            CRC-32 of each column, CRC-32 of the header itself
+    //   [64, 64 + 8n)            number column, ascending
+    //   [64 + 8n, 64 + 16n)      timestamp column, parallel to the numbers
+    //
+    // Opening only validates the header, so mapping is O(1) in the entry count;
+    // NumberStore checks the column checksums on its loader thread before the file is served.
+    class CheckpointFile {
+    public:
+        static constexpr size_t HEADER_SIZE = 64;
+        static constexpr uint32_t FORMAT_VERSION = 1;
+
+    private:
+        std::string path;
+        const char* mappedData;
+        size_t mappedSize;
+        uint64_t entryCount;
+        uint64_t walSequence;
+        uint32_t numbersChecksum;
+        uint32_t timestampsChecksum;
+
+#ifdef _WIN32
+        void* fileHandle;
+        void* mappingHandle;
+#else
+        int fileDescriptor;
+#endif
+
+    public:
+        CheckpointFile();
+        ~CheckpointFile();
+
+        CheckpointFile(const CheckpointFile&) = delete;
+        CheckpointFile& operator=(const CheckpointFile&) = delete;
+        CheckpointFile(CheckpointFile&&) = delete;
+        CheckpointFile& operator=(CheckpointFile&&) = delete;
+
+        // Writes the snapshot to path atomically (temp file + fsync + rename)
+        static ErrorCode write(const std::string& path, const StoreSnapshot& snapshot);
+        static bool exists(const std::string& path);
+
+        // Maps the file read-only and validates its header
+        ErrorCode open(const std::string& filePath);
+        void close();
+        bool isOpen() const;
+
+        size_t size() const;
+        uint64_t getWalSequence() const;
+        uint32_t getNumbersChecksum() const;
+        uint32_t getTimestampsChecksum() const;
+
+        // Column views straight into the mapping
+        const uint64_t* getNumbers() const;
+        const int64_t* getTimestamps() const;
+
+        bool find(uint64_t number, int64_t& outTimestamp) const;
+        size_t lowerBoundIndex(uint64_t number) const;
+
+    private:
+        bool mapFile(const std::string& filePath);
+        void unmapFile();
+    };
+}
+
+#endif // CHECKPOINT_FILE_HXX
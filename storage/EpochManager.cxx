@@ -0,0 +1,131 @@
+#include "EpochManager.hxx"
+#include <limits>
+
+namespace NumberStore {
+    std::unique_ptr<EpochManager> EpochManager::instance;
+    std::once_flag EpochManager::instanceFlag;
+
+    namespace {
+        // This thread's slot (claimed on first use, released when the thread exits) and
+        // how many guards it currently holds
+        struct ThreadPin {
+            std::atomic<bool>* owned = nullptr;
+            void* slot = nullptr;
+            size_t depth = 0;
+
+            ~ThreadPin() {
+                if (owned) {
+                    owned->store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local ThreadPin threadPin;
+    }
+
+    EpochManager::Guard::Guard(EpochManager& epochs) : manager(epochs), pinned(false) {
+        ThreadSlot* slot = manager.slotForThisThread();
+        if (!slot) {
+            return;
+        }
+
+        pinned = true;
+        if (threadPin.depth++ == 0) {
+            // The announcement must be visible before any pointer is loaded, which the
+            // sequentially consistent store guarantees against retire()'s epoch bump
+            slot->epoch.store(manager.globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+    }
+
+    EpochManager::Guard::~Guard() {
+        if (pinned && --threadPin.depth == 0) {
+            static_cast<ThreadSlot*>(threadPin.slot)->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    bool EpochManager::Guard::isPinned() const {
+        return pinned;
+    }
+
+    EpochManager::EpochManager() : globalEpoch(1) {
+    }
+
+    EpochManager::~EpochManager() {
+        // No reader is left once the process tears this down
+        for (auto& item : retired) {
+            item.free();
+        }
+    }
+
+    EpochManager& EpochManager::getInstance() {
+        // Readers come through here on every lookup, so the initialized path must not take a lock
+        std::call_once(instanceFlag, [] {
+            instance = std::unique_ptr<EpochManager>(new EpochManager());
+        });
+        return *instance;
+    }
+
+    void EpochManager::retire(std::function<void()> free) {
+        // Readers that pin after this bump cannot have seen the unlinked object
+        uint64_t epoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex);
+            retired.push_back(Retired{epoch, std::move(free)});
+        }
+        reclaim();
+    }
+
+    void EpochManager::reclaim() {
+        std::vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex);
+            uint64_t oldest = oldestPinnedEpoch();
+            auto keep = retired.begin();
+            for (auto it = retired.begin(); it != retired.end(); ++it) {
+                if (it->epoch < oldest) {
+                    ready.push_back(std::move(*it));
+                } else {
+                    *keep++ = std::move(*it);
+                }
+            }
+            retired.erase(keep, retired.end());
+        }
+
+        for (auto& item : ready) {
+            item.free();
+        }
+    }
+
+    size_t EpochManager::getRetiredCount() {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        return retired.size();
+    }
+
+    EpochManager::ThreadSlot* EpochManager::slotForThisThread() {
+        if (threadPin.slot) {
+            return static_cast<ThreadSlot*>(threadPin.slot);
+        }
+
+        for (auto& slot : slots) {
+            bool expected = false;
+            if (!slot.owned.load(std::memory_order_relaxed) &&
+                slot.owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                threadPin.owned = &slot.owned;
+                threadPin.slot = &slot;
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    uint64_t EpochManager::oldestPinnedEpoch() const {
+        uint64_t oldest = (std::numeric_limits<uint64_t>::max)();
+        for (const auto& slot : slots) {
+            uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0 && epoch < oldest) {
+                oldest = epoch;
+            }
+        }
+        return oldest;
+    }
+}
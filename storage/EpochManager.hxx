@@ -0,0 +1,83 @@
+#ifndef EPOCH_MANAGER_HXX
+#define EPOCH_MANAGER_HXX
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace NumberStore {
+    // Epoch-based reclamation for structures that readers walk without a lock.
+    //
+    // A reader pins the current epoch for as long as it holds pointers into such a
+    // structure. A writer that unlinks an object hands it to retire() instead of
+    // deleting it; the object is freed once every reader pinned at or before the
+    // retirement has unpinned. Pinning is two stores to a cache line owned by the
+    // reading thread, so readers never write shared memory.
+    class EpochManager {
+    public:
+        static const size_t MAX_THREADS = 256;
+
+        // Pins the epoch for its lifetime; nests within a thread. More than MAX_THREADS
+        // concurrent reading threads leave the extras unpinned, and those must take the
+        // locked path instead.
+        class Guard {
+        private:
+            EpochManager& manager;
+            bool pinned;
+
+        public:
+            explicit Guard(EpochManager& epochs);
+            ~Guard();
+
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+
+            bool isPinned() const;
+        };
+
+    private:
+        struct alignas(64) ThreadSlot {
+            std::atomic<uint64_t> epoch{0};    // 0 while the owning thread is outside any guard
+            std::atomic<bool> owned{false};
+        };
+
+        struct Retired {
+            uint64_t epoch;
+            std::function<void()> free;
+        };
+
+        static std::unique_ptr<EpochManager> instance;
+        static std::once_flag instanceFlag;
+
+        std::atomic<uint64_t> globalEpoch;
+        ThreadSlot slots[MAX_THREADS];
+        std::mutex retiredMutex;
+        std::vector<Retired> retired;
+
+        EpochManager();
+
+        ThreadSlot* slotForThisThread();
+        uint64_t oldestPinnedEpoch() const;
+
+    public:
+        ~EpochManager();
+        EpochManager(const EpochManager&) = delete;
+        EpochManager& operator=(const EpochManager&) = delete;
+        EpochManager(EpochManager&&) = delete;
+        EpochManager& operator=(EpochManager&&) = delete;
+
+        static EpochManager& getInstance();
+
+        // The caller has already made the object unreachable for new readers
+        void retire(std::function<void()> free);
+        // Frees every retired object no pinned reader can still hold
+        void reclaim();
+        size_t getRetiredCount();
+    };
+}
+
+#endif // EPOCH_MANAGER_HXX
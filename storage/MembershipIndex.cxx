@@ -0,0 +1,161 @@
+#include "MembershipIndex.hxx"
+#include <limits>
+
+namespace NumberStore {
+    namespace {
+        const uint64_t EMPTY_KEY = 0;
+        const uint64_t TOMBSTONE_KEY = (std::numeric_limits<uint64_t>::max)();
+
+        // Tables are kept at most half full, counting tombstones
+        const size_t LOAD_DIVISOR = 2;
+    }
+
+    MembershipIndex::Table::Table(size_t capacity)
+        : mask(capacity - 1), used(0), keys(new std::atomic<uint64_t>[capacity]) {
+        for (size_t i = 0; i < capacity; ++i) {
+            keys[i].store(EMPTY_KEY, std::memory_order_relaxed);
+        }
+    }
+
+    MembershipIndex::MembershipIndex(EpochManager& epochManager)
+        : epochs(epochManager), table(new Table(MIN_CAPACITY)), hasEmptyKey(false), hasTombstoneKey(false),
+          entryCount(0) {
+    }
+
+    MembershipIndex::~MembershipIndex() {
+        delete table.load(std::memory_order_relaxed);
+    }
+
+    bool MembershipIndex::contains(uint64_t number) const {
+        if (number == EMPTY_KEY) {
+            return hasEmptyKey.load(std::memory_order_acquire);
+        }
+        if (number == TOMBSTONE_KEY) {
+            return hasTombstoneKey.load(std::memory_order_acquire);
+        }
+
+        const Table* current = table.load(std::memory_order_seq_cst);
+        for (size_t slot = slotFor(number, current->mask);; slot = (slot + 1) & current->mask) {
+            uint64_t key = current->keys[slot].load(std::memory_order_acquire);
+            if (key == number) {
+                return true;
+            }
+            if (key == EMPTY_KEY) {
+                return false;
+            }
+        }
+    }
+
+    void MembershipIndex::insert(uint64_t number) {
+        if (number == EMPTY_KEY || number == TOMBSTONE_KEY) {
+            (number == EMPTY_KEY ? hasEmptyKey : hasTombstoneKey).store(true, std::memory_order_release);
+            return;
+        }
+
+        Table* current = table.load(std::memory_order_relaxed);
+        if ((current->used + 1) * LOAD_DIVISOR > current->mask + 1) {
+            // Growing also drops the tombstones, so a table churned by deletes is
+            // rebuilt at its current size rather than doubled
+            Table* replacement = new Table(capacityFor(entryCount + 1));
+            for (size_t i = 0; i <= current->mask; ++i) {
+                uint64_t key = current->keys[i].load(std::memory_order_relaxed);
+                if (key != EMPTY_KEY && key != TOMBSTONE_KEY) {
+                    place(*replacement, key);
+                }
+            }
+            publish(replacement);
+            current = replacement;
+        }
+
+        for (size_t slot = slotFor(number, current->mask);; slot = (slot + 1) & current->mask) {
+            uint64_t key = current->keys[slot].load(std::memory_order_relaxed);
+            if (key == EMPTY_KEY || key == TOMBSTONE_KEY) {
+                current->keys[slot].store(number, std::memory_order_release);
+                if (key == EMPTY_KEY) {
+                    ++current->used;
+                }
+                break;
+            }
+        }
+        ++entryCount;
+    }
+
+    void MembershipIndex::erase(uint64_t number) {
+        if (number == EMPTY_KEY || number == TOMBSTONE_KEY) {
+            (number == EMPTY_KEY ? hasEmptyKey : hasTombstoneKey).store(false, std::memory_order_release);
+            return;
+        }
+
+        Table* current = table.load(std::memory_order_relaxed);
+        for (size_t slot = slotFor(number, current->mask);; slot = (slot + 1) & current->mask) {
+            uint64_t key = current->keys[slot].load(std::memory_order_relaxed);
+            if (key == number) {
+                current->keys[slot].store(TOMBSTONE_KEY, std::memory_order_release);
+                --entryCount;
+                return;
+            }
+            if (key == EMPTY_KEY) {
+                return;
+            }
+        }
+    }
+
+    void MembershipIndex::clear() {
+        hasEmptyKey.store(false, std::memory_order_release);
+        hasTombstoneKey.store(false, std::memory_order_release);
+        entryCount = 0;
+        publish(new Table(MIN_CAPACITY));
+    }
+
+    void MembershipIndex::rebuild(const PersistentTree& numbers) {
+        hasEmptyKey.store(false, std::memory_order_release);
+        hasTombstoneKey.store(false, std::memory_order_release);
+        entryCount = 0;
+
+        Table* replacement = new Table(capacityFor(numbers.size()));
+        for (auto it = numbers.begin(); it.isValid(); ++it) {
+            uint64_t number = it.getNumber();
+            if (number == EMPTY_KEY || number == TOMBSTONE_KEY) {
+                (number == EMPTY_KEY ? hasEmptyKey : hasTombstoneKey).store(true, std::memory_order_release);
+            } else {
+                place(*replacement, number);
+                ++entryCount;
+            }
+        }
+        publish(replacement);
+    }
+
+    size_t MembershipIndex::getMemoryUsage() const {
+        EpochManager::Guard guard(epochs);
+        return (table.load(std::memory_order_seq_cst)->mask + 1) * sizeof(std::atomic<uint64_t>);
+    }
+
+    size_t MembershipIndex::slotFor(uint64_t number, size_t mask) {
+        // Fibonacci hashing keeps the high bits, which the shard choice does not use
+        return static_cast<size_t>((number * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    }
+
+    size_t MembershipIndex::capacityFor(size_t entries) {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity < (entries + 1) * LOAD_DIVISOR * 2) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    void MembershipIndex::place(Table& target, uint64_t number) {
+        for (size_t slot = slotFor(number, target.mask);; slot = (slot + 1) & target.mask) {
+            if (target.keys[slot].load(std::memory_order_relaxed) == EMPTY_KEY) {
+                target.keys[slot].store(number, std::memory_order_relaxed);
+                ++target.used;
+                return;
+            }
+        }
+    }
+
+    void MembershipIndex::publish(Table* replacement) {
+        // Sequentially consistent so a reader that pins after retire() sees the new table
+        Table* previous = table.exchange(replacement, std::memory_order_seq_cst);
+        epochs.retire([previous] { delete previous; });
+    }
+}
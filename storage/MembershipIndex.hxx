@@ -0,0 +1,64 @@
+#ifndef MEMBERSHIP_INDEX_HXX
+#define MEMBERSHIP_INDEX_HXX
+
+#include "EpochManager.hxx"
+#include "PersistentTree.hxx"
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace NumberStore {
+    // Lock-free set of the numbers in one shard, kept next to its tree so point lookups
+    // need no lock. Open addressing with linear probing over atomic keys: a writer
+    // (holding the shard lock) fills an empty or deleted slot, and erasing leaves a
+    // tombstone, so a slot never becomes empty again and a reader probing for a present
+    // number always reaches it. Growing or clearing publishes a new table and retires the
+    // old one through the EpochManager; contains() must run inside a pinned Guard.
+    class MembershipIndex {
+    private:
+        struct Table {
+            size_t mask;
+            size_t used;        // Keys plus tombstones; written only under the shard lock
+            std::unique_ptr<std::atomic<uint64_t>[]> keys;
+
+            explicit Table(size_t capacity);
+        };
+
+        static const size_t MIN_CAPACITY = 16;
+
+        EpochManager& epochs;
+        std::atomic<Table*> table;
+        // The two numbers that double as slot markers are tracked apart from the table
+        std::atomic<bool> hasEmptyKey;
+        std::atomic<bool> hasTombstoneKey;
+        size_t entryCount;
+
+    public:
+        explicit MembershipIndex(EpochManager& epochManager);
+        ~MembershipIndex();
+
+        MembershipIndex(const MembershipIndex&) = delete;
+        MembershipIndex& operator=(const MembershipIndex&) = delete;
+
+        bool contains(uint64_t number) const;
+
+        // Writers hold the shard lock. insert() is only called for absent numbers and
+        // erase() for present ones, as the tree reports them.
+        void insert(uint64_t number);
+        void erase(uint64_t number);
+        void clear();
+        void rebuild(const PersistentTree& numbers);
+
+        // Bytes held by the current table
+        size_t getMemoryUsage() const;
+
+    private:
+        static size_t slotFor(uint64_t number, size_t mask);
+        static size_t capacityFor(size_t entries);
+        static void place(Table& target, uint64_t number);
+        void publish(Table* replacement);
+    };
+}
+
+#endif // MEMBERSHIP_INDEX_HXX
@@ -0,0 +1,151 @@
+#include "NodePool.hxx"
+#include "../utils/Constants.hxx"
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace NumberStore {
+    namespace {
+        const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+        size_t sizeClassOf(size_t bytes) {
+            return (bytes + NodePool::SIZE_CLASS_GRANULE - 1) / NodePool::SIZE_CLASS_GRANULE;
+        }
+    }
+
+    NodePool::NodePool(bool useHugePages)
+        : freeLists(), chunkCursor(nullptr), chunkRemaining(0),
+          nextChunkSize(useHugePages ? HUGE_PAGE_SIZE : Constants::NODE_POOL_MIN_CHUNK),
+          hugePages(useHugePages), bytesLive(0), bytesReserved(0), blocksLive(0) {
+    }
+
+    NodePool::~NodePool() {
+        for (const auto& chunk : chunks) {
+            releaseChunk(chunk);
+        }
+    }
+
+    NodePool::Usage NodePool::getUsage() const {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        Usage usage;
+        usage.bytesLive = bytesLive;
+        usage.bytesReserved = bytesReserved;
+        usage.blocksLive = blocksLive;
+        if (bytesReserved > 0) {
+            usage.fragmentation = static_cast<double>(bytesReserved - bytesLive) / static_cast<double>(bytesReserved);
+        }
+        return usage;
+    }
+
+    void* NodePool::do_allocate(size_t bytes, size_t alignment) {
+        size_t sizeClass = sizeClassOf(bytes);
+        if (sizeClass == 0 || sizeClass > SIZE_CLASSES || alignment > SIZE_CLASS_GRANULE) {
+            void* block = ::operator new(bytes, std::align_val_t(alignment));
+            std::lock_guard<std::mutex> lock(poolMutex);
+            bytesLive += bytes;
+            bytesReserved += bytes;
+            ++blocksLive;
+            return block;
+        }
+
+        size_t blockSize = sizeClass * SIZE_CLASS_GRANULE;
+        std::lock_guard<std::mutex> lock(poolMutex);
+        void* block;
+        if (FreeBlock* free = freeLists[sizeClass - 1]) {
+            freeLists[sizeClass - 1] = free->next;
+            block = free;
+        } else {
+            if (chunkRemaining < blockSize) {
+                addChunk();
+            }
+            block = chunkCursor;
+            chunkCursor += blockSize;
+            chunkRemaining -= blockSize;
+        }
+
+        bytesLive += blockSize;
+        ++blocksLive;
+        return block;
+    }
+
+    void NodePool::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+        size_t sizeClass = sizeClassOf(bytes);
+        if (sizeClass == 0 || sizeClass > SIZE_CLASSES || alignment > SIZE_CLASS_GRANULE) {
+            ::operator delete(pointer, std::align_val_t(alignment));
+            std::lock_guard<std::mutex> lock(poolMutex);
+            bytesLive -= bytes;
+            bytesReserved -= bytes;
+            --blocksLive;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto* free = static_cast<FreeBlock*>(pointer);
+        free->next = freeLists[sizeClass - 1];
+        freeLists[sizeClass - 1] = free;
+        bytesLive -= sizeClass * SIZE_CLASS_GRANULE;
+        --blocksLive;
+    }
+
+    bool NodePool::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    void NodePool::addChunk() {
+        // The tail of the old chunk is a whole number of granules; keep it as a free block
+        size_t tailClass = chunkRemaining / SIZE_CLASS_GRANULE;
+        if (tailClass > 0) {
+            tailClass = tailClass < SIZE_CLASSES ? tailClass : SIZE_CLASSES;
+            auto* tail = reinterpret_cast<FreeBlock*>(chunkCursor);
+            tail->next = freeLists[tailClass - 1];
+            freeLists[tailClass - 1] = tail;
+        }
+
+        Chunk chunk = reserveChunk(nextChunkSize);
+        chunks.push_back(chunk);
+        bytesReserved += chunk.size;
+        chunkCursor = static_cast<char*>(chunk.memory);
+        chunkRemaining = chunk.size;
+
+        if (nextChunkSize < Constants::NODE_POOL_MAX_CHUNK) {
+            nextChunkSize *= 2;
+        }
+    }
+
+    NodePool::Chunk NodePool::reserveChunk(size_t size) {
+#ifdef __linux__
+        if (hugePages) {
+            // Over-map by one huge page and trim, so the chunk starts on a huge page boundary
+            size_t mappedSize = size + HUGE_PAGE_SIZE;
+            void* mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapped == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+
+            uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+            uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(uintptr_t(HUGE_PAGE_SIZE) - 1);
+            if (aligned > start) {
+                munmap(mapped, aligned - start);
+            }
+            if (aligned + size < start + mappedSize) {
+                munmap(reinterpret_cast<void*>(aligned + size), start + mappedSize - (aligned + size));
+            }
+            madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+            return Chunk{reinterpret_cast<void*>(aligned), size, true};
+        }
+#endif
+        return Chunk{::operator new(size, std::align_val_t(SIZE_CLASS_GRANULE)), size, false};
+    }
+
+    void NodePool::releaseChunk(const Chunk& chunk) {
+#ifdef __linux__
+        if (chunk.mapped) {
+            munmap(chunk.memory, chunk.size);
+            return;
+        }
+#endif
+        ::operator delete(chunk.memory, std::align_val_t(SIZE_CLASS_GRANULE));
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef NODE_POOL_HXX
+#define NODE_POOL_HXX
+
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace NumberStore {
+    // Memory resource for the tree nodes of one shard. Requests are rounded up to 64-byte
+    // size classes and carved from chunks obtained from the system, which start small and
+    // double up to 2 MB; freed blocks go onto their class's free list and are handed out
+    // again, so a store that churns never returns to malloc. Chunks are released only
+    // when the pool is destroyed, which happens once the last node allocated from it is
+    // gone (NodeAllocator keeps the pool alive). With huge pages enabled (Linux), every
+    // chunk is a 2 MB-aligned block advised for transparent huge pages.
+    class NodePool : public std::pmr::memory_resource {
+    public:
+        static const size_t SIZE_CLASS_GRANULE = 64;
+        static const size_t SIZE_CLASSES = 64;   // Requests up to 4 KB are pooled
+
+        struct Usage {
+            uint64_t bytesLive = 0;      // Handed out and not yet freed (rounded to size class)
+            uint64_t bytesReserved = 0;  // Taken from the system, chunks plus oversized blocks
+            uint64_t blocksLive = 0;
+            // Share of reserved bytes not holding live data: free-list blocks and the
+            // unused tail of the current chunk
+            double fragmentation = 0.0;
+        };
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        struct Chunk {
+            void* memory;
+            size_t size;
+            bool mapped;
+        };
+
+        mutable std::mutex poolMutex;
+        FreeBlock* freeLists[SIZE_CLASSES];
+        std::vector<Chunk> chunks;
+        char* chunkCursor;
+        size_t chunkRemaining;
+        size_t nextChunkSize;
+        bool hugePages;
+        uint64_t bytesLive;
+        uint64_t bytesReserved;
+        uint64_t blocksLive;
+
+    public:
+        explicit NodePool(bool useHugePages = false);
+        ~NodePool() override;
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        Usage getUsage() const;
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        void addChunk();
+        Chunk reserveChunk(size_t size);
+        static void releaseChunk(const Chunk& chunk);
+    };
+
+    // Allocator for std::allocate_shared that draws from a NodePool. The control block
+    // keeps a copy, so the pool outlives every node allocated from it.
+    template <typename T>
+    class NodeAllocator {
+    public:
+        using value_type = T;
+
+        std::shared_ptr<NodePool> pool;
+
+        explicit NodeAllocator(std::shared_ptr<NodePool> nodePool) : pool(std::move(nodePool)) {
+        }
+
+        template <typename U>
+        NodeAllocator(const NodeAllocator<U>& other) : pool(other.pool) {
+        }
+
+        T* allocate(size_t count) {
+            return static_cast<T*>(pool->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* pointer, size_t count) {
+            pool->deallocate(pointer, count * sizeof(T), alignof(T));
+        }
+
+        template <typename U>
+        bool operator==(const NodeAllocator<U>& other) const {
+            return pool == other.pool;
+        }
+
+        template <typename U>
+        bool operator!=(const NodeAllocator<U>& other) const {
+            return pool != other.pool;
+        }
+    };
+}
+
+#endif // NODE_POOL_HXX
@@ -1,90 +1,535 @@
 #include "NumberStore.hxx"
 #include "../utils/TimeUtils.hxx"
 #include "../utils/Logger.hxx"
+#include "../utils/Config.hxx"
+#include "../utils/Constants.hxx"
+#include "../utils/Checksum.hxx"
 #include <sstream>
 #include <algorithm>
 #include <limits>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
 
 namespace NumberStore {
-    NumberStore::NumberStore() {
+    NumberStore::NumberStore() : NumberStore(Config::getInstance().getShardCount()) {
+    }
+
+    namespace {
+        // Opening a checkpoint only checks its header; the loader checks the columns
+        // before the mapped file answers any read
+        bool columnsIntact(const CheckpointFile& file) {
+            return Checksum::crc32(file.getNumbers(), file.size() * sizeof(uint64_t)) == file.getNumbersChecksum()
+                && Checksum::crc32(file.getTimestamps(), file.size() * sizeof(int64_t)) == file.getTimestampsChecksum();
+        }
+
+        // Time this thread has spent blocked on shard locks (see takeLockWaitNanos())
+        thread_local uint64_t lockWaitNanos = 0;
+
+        // CombiningSlot::state
+        const uint32_t SLOT_FREE = 0;
+        const uint32_t SLOT_PENDING = 1;  // Claimed by its owner, waiting for a combiner
+        const uint32_t SLOT_DONE = 2;     // Result written; the owner frees the slot
+
+        // Each thread publishes through the same slot index in every shard. Threads beyond
+        // the slot count share indexes and fall back to plain locking when theirs is taken.
+        size_t combiningSlotIndex(size_t slotCount) {
+            static std::atomic<size_t> nextIndex{0};
+            thread_local size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed) % slotCount;
+            return index;
+        }
+
+        // Locks, timing the wait only when the lock is contended, so the common case
+        // costs no clock reads
+        template <typename Lock>
+        void acquireTimed(Lock& lock) {
+            if (lock.try_lock()) {
+                return;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            lock.lock();
+            lockWaitNanos += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    NumberStore::NumberStore(size_t shardCount)
+        : writeCombining(Config::getInstance().isWriteCombiningEnabled()), epochs(EpochManager::getInstance()),
+          warming(false), baseServesReads(false), baseVerified(false), filterStopping(false) {
+        bool lockFreeReads = Config::getInstance().isLockFreeReadsEnabled();
+        bool hugePages = Config::getInstance().isHugePagesEnabled();
+        bool bloomFilter = Config::getInstance().isBloomFilterEnabled();
+        shardCount = std::max<size_t>(shardCount, 1);
+        shards.reserve(shardCount);
+        for (size_t i = 0; i < shardCount; ++i) {
+            shards.push_back(std::make_unique<Shard>());
+            shards.back()->nodePool = std::make_shared<NodePool>(hugePages);
+            shards.back()->numbers = PersistentTree(shards.back()->nodePool);
+            if (lockFreeReads) {
+                shards.back()->index = std::make_unique<MembershipIndex>(epochs);
+            }
+            if (bloomFilter) {
+                shards.back()->filter = std::make_unique<BloomFilter>(epochs);
+            }
+        }
+
+        if (bloomFilter) {
+            filterThread = std::thread(&NumberStore::runFilterRebuilds, this);
+        }
+    }
+
+    NumberStore::~NumberStore() {
+        shutdown();
+    }
+
+    ErrorCode NumberStore::recover() {
+        Config& config = Config::getInstance();
+        if (config.getDurabilityMode() == DurabilityMode::NONE) {
+            Logger::getInstance().info("Durability disabled, running in-memory only");
+            return ErrorCode::SUCCESS;
+        }
+
+        std::shared_ptr<CheckpointFile> base;
+        if (CheckpointFile::exists(config.getCheckpointPath())) {
+            // The log records the checkpoint covers are gone, so recovering without it
+            // would silently drop every number it holds
+            base = std::make_shared<CheckpointFile>();
+            ErrorCode opened = base->open(config.getCheckpointPath());
+            if (opened != ErrorCode::SUCCESS) {
+                Logger::getInstance().error("Checkpoint " + config.getCheckpointPath() +
+                                            " is unreadable, refusing to recover without it");
+                return opened;
+            }
+        }
+
+        wal = std::make_unique<WriteAheadLog>(config.getWalPath(), config.getDurabilityMode(),
+                                              std::chrono::milliseconds(config.getWalFlushInterval()));
+
+        // Records the checkpoint already covers are skipped; the rest are applied
+        // directly, or after the checkpoint has been loaded when there is one
+        uint64_t baseSequence = base ? base->getWalSequence() : 0;
+        std::vector<WalRecord> tail;
+        ErrorCode result = wal->replay([this, &base, &tail, baseSequence](const WalRecord& record) {
+            if (record.sequence <= baseSequence) {
+                return;
+            }
+            if (base) {
+                tail.push_back(record);
+            } else {
+                applyRecord(record);
+            }
+        });
+
+        if (result == ErrorCode::SUCCESS) {
+            wal->resumeAfter(baseSequence);
+            result = wal->open();
+        }
+
+        if (result != ErrorCode::SUCCESS) {
+            wal.reset();
+            return result;
+        }
+
+        if (base) {
+            {
+                std::lock_guard<std::mutex> lock(warmMutex);
+                // Without log records past the checkpoint the mapped file is exactly the current contents
+                baseServesReads = tail.empty();
+                baseVerified = false;
+                warmBase = base;
+                warming.store(true, std::memory_order_release);
+            }
+
+            Logger::getInstance().info("Mapped checkpoint with " + std::to_string(base->size()) + " numbers and " +
+                                       std::to_string(tail.size()) + " newer log records, loading in background");
+            loaderThread = std::thread(&NumberStore::loadCheckpoint, this, base, std::move(tail));
+            return ErrorCode::SUCCESS;
+        }
+
+        notifyDataChanged();
+        Logger::getInstance().info("Recovered " + std::to_string(size()) + " numbers from write-ahead log");
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode NumberStore::checkpoint() {
+        CheckpointStats stats;
+        return checkpoint(stats);
+    }
+
+    ErrorCode NumberStore::checkpoint(CheckpointStats& outStats) {
+        outStats = CheckpointStats{0, 0, 0, 0, 0};
+        if (!wal) {
+            return ErrorCode::SUCCESS;
+        }
+
+        if (warming.load(std::memory_order_acquire)) {
+            Logger::getInstance().info("Skipping checkpoint while the previous one is still loading");
+            return ErrorCode::SUCCESS;
+        }
+
+        std::lock_guard<std::mutex> lock(checkpointMutex);
+
+        // The snapshot shares every node with the live trees, so writers keep going and
+        // only copy the nodes they touch while the file is being written from it
+        auto captureStart = std::chrono::steady_clock::now();
+        uint64_t copiedBefore = PersistentTree::getCopiedNodeBytes();
+        StoreSnapshot snapshot = captureSnapshot();
+        auto writeStart = std::chrono::steady_clock::now();
+
+        ErrorCode result = CheckpointFile::write(Config::getInstance().getCheckpointPath(), snapshot);
+        if (result == ErrorCode::SUCCESS) {
+            result = wal->truncateThrough(snapshot.getWalSequence());
+        }
+
+        auto writeEnd = std::chrono::steady_clock::now();
+        outStats.entryCount = snapshot.size();
+        outStats.walSequence = snapshot.getWalSequence();
+        outStats.captureMicros = std::chrono::duration_cast<std::chrono::microseconds>(writeStart - captureStart).count();
+        outStats.writeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(writeEnd - writeStart).count();
+        outStats.copiedNodeBytes = PersistentTree::getCopiedNodeBytes() - copiedBefore;
+        return result;
+    }
+
+    void NumberStore::shutdown() {
+        if (loaderThread.joinable()) {
+            loaderThread.join();
+        }
+
+        if (filterThread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(filterMutex);
+                filterStopping = true;
+            }
+            filterWork.notify_all();
+            filterThread.join();
+        }
+
+        if (wal) {
+            wal->close();
+        }
     }
 
     ErrorCode NumberStore::insert(uint64_t number) {
+        waitUntilWarm();
+
         int64_t timestamp = 0;
-        ErrorCode result;
+        uint64_t sequence = 0;
+        ErrorCode result = writeOne(WalOperation::INSERT, number, timestamp, sequence);
         
-        {
-            std::unique_lock<std::shared_mutex> lock(dataMutex);
-            
-            if (numbers.find(number) != numbers.end()) {
-                result = ErrorCode::DUPLICATE_NUMBER;
-            } else {
-                timestamp = TimeUtils::getCurrentUnixTimestamp();
-                numbers[number] = timestamp;
-                result = ErrorCode::SUCCESS;
-            }
+        if (result == ErrorCode::SUCCESS && wal) {
+            result = wal->waitDurable(sequence);
         }
         
         if (result == ErrorCode::DUPLICATE_NUMBER) {
-            Logger::getInstance().info("Attempted to insert duplicate number: " + std::to_string(number));
+            NS_LOG_DEBUG("Attempted to insert duplicate number: " + std::to_string(number));
+        } else if (result == ErrorCode::PERSISTENCE_FAILED) {
+            Logger::getInstance().error("Inserted number " + std::to_string(number) + " could not be made durable");
         } else {
-            Logger::getInstance().info("Inserted number: " + std::to_string(number) + " at timestamp: " + std::to_string(timestamp));
-            notifyDataChanged();
+            NS_LOG_DEBUG("Inserted number: " + std::to_string(number) + " at timestamp: " + std::to_string(timestamp));
         }
         
         return result;
     }
 
     ErrorCode NumberStore::remove(uint64_t number, int64_t& outtimestamp) {
-        ErrorCode result;
-        bool found = false;
-        
-        {
-            std::unique_lock<std::shared_mutex> lock(dataMutex);
-            
-            auto it = numbers.find(number);
-            if (it == numbers.end()) {
-                result = ErrorCode::NUMBER_NOT_FOUND;
-            } else {
-                outtimestamp = it->second;
-                numbers.erase(it);
-                found = true;
-                result = ErrorCode::SUCCESS;
+        waitUntilWarm();
+
+        // A number the filter rules out is reported missing without locking the shard;
+        // filtered records that a table let it through, for the false positive count
+        Shard& shard = shardFor(number);
+        bool filtered = false;
+        if (shard.filter) {
+            EpochManager::Guard guard(epochs);
+            if (guard.isPinned() && !shard.filter->mayContain(number, filtered)) {
+                NS_LOG_DEBUG("Attempted to delete non-existent number: " + std::to_string(number));
+                return ErrorCode::NUMBER_NOT_FOUND;
             }
         }
+
+        uint64_t sequence = 0;
+        ErrorCode result = writeOne(WalOperation::DELETE_NUM, number, outtimestamp, sequence);
+        bool found = result == ErrorCode::SUCCESS;
+        if (result == ErrorCode::NUMBER_NOT_FOUND && filtered) {
+            shard.filter->recordFalsePositive();
+        }
+        
+        if (found && wal) {
+            result = wal->waitDurable(sequence);
+        }
         
         if (!found) {
-            Logger::getInstance().info("Attempted to delete non-existent number: " + std::to_string(number));
+            NS_LOG_DEBUG("Attempted to delete non-existent number: " + std::to_string(number));
         } else {
-            Logger::getInstance().info("Deleted number: " + std::to_string(number) + " (was inserted at timestamp: " + std::to_string(outtimestamp) + ")");
-            notifyDataChanged();
+            NS_LOG_DEBUG("Deleted number: " + std::to_string(number) + " (was inserted at timestamp: " + std::to_string(outtimestamp) + ")");
+            if (result == ErrorCode::PERSISTENCE_FAILED) {
+                Logger::getInstance().error("Deletion of number " + std::to_string(number) + " could not be made durable");
+            }
         }
         
         return result;
     }
 
+    ErrorCode NumberStore::writeOne(WalOperation operation, uint64_t number, int64_t& outTimestamp, uint64_t& outSequence) {
+        Shard& shard = shardFor(number);
+        if (writeCombining) {
+            CombiningSlot& slot = shard.slots[combiningSlotIndex(COMBINING_SLOTS)];
+            uint32_t expected = SLOT_FREE;
+            if (slot.state.compare_exchange_strong(expected, SLOT_PENDING, std::memory_order_acquire)) {
+                return writeCombined(shard, slot, operation, number, outTimestamp, outSequence);
+            }
+        }
+
+        int64_t timestamp = operation == WalOperation::INSERT ? TimeUtils::getCurrentUnixTimestamp() : 0;
+        ErrorCode result;
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.dataMutex, std::defer_lock);
+            acquireTimed(lock);
+            result = applyLocked(shard, operation, number, timestamp, outTimestamp, outSequence);
+        }
+
+        if (result == ErrorCode::SUCCESS) {
+            notifyDataChanged();
+        }
+        return result;
+    }
+
+    ErrorCode NumberStore::writeCombined(Shard& shard, CombiningSlot& slot, WalOperation operation, uint64_t number,
+                                         int64_t& outTimestamp, uint64_t& outSequence) {
+        slot.operation = operation;
+        slot.number = number;
+        shard.pendingSlots.fetch_or(uint64_t(1) << (&slot - shard.slots), std::memory_order_release);
+
+        // Whoever gets the lock next applies this operation along with every other one
+        // published by then, so a writer usually finds its result without ever locking
+        for (unsigned spins = 0; slot.state.load(std::memory_order_acquire) != SLOT_DONE; ++spins) {
+            std::unique_lock<std::shared_mutex> lock(shard.dataMutex, std::defer_lock);
+            if (spins < Constants::WRITE_COMBINING_SPINS) {
+                if (!lock.try_lock()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+            } else {
+                acquireTimed(lock);
+            }
+
+            size_t changes = combine(shard);
+            lock.unlock();
+            if (changes > 0) {
+                notifyDataChanged(changes);
+            }
+        }
+
+        ErrorCode result = slot.result;
+        outTimestamp = slot.timestamp;
+        outSequence = slot.sequence;
+        slot.state.store(SLOT_FREE, std::memory_order_release);
+        return result;
+    }
+
+    size_t NumberStore::combine(Shard& shard) {
+        uint64_t pending = shard.pendingSlots.exchange(0, std::memory_order_acquire);
+        int64_t timestamp = pending != 0 ? TimeUtils::getCurrentUnixTimestamp() : 0;
+        size_t changes = 0;
+
+        for (size_t i = 0; pending != 0; ++i, pending >>= 1) {
+            if ((pending & 1) == 0) {
+                continue;
+            }
+
+            CombiningSlot& slot = shard.slots[i];
+            slot.result = applyLocked(shard, slot.operation, slot.number, timestamp, slot.timestamp, slot.sequence);
+            if (slot.result == ErrorCode::SUCCESS) {
+                ++changes;
+            }
+            slot.state.store(SLOT_DONE, std::memory_order_release);
+        }
+        return changes;
+    }
+
+    ErrorCode NumberStore::applyLocked(Shard& shard, WalOperation operation, uint64_t number, int64_t timestamp,
+                                       int64_t& outTimestamp, uint64_t& outSequence) {
+        if (operation == WalOperation::INSERT) {
+            if (shard.numbers.contains(number)) {
+                return ErrorCode::DUPLICATE_NUMBER;
+            }
+            shard.numbers.insert(number, timestamp);
+            outTimestamp = timestamp;
+            if (shard.index) {
+                shard.index->insert(number);
+            }
+            if (shard.filter) {
+                filterInsert(shard, number);
+            }
+        } else if (shard.numbers.erase(number, outTimestamp)) {
+            if (shard.index) {
+                shard.index->erase(number);
+            }
+            if (shard.filter) {
+                shard.filter->erase(number);
+            }
+        } else {
+            return ErrorCode::NUMBER_NOT_FOUND;
+        }
+        shard.entryCount.store(shard.numbers.size(), std::memory_order_relaxed);
+
+        // Appending under the shard lock keeps log order consistent with tree order
+        if (wal) {
+            outSequence = wal->append(operation, number, operation == WalOperation::INSERT ? timestamp : 0);
+        }
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode NumberStore::insertBatch(const std::vector<uint64_t>& numbers, std::vector<bool>& outRejected, size_t& outApplied) {
+        return applyBatch(numbers, WalOperation::INSERT, outRejected, outApplied);
+    }
+
+    ErrorCode NumberStore::removeBatch(const std::vector<uint64_t>& numbers, std::vector<bool>& outRejected, size_t& outApplied) {
+        return applyBatch(numbers, WalOperation::DELETE_NUM, outRejected, outApplied);
+    }
+
+    ErrorCode NumberStore::applyBatch(const std::vector<uint64_t>& numbers, WalOperation operation,
+                                      std::vector<bool>& outRejected, size_t& outApplied) {
+        waitUntilWarm();
+
+        outRejected.assign(numbers.size(), true);
+        outApplied = 0;
+
+        // Sort by shard, then number, so every shard is visited once with its keys in tree
+        // order; the position maps each result back to the caller's order
+        struct BatchItem {
+            size_t shard;
+            uint64_t number;
+            size_t position;
+        };
+
+        std::vector<BatchItem> items;
+        items.reserve(numbers.size());
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            items.push_back(BatchItem{shardIndex(numbers[i]), numbers[i], i});
+        }
+        std::sort(items.begin(), items.end(), [](const BatchItem& a, const BatchItem& b) {
+            if (a.shard != b.shard) return a.shard < b.shard;
+            if (a.number != b.number) return a.number < b.number;
+            return a.position < b.position;
+        });
+
+        bool inserting = operation == WalOperation::INSERT;
+        int64_t timestamp = inserting ? TimeUtils::getCurrentUnixTimestamp() : 0;
+        uint64_t lastSequence = 0;
+        std::vector<uint64_t> keys;
+        std::vector<size_t> positions;
+        std::vector<uint8_t> applied;
+
+        for (size_t begin = 0; begin < items.size();) {
+            size_t index = items[begin].shard;
+            size_t end = begin;
+            keys.clear();
+            positions.clear();
+
+            for (; end < items.size() && items[end].shard == index; ++end) {
+                // Only the first occurrence of a repeated number is applied
+                if (keys.empty() || keys.back() != items[end].number) {
+                    keys.push_back(items[end].number);
+                    positions.push_back(items[end].position);
+                }
+            }
+            applied.resize(keys.size());
+
+            Shard& shard = *shards[index];
+            std::unique_lock<std::shared_mutex> lock(shard.dataMutex, std::defer_lock);
+            acquireTimed(lock);
+
+            if (inserting) {
+                shard.numbers.insertSorted(keys.data(), keys.size(), timestamp, applied.data());
+            } else {
+                shard.numbers.eraseSorted(keys.data(), keys.size(), applied.data());
+            }
+
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (!applied[i]) {
+                    continue;
+                }
+                outRejected[positions[i]] = false;
+                ++outApplied;
+
+                if (shard.index) {
+                    if (inserting) {
+                        shard.index->insert(keys[i]);
+                    } else {
+                        shard.index->erase(keys[i]);
+                    }
+                }
+                if (shard.filter) {
+                    if (inserting) {
+                        filterInsert(shard, keys[i]);
+                    } else {
+                        shard.filter->erase(keys[i]);
+                    }
+                }
+
+                // Appending under the shard lock keeps log order consistent with tree order
+                if (wal) {
+                    lastSequence = wal->append(operation, keys[i], timestamp);
+                }
+            }
+
+            shard.entryCount.store(shard.numbers.size(), std::memory_order_relaxed);
+            begin = end;
+        }
+
+        ErrorCode result = ErrorCode::SUCCESS;
+        if (outApplied > 0) {
+            if (wal) {
+                result = wal->waitDurable(lastSequence);
+            }
+            notifyDataChanged(outApplied);
+        }
+
+        NS_LOG_DEBUG(std::string(inserting ? "Inserted " : "Deleted ") + std::to_string(outApplied) + " of " +
+                                   std::to_string(numbers.size()) + " numbers in one batch");
+        if (result == ErrorCode::PERSISTENCE_FAILED) {
+            Logger::getInstance().error("Batch of " + std::to_string(outApplied) + " changes could not be made durable");
+        }
+
+        return result;
+    }
+
     ErrorCode NumberStore::clear() {
-        size_t count;
+        waitUntilWarm();
+
+        size_t count = 0;
+        uint64_t sequence = 0;
         
         {
-            std::unique_lock<std::shared_mutex> lock(dataMutex);
-            count = numbers.size();
-            numbers.clear();
+            // Hold every shard at once (always in index order) so the clear is atomic
+            std::vector<std::unique_lock<std::shared_mutex>> locks;
+            locks.reserve(shards.size());
+            for (auto& shard : shards) {
+                locks.emplace_back(shard->dataMutex, std::defer_lock);
+                acquireTimed(locks.back());
+            }
+
+            for (auto& shard : shards) {
+                count += shard->numbers.size();
+                shard->numbers.clear();
+                indexAll(*shard);
+            }
+
+            if (wal) {
+                sequence = wal->append(WalOperation::DELETE_ALL);
+            }
         }
         
         Logger::getInstance().info("Cleared all numbers (removed " + std::to_string(count) + " entries)");
         notifyDataChanged();
         
-        return ErrorCode::SUCCESS;
+        return wal ? wal->waitDurable(sequence) : ErrorCode::SUCCESS;
     }
 
     std::string NumberStore::printAll() const {
-        std::shared_ptr<const std::map<uint64_t, int64_t>> snapshot;
-        
-        {
-            std::shared_lock<std::shared_mutex> lock(dataMutex);
-            snapshot = snapshotManager.getSnapshot(numbers);
-        }
+        std::shared_ptr<const StoreSnapshot> snapshot = getSnapshot();
         
         if (!snapshot || snapshot->empty()) {
             return "No numbers stored.";
@@ -92,31 +537,412 @@ namespace NumberStore {
         
         std::ostringstream oss;
         
-        for (const auto& [number, timestamp] : *snapshot) {
-            oss << formatNumberEntry(number, timestamp) << "\n";
+        for (auto it = snapshot->begin(); it.isValid(); ++it) {
+            oss << formatNumberEntry(it.getNumber(), it.getTimestamp()) << "\n";
         }
         
-        Logger::getInstance().debug("Printed " + std::to_string(snapshot->size()) + " numbers");
+        NS_LOG_DEBUG("Printed " + std::to_string(snapshot->size()) + " numbers");
         return oss.str();
     }
 
+    std::shared_ptr<const StoreSnapshot> NumberStore::getSnapshot() const {
+        return snapshotManager.getSnapshot([this] { return captureSnapshot(); });
+    }
+
+    ErrorCode NumberStore::getRange(uint64_t low, uint64_t high, size_t limit,
+                                    std::vector<NumberEntry>& outEntries, bool& outHasMore) const {
+        outEntries.clear();
+        outHasMore = false;
+        if (low > high || limit == 0) {
+            return ErrorCode::INVALID_RANGE;
+        }
+
+        std::shared_ptr<const StoreSnapshot> snapshot = snapshotManager.getSnapshot([this] { return captureSnapshot(); });
+        if (!snapshot) {
+            return ErrorCode::SUCCESS;
+        }
+
+        for (auto it = snapshot->lowerBound(low); it.isValid() && it.getNumber() <= high; ++it) {
+            if (outEntries.size() == limit) {
+                outHasMore = true;
+                break;
+            }
+            outEntries.push_back(NumberEntry{it.getNumber(), it.getTimestamp()});
+        }
+
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode NumberStore::countRange(uint64_t low, uint64_t high, size_t& outCount) const {
+        outCount = 0;
+        if (low > high) {
+            return ErrorCode::INVALID_RANGE;
+        }
+
+        std::shared_ptr<const StoreSnapshot> snapshot = snapshotManager.getSnapshot([this] { return captureSnapshot(); });
+        if (snapshot) {
+            outCount = snapshot->countRange(low, high);
+        }
+        return ErrorCode::SUCCESS;
+    }
+
     size_t NumberStore::size() const {
-        std::shared_lock<std::shared_mutex> lock(dataMutex);
-        return numbers.size();
+        if (auto base = readBase()) {
+            return base->size();
+        }
+
+        size_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard->entryCount.load(std::memory_order_relaxed);
+        }
+        return total;
     }
 
     bool NumberStore::contains(uint64_t number) const {
-        std::shared_lock<std::shared_mutex> lock(dataMutex);
-        return numbers.find(number) != numbers.end();
+        if (auto base = readBase()) {
+            int64_t timestamp;
+            return base->find(number, timestamp);
+        }
+
+        Shard& shard = shardFor(number);
+        bool filtered = false;
+        if (shard.index || shard.filter) {
+            EpochManager::Guard guard(epochs);
+            if (guard.isPinned()) {
+                if (shard.filter && !shard.filter->mayContain(number, filtered)) {
+                    return false;
+                }
+                if (shard.index) {
+                    bool found = shard.index->contains(number);
+                    if (!found && filtered) {
+                        shard.filter->recordFalsePositive();
+                    }
+                    return found;
+                }
+            }
+        }
+
+        bool found;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.dataMutex);
+            found = shard.numbers.contains(number);
+        }
+        if (!found && filtered) {
+            shard.filter->recordFalsePositive();
+        }
+        return found;
     }
 
     bool NumberStore::empty() const {
-        std::shared_lock<std::shared_mutex> lock(dataMutex);
-        return numbers.empty();
+        if (auto base = readBase()) {
+            return base->size() == 0;
+        }
+
+        for (const auto& shard : shards) {
+            if (shard->entryCount.load(std::memory_order_relaxed) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t NumberStore::getShardCount() const {
+        return shards.size();
+    }
+
+    uint64_t NumberStore::getSnapshotRebuildCount() const {
+        return snapshotManager.getRebuildCount();
+    }
+
+    StoreMemoryUsage NumberStore::getMemoryUsage() const {
+        StoreMemoryUsage usage{0, 0, 0, 0.0, 0, PersistentTree::getCopiedNodeBytes()};
+        for (const auto& shard : shards) {
+            NodePool::Usage pool = shard->nodePool->getUsage();
+            usage.nodeBytesLive += pool.bytesLive;
+            usage.nodeBytesReserved += pool.bytesReserved;
+            usage.nodeBlocksLive += pool.blocksLive;
+            if (shard->index) {
+                usage.indexBytes += shard->index->getMemoryUsage();
+            }
+        }
+
+        if (usage.nodeBytesReserved > 0) {
+            usage.fragmentation = static_cast<double>(usage.nodeBytesReserved - usage.nodeBytesLive) /
+                                  static_cast<double>(usage.nodeBytesReserved);
+        }
+        return usage;
+    }
+
+    FilterStats NumberStore::getFilterStats() const {
+        FilterStats stats{false, 0, 0, 0, 0, 0.0};
+        for (const auto& shard : shards) {
+            if (!shard->filter) {
+                continue;
+            }
+
+            BloomFilter::Stats filter = shard->filter->getStats();
+            stats.enabled = true;
+            stats.definiteMisses += filter.definiteMisses;
+            stats.falsePositives += filter.falsePositives;
+            stats.rebuilds += filter.rebuilds;
+            stats.bytes += filter.bytes;
+            stats.expectedFalsePositiveRate += filter.expectedFalsePositiveRate / static_cast<double>(shards.size());
+        }
+        return stats;
+    }
+
+    uint64_t NumberStore::takeLockWaitNanos() {
+        uint64_t waited = lockWaitNanos;
+        lockWaitNanos = 0;
+        return waited;
+    }
+
+    uint64_t NumberStore::getDataVersion() const {
+        return snapshotManager.getCurrentVersion();
+    }
+
+    bool NumberStore::isDurable() const {
+        return wal != nullptr;
+    }
+
+    size_t NumberStore::shardIndex(uint64_t number) const {
+        // Mix the bits first so sequential numbers spread evenly across shards
+        uint64_t hash = number;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return static_cast<size_t>(hash % shards.size());
+    }
+
+    NumberStore::Shard& NumberStore::shardFor(uint64_t number) const {
+        return *shards[shardIndex(number)];
+    }
+
+    StoreSnapshot NumberStore::captureSnapshot() const {
+        if (auto base = readBase()) {
+            return StoreSnapshot(base);
+        }
+
+
+        // Shared locks on every shard at once give a consistent cut across shards;
+        // each tree copy is O(1) so the locks are held only briefly
+        std::vector<std::shared_lock<std::shared_mutex>> locks;
+        locks.reserve(shards.size());
+        for (const auto& shard : shards) {
+            locks.emplace_back(shard->dataMutex, std::defer_lock);
+            acquireTimed(locks.back());
+        }
+
+        std::vector<PersistentTree> trees;
+        trees.reserve(shards.size());
+        for (const auto& shard : shards) {
+            trees.push_back(shard->numbers);
+        }
+
+        // Every append happens under a shard lock, so the sequence matches the trees exactly
+        return StoreSnapshot(std::move(trees), wal ? wal->getLastSequence() : 0);
+    }
+
+    void NumberStore::applyRecord(const WalRecord& record) {
+        switch (record.operation) {
+            case WalOperation::INSERT: {
+                Shard& shard = shardFor(record.number);
+                std::unique_lock<std::shared_mutex> lock(shard.dataMutex);
+                if (shard.numbers.insert(record.number, record.timestamp)) {
+                    if (shard.index) {
+                        shard.index->insert(record.number);
+                    }
+                    if (shard.filter) {
+                        filterInsert(shard, record.number);
+                    }
+                }
+                shard.entryCount.store(shard.numbers.size(), std::memory_order_relaxed);
+                break;
+            }
+            case WalOperation::DELETE_NUM: {
+                Shard& shard = shardFor(record.number);
+                std::unique_lock<std::shared_mutex> lock(shard.dataMutex);
+                int64_t timestamp;
+                if (shard.numbers.erase(record.number, timestamp)) {
+                    if (shard.index) {
+                        shard.index->erase(record.number);
+                    }
+                    if (shard.filter) {
+                        shard.filter->erase(record.number);
+                    }
+                }
+                shard.entryCount.store(shard.numbers.size(), std::memory_order_relaxed);
+                break;
+            }
+            case WalOperation::DELETE_ALL:
+                for (auto& shard : shards) {
+                    std::unique_lock<std::shared_mutex> lock(shard->dataMutex);
+                    shard->numbers.clear();
+                    indexAll(*shard);
+                }
+                break;
+        }
+    }
+
+    void NumberStore::loadCheckpoint(std::shared_ptr<const CheckpointFile> base, std::vector<WalRecord> tail) {
+        // Reads wait for the checksums, so they are checked first. Nothing has been written
+        // yet (writes wait for the load), and the log no longer holds what the checkpoint
+        // covers, so a damaged file leaves nothing correct to serve: the process exits.
+        if (!columnsIntact(*base)) {
+            Logger::getInstance().error("Checkpoint " + Config::getInstance().getCheckpointPath() +
+                                        " fails its checksums, refusing to serve it");
+            Logger::getInstance().flush();
+            std::_Exit(EXIT_FAILURE);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(warmMutex);
+            baseVerified = true;
+        }
+        warmCompleted.notify_all();
+
+        // The columns are sorted, so each shard's tree is bulk-built left to right
+        std::vector<PersistentTree::Builder> builders;
+        builders.reserve(shards.size());
+        for (const auto& shard : shards) {
+            builders.emplace_back(shard->nodePool);
+        }
+        const uint64_t* numbers = base->getNumbers();
+        const int64_t* timestamps = base->getTimestamps();
+        for (size_t i = 0; i < base->size(); ++i) {
+            builders[shardIndex(numbers[i])].append(numbers[i], timestamps[i]);
+        }
+
+        {
+            std::vector<std::unique_lock<std::shared_mutex>> locks;
+            locks.reserve(shards.size());
+            for (auto& shard : shards) {
+                locks.emplace_back(shard->dataMutex);
+            }
+
+            for (size_t i = 0; i < shards.size(); ++i) {
+                shards[i]->numbers = builders[i].finish();
+                indexAll(*shards[i]);
+            }
+        }
+
+        for (const auto& record : tail) {
+            applyRecord(record);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(warmMutex);
+            warming.store(false, std::memory_order_release);
+            warmBase.reset();
+        }
+        warmCompleted.notify_all();
+        notifyDataChanged();
+
+        Logger::getInstance().info("Loaded checkpoint, " + std::to_string(size()) + " numbers in store");
+    }
+
+    std::shared_ptr<const CheckpointFile> NumberStore::readBase() const {
+        if (!warming.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        std::unique_lock<std::mutex> lock(warmMutex);
+        if (baseServesReads) {
+            warmCompleted.wait(lock, [this] { return baseVerified || !warming.load(std::memory_order_acquire); });
+            if (warming.load(std::memory_order_acquire)) {
+                return warmBase;
+            }
+            return nullptr;
+        }
+
+        warmCompleted.wait(lock, [this] { return !warming.load(std::memory_order_acquire); });
+        return nullptr;
+    }
+
+    void NumberStore::waitUntilWarm() const {
+        if (!warming.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(warmMutex);
+        warmCompleted.wait(lock, [this] { return !warming.load(std::memory_order_acquire); });
+    }
+
+    void NumberStore::indexAll(Shard& shard) {
+        if (shard.index) {
+            if (shard.numbers.empty()) {
+                shard.index->clear();
+            } else {
+                shard.index->rebuild(shard.numbers);
+            }
+        }
+        if (shard.filter) {
+            // After a clear the old table still covers every number, just with stale
+            // entries, so it keeps answering until the rebuild replaces it
+            if (!shard.numbers.empty()) {
+                shard.filter->invalidate();
+            }
+            queueFilterRebuild(shard);
+        }
+        shard.entryCount.store(shard.numbers.size(), std::memory_order_relaxed);
+    }
+
+    void NumberStore::filterInsert(Shard& shard, uint64_t number) {
+        shard.filter->insert(number);
+        if (shard.filter->isOverloaded()) {
+            queueFilterRebuild(shard);
+        }
+    }
+
+    void NumberStore::queueFilterRebuild(Shard& shard) {
+        if (!shard.filter->markRebuildQueued()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(filterMutex);
+            filterQueue.push_back(&shard);
+        }
+        filterWork.notify_one();
+    }
+
+    void NumberStore::runFilterRebuilds() {
+        std::unique_lock<std::mutex> lock(filterMutex);
+        while (true) {
+            filterWork.wait(lock, [this] { return filterStopping || !filterQueue.empty(); });
+            if (filterStopping) {
+                return;
+            }
+
+            Shard* shard = filterQueue.front();
+            filterQueue.erase(filterQueue.begin());
+            lock.unlock();
+            rebuildFilter(*shard);
+            lock.lock();
+        }
+    }
+
+    void NumberStore::rebuildFilter(Shard& shard) {
+        // The tree copy is O(1); writers only copy the nodes they touch while it is read
+        PersistentTree numbers;
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.dataMutex);
+            numbers = shard.numbers;
+            shard.filter->beginRebuild();
+        }
+
+        shard.filter->buildFrom(numbers);
+
+        // Dropping the copy under the lock orders the reads above before any in-place
+        // update a writer makes once the nodes are no longer shared
+        std::unique_lock<std::shared_mutex> lock(shard.dataMutex);
+        numbers = PersistentTree();
+        shard.filter->finishRebuild();
     }
 
-    void NumberStore::notifyDataChanged() {
-        snapshotManager.incrementVersion();
+    void NumberStore::notifyDataChanged(size_t changes) {
+        snapshotManager.incrementVersion(changes);
     }
 
     std::string NumberStore::formatNumberEntry(uint64_t number, int64_t timestamp) const {
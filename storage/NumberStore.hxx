@@ -1,41 +1,198 @@
 #ifndef NUMBER_STORE_HXX
 #define NUMBER_STORE_HXX
 
-#include <map>
 #include <string>
+#include <vector>
+#include <memory>
 #include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
 #include <cstdint>
+#include "PersistentTree.hxx"
 #include "SnapshotManager.hxx"
+#include "WriteAheadLog.hxx"
+#include "CheckpointFile.hxx"
+#include "EpochManager.hxx"
+#include "MembershipIndex.hxx"
+#include "BloomFilter.hxx"
 #include "../utils/ErrorCodes.hxx"
 
 namespace NumberStore {
+    // Cost of one checkpoint, reported back to whoever requested it
+    struct CheckpointStats {
+        size_t entryCount;
+        uint64_t walSequence;
+        int64_t captureMicros;     // How long every shard lock was held to take the snapshot
+        int64_t writeMillis;       // Writing and syncing the file plus truncating the log
+        uint64_t copiedNodeBytes;  // Tree nodes writers had to copy while the snapshot was being written
+    };
+
+    // Memory held by the store's tree nodes, from the per-shard node pools. Live bytes
+    // include nodes only snapshots still reference; copied bytes count the nodes writers
+    // had to duplicate because a snapshot shared them.
+    struct StoreMemoryUsage {
+        uint64_t nodeBytesLive;
+        uint64_t nodeBytesReserved;
+        uint64_t nodeBlocksLive;
+        double fragmentation;      // Share of reserved node memory not holding live nodes
+        uint64_t indexBytes;       // Lock-free membership tables
+        uint64_t copiedNodeBytes;
+    };
+
+    // Bloom filter checks in front of remove() and contains(), summed over the shards.
+    // The measured false positive rate is falsePositives / (falsePositives + definiteMisses).
+    struct FilterStats {
+        bool enabled;
+        uint64_t definiteMisses;
+        uint64_t falsePositives;
+        uint64_t rebuilds;
+        uint64_t bytes;
+        double expectedFalsePositiveRate;  // Average over the shards' current tables
+    };
+
+    struct NumberEntry {
+        uint64_t number;
+        int64_t timestamp;
+    };
+
     class NumberStore {
     private:
-        std::map<uint64_t, int64_t> numbers;
-        mutable std::shared_mutex dataMutex;
+        // Slots a shard offers to writers for flat combining, one bit each in pendingSlots
+        static const size_t COMBINING_SLOTS = 64;
+
+        // A single INSERT or DELETE published for whichever writer holds the shard lock.
+        // The owner fills in the operation; the combiner fills in the rest and sets SLOT_DONE.
+        struct alignas(64) CombiningSlot {
+            std::atomic<uint32_t> state{0};
+            WalOperation operation = WalOperation::INSERT;
+            uint64_t number = 0;
+            int64_t timestamp = 0;
+            uint64_t sequence = 0;
+            ErrorCode result = ErrorCode::SUCCESS;
+        };
+
+        // One independently locked partition of the key space. Writers keep the index and
+        // entry count in step with the tree, so contains(), size() and empty() need no lock.
+        struct Shard {
+            PersistentTree numbers;
+            mutable std::shared_mutex dataMutex;
+            std::shared_ptr<NodePool> nodePool;
+            std::unique_ptr<MembershipIndex> index;   // Null when lock-free reads are disabled
+            std::unique_ptr<BloomFilter> filter;      // Null when the Bloom filter is disabled
+            std::atomic<size_t> entryCount{0};
+            std::atomic<uint64_t> pendingSlots{0};
+            CombiningSlot slots[COMBINING_SLOTS];
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        const bool writeCombining;
+        EpochManager& epochs;
         mutable SnapshotManager snapshotManager;
+        std::unique_ptr<WriteAheadLog> wal;
+        std::mutex checkpointMutex; // One checkpoint at a time
+
+        // Warm start: while the checkpoint is loaded into the shard trees in the
+        // background, reads are answered from the mapped file once its checksums have
+        // been verified, and writes wait
+        std::atomic<bool> warming;
+        bool baseServesReads;
+        bool baseVerified;
+        std::shared_ptr<const CheckpointFile> warmBase;
+        mutable std::mutex warmMutex;
+        mutable std::condition_variable warmCompleted;
+        std::thread loaderThread;
+
+        // Bloom filters are resized and rebuilt after DELETE_ALL on this thread
+        std::thread filterThread;
+        std::mutex filterMutex;
+        std::condition_variable filterWork;
+        std::vector<Shard*> filterQueue;
+        bool filterStopping;
 
     public:
         NumberStore();
-        ~NumberStore() = default;
+        explicit NumberStore(size_t shardCount);
+        ~NumberStore();
 
         NumberStore(const NumberStore&) = delete;
         NumberStore& operator=(const NumberStore&) = delete;
         NumberStore(NumberStore&&) = delete;
         NumberStore& operator=(NumberStore&&) = delete;
 
+        // Maps the latest checkpoint, replays the write-ahead log after it (per Config
+        // durability settings) and starts logging; the checkpoint loads in the background
+        ErrorCode recover();
+        // Writes a checkpoint of the current contents and drops the log records it covers.
+        // Writers are blocked only while the O(1) snapshot is taken.
+        ErrorCode checkpoint();
+        ErrorCode checkpoint(CheckpointStats& outStats);
+        // Waits for a pending checkpoint load, then flushes and closes the write-ahead log
+        void shutdown();
+
         ErrorCode insert(uint64_t number);
         ErrorCode remove(uint64_t number, int64_t& outtimestamp);
         ErrorCode clear();
+        // Batch forms: the numbers are sorted and each shard is updated under a single
+        // lock acquisition. outRejected[i] is set when numbers[i] was a duplicate (insert)
+        // or missing (remove), including repeats within the batch; outApplied counts the rest.
+        ErrorCode insertBatch(const std::vector<uint64_t>& numbers, std::vector<bool>& outRejected, size_t& outApplied);
+        ErrorCode removeBatch(const std::vector<uint64_t>& numbers, std::vector<bool>& outRejected, size_t& outApplied);
         
         std::string printAll() const;
+        // Immutable, sorted view of the whole store for callers that iterate it themselves
+        std::shared_ptr<const StoreSnapshot> getSnapshot() const;
+        // Up to limit entries with low <= number <= high in ascending order, read from a
+        // snapshot in O(log n + k); outHasMore is set when entries beyond the limit remain
+        ErrorCode getRange(uint64_t low, uint64_t high, size_t limit,
+                           std::vector<NumberEntry>& outEntries, bool& outHasMore) const;
+        ErrorCode countRange(uint64_t low, uint64_t high, size_t& outCount) const;
         size_t size() const;
         bool contains(uint64_t number) const;
         bool empty() const;
+        size_t getShardCount() const;
+        // Increases with every change; used to count writes between checkpoints
+        uint64_t getDataVersion() const;
+        bool isDurable() const;
+        uint64_t getSnapshotRebuildCount() const;
+        StoreMemoryUsage getMemoryUsage() const;
+        FilterStats getFilterStats() const;
         
+        // Nanoseconds the calling thread has spent waiting for contended shard locks
+        // since its previous call
+        static uint64_t takeLockWaitNanos();
         
     private:
-        void notifyDataChanged();
+        size_t shardIndex(uint64_t number) const;
+        Shard& shardFor(uint64_t number) const;
+        StoreSnapshot captureSnapshot() const;
+        void applyRecord(const WalRecord& record);
+        void loadCheckpoint(std::shared_ptr<const CheckpointFile> base, std::vector<WalRecord> tail);
+        // Returns the mapped checkpoint, once verified, if reads should still be served
+        // from it; otherwise waits until the shard trees are complete and returns null
+        std::shared_ptr<const CheckpointFile> readBase() const;
+        void waitUntilWarm() const;
+        ErrorCode applyBatch(const std::vector<uint64_t>& numbers, WalOperation operation,
+                             std::vector<bool>& outRejected, size_t& outApplied);
+        // INSERT or DELETE of one number, through the shard's combiner when enabled.
+        // Bumps the data version; the caller waits for outSequence to become durable.
+        ErrorCode writeOne(WalOperation operation, uint64_t number, int64_t& outTimestamp, uint64_t& outSequence);
+        ErrorCode writeCombined(Shard& shard, CombiningSlot& slot, WalOperation operation, uint64_t number,
+                                int64_t& outTimestamp, uint64_t& outSequence);
+        // Applies every published slot; the shard lock must be held. Returns the entries changed.
+        size_t combine(Shard& shard);
+        // The caller holds the shard lock; timestamp is used for inserts
+        ErrorCode applyLocked(Shard& shard, WalOperation operation, uint64_t number, int64_t timestamp,
+                              int64_t& outTimestamp, uint64_t& outSequence);
+        void indexAll(Shard& shard);
+        // Both called with the shard lock held
+        void filterInsert(Shard& shard, uint64_t number);
+        void queueFilterRebuild(Shard& shard);
+        // Body of filterThread
+        void runFilterRebuilds();
+        void rebuildFilter(Shard& shard);
+        void notifyDataChanged(size_t changes = 1);
         std::string formatNumberEntry(uint64_t number, int64_t timestamp) const;
     };
 }
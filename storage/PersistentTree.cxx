@@ -0,0 +1,695 @@
+#include "PersistentTree.hxx"
+#include <algorithm>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace NumberStore {
+    struct PersistentTree::Node {
+        bool leaf;
+        uint32_t count; // Leaf: number of entries. Internal: number of children
+
+        explicit Node(bool isLeaf) : leaf(isLeaf), count(0) {
+        }
+    };
+
+    struct PersistentTree::LeafNode : PersistentTree::Node {
+        alignas(64) uint64_t keys[MAX_LEAF_ENTRIES];
+        alignas(64) int64_t timestamps[MAX_LEAF_ENTRIES];
+
+        LeafNode() : Node(true) {
+        }
+
+        LeafNode(const LeafNode& other) : Node(true) {
+            count = other.count;
+            std::copy(other.keys, other.keys + count, keys);
+            std::copy(other.timestamps, other.timestamps + count, timestamps);
+        }
+    };
+
+    struct PersistentTree::InternalNode : PersistentTree::Node {
+        alignas(64) uint64_t keys[MAX_CHILDREN - 1]; // keys[i] is the smallest number under children[i + 1]
+        NodePtr children[MAX_CHILDREN];
+
+        InternalNode() : Node(false) {
+        }
+
+        InternalNode(const InternalNode& other) : Node(false) {
+            count = other.count;
+            std::copy(other.keys, other.keys + (count - 1), keys);
+            std::copy(other.children, other.children + count, children);
+        }
+    };
+
+    template <typename NodeType, typename... Args>
+    std::shared_ptr<NodeType> PersistentTree::allocateNode(const std::shared_ptr<NodePool>& nodePool, Args&&... args) {
+        if (nodePool) {
+            return std::allocate_shared<NodeType>(NodeAllocator<NodeType>(nodePool), std::forward<Args>(args)...);
+        }
+        return std::make_shared<NodeType>(std::forward<Args>(args)...);
+    }
+
+    PersistentTree::Iterator::Iterator() : stack(), depth(0) {
+    }
+
+    bool PersistentTree::Iterator::isValid() const {
+        return depth > 0;
+    }
+
+    uint64_t PersistentTree::Iterator::getNumber() const {
+        const Frame& frame = stack[depth - 1];
+        return static_cast<const LeafNode*>(frame.node)->keys[frame.index];
+    }
+
+    int64_t PersistentTree::Iterator::getTimestamp() const {
+        const Frame& frame = stack[depth - 1];
+        return static_cast<const LeafNode*>(frame.node)->timestamps[frame.index];
+    }
+
+    PersistentTree::Iterator& PersistentTree::Iterator::operator++() {
+        Frame& leafFrame = stack[depth - 1];
+        if (++leafFrame.index < leafFrame.node->count) {
+            return *this;
+        }
+
+        // Leaf exhausted: climb until a parent still has a child to the right
+        --depth;
+        while (depth > 0) {
+            Frame& frame = stack[depth - 1];
+            if (++frame.index < frame.node->count) {
+                descendToLeftmost();
+                return *this;
+            }
+            --depth;
+        }
+
+        return *this;
+    }
+
+    size_t PersistentTree::Iterator::getBlockSize() const {
+        const Frame& frame = stack[depth - 1];
+        return frame.node->count - frame.index;
+    }
+
+    const uint64_t* PersistentTree::Iterator::getBlockNumbers() const {
+        const Frame& frame = stack[depth - 1];
+        return static_cast<const LeafNode*>(frame.node)->keys + frame.index;
+    }
+
+    const int64_t* PersistentTree::Iterator::getBlockTimestamps() const {
+        const Frame& frame = stack[depth - 1];
+        return static_cast<const LeafNode*>(frame.node)->timestamps + frame.index;
+    }
+
+    PersistentTree::Iterator& PersistentTree::Iterator::skipBlock() {
+        Frame& leafFrame = stack[depth - 1];
+        leafFrame.index = leafFrame.node->count - 1;
+        return ++(*this);
+    }
+
+    void PersistentTree::Iterator::descendToLeftmost() {
+        while (!stack[depth - 1].node->leaf) {
+            const Frame& frame = stack[depth - 1];
+            const auto* internal = static_cast<const InternalNode*>(frame.node);
+            stack[depth] = Frame{internal->children[frame.index].get(), 0};
+            ++depth;
+        }
+    }
+
+    PersistentTree::Builder::Builder() : entryCount(0) {
+    }
+
+    PersistentTree::Builder::Builder(std::shared_ptr<NodePool> nodePool) : entryCount(0), pool(std::move(nodePool)) {
+    }
+
+    void PersistentTree::Builder::append(uint64_t number, int64_t timestamp) {
+        if (levels.empty()) {
+            levels.push_back(allocateNode<LeafNode>(pool));
+            firstKeys.push_back(number);
+        } else if (levels[0]->count == MAX_LEAF_ENTRIES) {
+            addChild(1, std::move(levels[0]), firstKeys[0]);
+            levels[0] = allocateNode<LeafNode>(pool);
+            firstKeys[0] = number;
+        }
+
+        auto& leaf = static_cast<LeafNode&>(*levels[0]);
+        leaf.keys[leaf.count] = number;
+        leaf.timestamps[leaf.count] = timestamp;
+        ++leaf.count;
+        ++entryCount;
+    }
+
+    void PersistentTree::Builder::addChild(size_t level, NodePtr child, uint64_t firstKey) {
+        if (level == levels.size()) {
+            levels.push_back(allocateNode<InternalNode>(pool));
+            firstKeys.push_back(firstKey);
+        } else if (levels[level]->count == MAX_CHILDREN) {
+            addChild(level + 1, std::move(levels[level]), firstKeys[level]);
+            levels[level] = allocateNode<InternalNode>(pool);
+            firstKeys[level] = firstKey;
+        }
+
+        auto& node = static_cast<InternalNode&>(*levels[level]);
+        if (node.count > 0) {
+            node.keys[node.count - 1] = firstKey;
+        }
+        node.children[node.count] = std::move(child);
+        ++node.count;
+    }
+
+    PersistentTree PersistentTree::Builder::finish() {
+        PersistentTree tree(pool);
+        if (levels.empty()) {
+            return tree;
+        }
+
+        // Close every open node into its parent; closing may add a new top level
+        for (size_t level = 0; level + 1 < levels.size(); ++level) {
+            addChild(level + 1, std::move(levels[level]), firstKeys[level]);
+        }
+
+        tree.root = std::move(levels.back());
+        tree.entryCount = entryCount;
+        fixRightSpine(tree.root);
+
+        levels.clear();
+        firstKeys.clear();
+        entryCount = 0;
+        return tree;
+    }
+
+    std::atomic<uint64_t> PersistentTree::copiedNodeBytes{0};
+
+    PersistentTree::PersistentTree() : entryCount(0) {
+    }
+
+    PersistentTree::PersistentTree(std::shared_ptr<NodePool> nodePool) : entryCount(0), pool(std::move(nodePool)) {
+    }
+
+    size_t PersistentTree::size() const {
+        return entryCount;
+    }
+
+    bool PersistentTree::empty() const {
+        return entryCount == 0;
+    }
+
+    bool PersistentTree::contains(uint64_t number) const {
+        int64_t timestamp;
+        return find(number, timestamp);
+    }
+
+    bool PersistentTree::find(uint64_t number, int64_t& outTimestamp) const {
+        const Node* node = root.get();
+        if (!node) {
+            return false;
+        }
+
+        while (!node->leaf) {
+            const auto* internal = static_cast<const InternalNode*>(node);
+            node = internal->children[childIndexFor(*internal, number)].get();
+        }
+
+        const auto* leaf = static_cast<const LeafNode*>(node);
+        size_t position = lowerBoundInBlock(leaf->keys, leaf->count, number);
+        if (position == leaf->count || leaf->keys[position] != number) {
+            return false;
+        }
+
+        outTimestamp = leaf->timestamps[position];
+        return true;
+    }
+
+    bool PersistentTree::insert(uint64_t number, int64_t timestamp) {
+        // Check first so that a duplicate never copies the path
+        if (contains(number)) {
+            return false;
+        }
+
+        if (!root) {
+            root = allocateNode<LeafNode>(pool);
+        }
+
+        makeMutable(root);
+
+        uint64_t splitKey = 0;
+        NodePtr splitNode;
+        if (insertRecursive(*root, number, timestamp, splitKey, splitNode)) {
+            auto newRoot = allocateNode<InternalNode>(pool);
+            newRoot->keys[0] = splitKey;
+            newRoot->children[0] = std::move(root);
+            newRoot->children[1] = std::move(splitNode);
+            newRoot->count = 2;
+            root = std::move(newRoot);
+        }
+
+        ++entryCount;
+        return true;
+    }
+
+    bool PersistentTree::erase(uint64_t number, int64_t& outTimestamp) {
+        if (!find(number, outTimestamp)) {
+            return false;
+        }
+
+        makeMutable(root);
+        eraseRecursive(*root, number, outTimestamp);
+
+        if (root->leaf && root->count == 0) {
+            root.reset();
+        } else if (!root->leaf && root->count == 1) {
+            NodePtr onlyChild = static_cast<InternalNode&>(*root).children[0];
+            root = std::move(onlyChild);
+        }
+
+        --entryCount;
+        return true;
+    }
+
+    void PersistentTree::clear() {
+        root.reset();
+        entryCount = 0;
+    }
+
+    size_t PersistentTree::insertSorted(const uint64_t* numbers, size_t count, int64_t timestamp, uint8_t* outApplied) {
+        size_t inserted = 0;
+
+        if (count * BULK_MERGE_DIVISOR < entryCount) {
+            for (size_t i = 0; i < count; ++i) {
+                outApplied[i] = insert(numbers[i], timestamp) ? 1 : 0;
+                inserted += outApplied[i];
+            }
+            return inserted;
+        }
+
+        Builder builder(pool);
+        Iterator it = begin();
+        for (size_t i = 0; i < count; ++i) {
+            for (; it.isValid() && it.getNumber() < numbers[i]; ++it) {
+                builder.append(it.getNumber(), it.getTimestamp());
+            }
+
+            if (it.isValid() && it.getNumber() == numbers[i]) {
+                outApplied[i] = 0;
+            } else {
+                builder.append(numbers[i], timestamp);
+                outApplied[i] = 1;
+                ++inserted;
+            }
+        }
+        for (; it.isValid(); ++it) {
+            builder.append(it.getNumber(), it.getTimestamp());
+        }
+
+        *this = builder.finish();
+        return inserted;
+    }
+
+    size_t PersistentTree::eraseSorted(const uint64_t* numbers, size_t count, uint8_t* outApplied) {
+        size_t erased = 0;
+
+        if (count * BULK_MERGE_DIVISOR < entryCount) {
+            int64_t timestamp;
+            for (size_t i = 0; i < count; ++i) {
+                outApplied[i] = erase(numbers[i], timestamp) ? 1 : 0;
+                erased += outApplied[i];
+            }
+            return erased;
+        }
+
+        Builder builder(pool);
+        Iterator it = begin();
+        for (size_t i = 0; i < count; ++i) {
+            for (; it.isValid() && it.getNumber() < numbers[i]; ++it) {
+                builder.append(it.getNumber(), it.getTimestamp());
+            }
+
+            if (it.isValid() && it.getNumber() == numbers[i]) {
+                outApplied[i] = 1;
+                ++erased;
+                ++it;
+            } else {
+                outApplied[i] = 0;
+            }
+        }
+        for (; it.isValid(); ++it) {
+            builder.append(it.getNumber(), it.getTimestamp());
+        }
+
+        *this = builder.finish();
+        return erased;
+    }
+
+    PersistentTree::Iterator PersistentTree::begin() const {
+        Iterator it;
+        if (root) {
+            it.stack[0] = Iterator::Frame{root.get(), 0};
+            it.depth = 1;
+            it.descendToLeftmost();
+        }
+        return it;
+    }
+
+    PersistentTree::Iterator PersistentTree::lowerBound(uint64_t number) const {
+        Iterator it;
+        if (!root) {
+            return it;
+        }
+
+        const Node* node = root.get();
+        while (!node->leaf) {
+            const auto* internal = static_cast<const InternalNode*>(node);
+            size_t index = childIndexFor(*internal, number);
+            it.stack[it.depth++] = Iterator::Frame{node, index};
+            node = internal->children[index].get();
+        }
+
+        const auto* leaf = static_cast<const LeafNode*>(node);
+        size_t position = lowerBoundInBlock(leaf->keys, leaf->count, number);
+
+        if (position < leaf->count) {
+            it.stack[it.depth++] = Iterator::Frame{node, position};
+        } else {
+            // Every number in this leaf is smaller; the answer is the first entry of the next leaf
+            it.stack[it.depth++] = Iterator::Frame{node, leaf->count - 1u};
+            ++it;
+        }
+
+        return it;
+    }
+
+    size_t PersistentTree::countRange(uint64_t low, uint64_t high) const {
+        size_t count = 0;
+        if (low > high) {
+            return count;
+        }
+
+        for (Iterator it = lowerBound(low); it.isValid(); it.skipBlock()) {
+            size_t blockSize = it.getBlockSize();
+            const uint64_t* numbers = it.getBlockNumbers();
+
+            if (numbers[blockSize - 1] <= high) {
+                count += blockSize;
+                continue;
+            }
+
+            count += static_cast<size_t>(std::upper_bound(numbers, numbers + blockSize, high) - numbers);
+            break;
+        }
+
+        return count;
+    }
+
+    uint64_t PersistentTree::getCopiedNodeBytes() {
+        return copiedNodeBytes.load(std::memory_order_relaxed);
+    }
+
+    void PersistentTree::makeMutable(NodePtr& node) {
+        if (node.use_count() == 1) {
+            // Pairs with the release in the last other owner's reference drop
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return;
+        }
+
+        if (node->leaf) {
+            node = allocateNode<LeafNode>(pool, static_cast<const LeafNode&>(*node));
+            copiedNodeBytes.fetch_add(sizeof(LeafNode), std::memory_order_relaxed);
+        } else {
+            node = allocateNode<InternalNode>(pool, static_cast<const InternalNode&>(*node));
+            copiedNodeBytes.fetch_add(sizeof(InternalNode), std::memory_order_relaxed);
+        }
+    }
+
+    void PersistentTree::fixRightSpine(NodePtr& root) {
+        // Bulk loading fills nodes left to right, so only the rightmost node of each level can be underfull
+        Node* node = root.get();
+        while (node && !node->leaf) {
+            auto& internal = static_cast<InternalNode&>(*node);
+            if (internal.count >= 2 && isUnderfull(*internal.children[internal.count - 1])) {
+                size_t leftIndex = internal.count - 2u;
+                if (internal.children[leftIndex]->leaf) {
+                    rebalanceLeaves(internal, leftIndex);
+                } else {
+                    rebalanceInternals(internal, leftIndex);
+                }
+            }
+            node = internal.children[internal.count - 1].get();
+        }
+
+        while (root && !root->leaf && root->count == 1) {
+            NodePtr onlyChild = static_cast<InternalNode&>(*root).children[0];
+            root = std::move(onlyChild);
+        }
+    }
+
+    bool PersistentTree::insertIntoLeaf(LeafNode& leaf, uint64_t number, int64_t timestamp, uint64_t& outSplitKey, NodePtr& outSplitNode) {
+        LeafNode* target = &leaf;
+        bool split = false;
+
+        if (leaf.count == MAX_LEAF_ENTRIES) {
+            // Full: move the upper half into a new right sibling, then insert into whichever half owns the number
+            auto right = allocateNode<LeafNode>(pool);
+            size_t half = MAX_LEAF_ENTRIES / 2;
+            std::copy(leaf.keys + half, leaf.keys + MAX_LEAF_ENTRIES, right->keys);
+            std::copy(leaf.timestamps + half, leaf.timestamps + MAX_LEAF_ENTRIES, right->timestamps);
+            right->count = static_cast<uint32_t>(MAX_LEAF_ENTRIES - half);
+            leaf.count = static_cast<uint32_t>(half);
+
+            if (number >= right->keys[0]) {
+                target = right.get();
+            }
+
+            outSplitNode = std::move(right);
+            split = true;
+        }
+
+        size_t position = lowerBoundInBlock(target->keys, target->count, number);
+        std::copy_backward(target->keys + position, target->keys + target->count, target->keys + target->count + 1);
+        std::copy_backward(target->timestamps + position, target->timestamps + target->count, target->timestamps + target->count + 1);
+        target->keys[position] = number;
+        target->timestamps[position] = timestamp;
+        ++target->count;
+
+        if (split) {
+            outSplitKey = static_cast<const LeafNode&>(*outSplitNode).keys[0];
+        }
+        return split;
+    }
+
+    bool PersistentTree::insertRecursive(Node& node, uint64_t number, int64_t timestamp, uint64_t& outSplitKey, NodePtr& outSplitNode) {
+        if (node.leaf) {
+            return insertIntoLeaf(static_cast<LeafNode&>(node), number, timestamp, outSplitKey, outSplitNode);
+        }
+
+        auto& internal = static_cast<InternalNode&>(node);
+        size_t index = childIndexFor(internal, number);
+        makeMutable(internal.children[index]);
+
+        uint64_t childSplitKey = 0;
+        NodePtr childSplitNode;
+        if (!insertRecursive(*internal.children[index], number, timestamp, childSplitKey, childSplitNode)) {
+            return false;
+        }
+
+        size_t count = internal.count;
+        if (count < MAX_CHILDREN) {
+            std::move_backward(internal.keys + index, internal.keys + (count - 1), internal.keys + count);
+            std::move_backward(internal.children + index + 1, internal.children + count, internal.children + count + 1);
+            internal.keys[index] = childSplitKey;
+            internal.children[index + 1] = std::move(childSplitNode);
+            ++internal.count;
+            return false;
+        }
+
+        // Full: lay out all MAX_CHILDREN + 1 children, keep the lower half and push the middle separator up
+        uint64_t keys[MAX_CHILDREN];
+        NodePtr children[MAX_CHILDREN + 1];
+        std::copy(internal.keys, internal.keys + index, keys);
+        keys[index] = childSplitKey;
+        std::copy(internal.keys + index, internal.keys + (count - 1), keys + index + 1);
+        std::move(internal.children, internal.children + index + 1, children);
+        children[index + 1] = std::move(childSplitNode);
+        std::move(internal.children + index + 1, internal.children + count, children + index + 2);
+
+        size_t total = count + 1;
+        size_t half = total / 2;
+        auto right = allocateNode<InternalNode>(pool);
+
+        std::copy(keys, keys + (half - 1), internal.keys);
+        std::move(children, children + half, internal.children);
+        internal.count = static_cast<uint32_t>(half);
+
+        outSplitKey = keys[half - 1];
+        std::copy(keys + half, keys + (total - 1), right->keys);
+        std::move(children + half, children + total, right->children);
+        right->count = static_cast<uint32_t>(total - half);
+
+        outSplitNode = std::move(right);
+        return true;
+    }
+
+    void PersistentTree::eraseRecursive(Node& node, uint64_t number, int64_t& outTimestamp) {
+        if (node.leaf) {
+            auto& leaf = static_cast<LeafNode&>(node);
+            size_t position = lowerBoundInBlock(leaf.keys, leaf.count, number);
+            outTimestamp = leaf.timestamps[position];
+            std::copy(leaf.keys + position + 1, leaf.keys + leaf.count, leaf.keys + position);
+            std::copy(leaf.timestamps + position + 1, leaf.timestamps + leaf.count, leaf.timestamps + position);
+            --leaf.count;
+            return;
+        }
+
+        auto& internal = static_cast<InternalNode&>(node);
+        size_t index = childIndexFor(internal, number);
+        makeMutable(internal.children[index]);
+        eraseRecursive(*internal.children[index], number, outTimestamp);
+
+        if (internal.count >= 2 && isUnderfull(*internal.children[index])) {
+            size_t leftIndex = index > 0 ? index - 1 : index;
+            makeMutable(internal.children[leftIndex]);
+            makeMutable(internal.children[leftIndex + 1]);
+
+            if (internal.children[leftIndex]->leaf) {
+                rebalanceLeaves(internal, leftIndex);
+            } else {
+                rebalanceInternals(internal, leftIndex);
+            }
+        }
+    }
+
+    void PersistentTree::rebalanceLeaves(InternalNode& parent, size_t leftIndex) {
+        auto& left = static_cast<LeafNode&>(*parent.children[leftIndex]);
+        auto& right = static_cast<LeafNode&>(*parent.children[leftIndex + 1]);
+        size_t total = left.count + right.count;
+
+        if (total <= MAX_LEAF_ENTRIES) {
+            std::copy(right.keys, right.keys + right.count, left.keys + left.count);
+            std::copy(right.timestamps, right.timestamps + right.count, left.timestamps + left.count);
+            left.count = static_cast<uint32_t>(total);
+
+            size_t parentCount = parent.count;
+            std::copy(parent.keys + leftIndex + 1, parent.keys + (parentCount - 1), parent.keys + leftIndex);
+            std::move(parent.children + leftIndex + 2, parent.children + parentCount, parent.children + leftIndex + 1);
+            parent.children[parentCount - 1].reset();
+            --parent.count;
+            return;
+        }
+
+        // Redistribute so both leaves end up with half of the entries
+        size_t half = total / 2;
+        if (left.count < half) {
+            size_t moved = half - left.count;
+            std::copy(right.keys, right.keys + moved, left.keys + left.count);
+            std::copy(right.timestamps, right.timestamps + moved, left.timestamps + left.count);
+            std::copy(right.keys + moved, right.keys + right.count, right.keys);
+            std::copy(right.timestamps + moved, right.timestamps + right.count, right.timestamps);
+            left.count = static_cast<uint32_t>(half);
+            right.count = static_cast<uint32_t>(total - half);
+        } else {
+            size_t moved = left.count - half;
+            std::copy_backward(right.keys, right.keys + right.count, right.keys + right.count + moved);
+            std::copy_backward(right.timestamps, right.timestamps + right.count, right.timestamps + right.count + moved);
+            std::copy(left.keys + half, left.keys + left.count, right.keys);
+            std::copy(left.timestamps + half, left.timestamps + left.count, right.timestamps);
+            left.count = static_cast<uint32_t>(half);
+            right.count = static_cast<uint32_t>(total - half);
+        }
+
+        parent.keys[leftIndex] = right.keys[0];
+    }
+
+    void PersistentTree::rebalanceInternals(InternalNode& parent, size_t leftIndex) {
+        auto& left = static_cast<InternalNode&>(*parent.children[leftIndex]);
+        auto& right = static_cast<InternalNode&>(*parent.children[leftIndex + 1]);
+        size_t total = left.count + right.count;
+
+        // Lay out both nodes with the parent separator between them
+        uint64_t keys[2 * MAX_CHILDREN];
+        NodePtr children[2 * MAX_CHILDREN];
+        std::copy(left.keys, left.keys + (left.count - 1), keys);
+        keys[left.count - 1] = parent.keys[leftIndex];
+        std::copy(right.keys, right.keys + (right.count - 1), keys + left.count);
+        std::move(left.children, left.children + left.count, children);
+        std::move(right.children, right.children + right.count, children + left.count);
+
+        if (total <= MAX_CHILDREN) {
+            std::copy(keys, keys + (total - 1), left.keys);
+            std::move(children, children + total, left.children);
+            left.count = static_cast<uint32_t>(total);
+
+            size_t parentCount = parent.count;
+            std::copy(parent.keys + leftIndex + 1, parent.keys + (parentCount - 1), parent.keys + leftIndex);
+            std::move(parent.children + leftIndex + 2, parent.children + parentCount, parent.children + leftIndex + 1);
+            parent.children[parentCount - 1].reset();
+            --parent.count;
+            return;
+        }
+
+        // Rotate through the parent separator so both nodes end up half full
+        size_t half = total / 2;
+        std::copy(keys, keys + (half - 1), left.keys);
+        std::move(children, children + half, left.children);
+        left.count = static_cast<uint32_t>(half);
+
+        parent.keys[leftIndex] = keys[half - 1];
+
+        std::copy(keys + half, keys + (total - 1), right.keys);
+        std::move(children + half, children + total, right.children);
+        right.count = static_cast<uint32_t>(total - half);
+    }
+
+    bool PersistentTree::isUnderfull(const Node& node) {
+        return node.leaf ? node.count < MIN_LEAF_ENTRIES : node.count < MIN_CHILDREN;
+    }
+
+    size_t PersistentTree::childIndexFor(const InternalNode& node, uint64_t number) {
+        // Separators are unique, so upper_bound is lower_bound plus one on an exact hit
+        size_t separators = node.count - 1u;
+        size_t index = lowerBoundInBlock(node.keys, separators, number);
+        if (index < separators && node.keys[index] == number) {
+            ++index;
+        }
+        return index;
+    }
+
+    size_t PersistentTree::lowerBoundInBlock(const uint64_t* keys, size_t count, uint64_t number) {
+        // Binary search down to a small window, then count the smaller keys without branching
+        size_t low = 0;
+        size_t high = count;
+        while (high - low > LINEAR_SEARCH_WINDOW) {
+            size_t mid = low + (high - low) / 2;
+            if (keys[mid] < number) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        return low + countLess(keys + low, high - low, number);
+    }
+
+    size_t PersistentTree::countLess(const uint64_t* keys, size_t count, uint64_t number) {
+        size_t result = 0;
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        // AVX2 only has a signed 64-bit compare; flipping the sign bit keeps unsigned order
+        static const uint8_t maskBits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+        const __m256i signBit = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ULL));
+        const __m256i target = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(number)), signBit);
+        for (; i + 4 <= count; i += 4) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+            __m256i less = _mm256_cmpgt_epi64(target, _mm256_xor_si256(block, signBit));
+            result += maskBits[_mm256_movemask_pd(_mm256_castsi256_pd(less))];
+        }
+#endif
+
+        for (; i < count; ++i) {
+            result += keys[i] < number ? 1 : 0;
+        }
+
+        return result;
+    }
+}
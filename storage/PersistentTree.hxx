@@ -0,0 +1,155 @@
+#ifndef PERSISTENT_TREE_HXX
+#define PERSISTENT_TREE_HXX
+
+#include "NodePool.hxx"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace NumberStore {
+    // Ordered number -> timestamp map implemented as a path-copying B+tree.
+    //
+    // Nodes are fixed-size blocks: leaves keep numbers and timestamps in separate
+    // contiguous arrays so in-node search only touches the key column (and can use
+    // SIMD compares) and full scans stream through one leaf block at a time.
+    //
+    // Copying a PersistentTree only copies the root pointer, so a copy is an
+    // O(1) snapshot that shares every node with the original. A mutation copies
+    // the nodes on the path from the root to the affected leaf (O(log n) nodes)
+    // whenever they are shared with another copy, and updates them in place when
+    // this tree is their only owner.
+    //
+    // A single instance is not safe for concurrent mutation, but separate copies
+    // can be read and mutated from different threads independently.
+    //
+    // A tree given a NodePool allocates its nodes there, and so do its copies and the
+    // trees built by its batch merges; otherwise nodes come from the global heap.
+    class PersistentTree {
+    private:
+        struct Node;
+        struct LeafNode;
+        struct InternalNode;
+        using NodePtr = std::shared_ptr<Node>;
+
+        static constexpr size_t MAX_LEAF_ENTRIES = 128;
+        static constexpr size_t MIN_LEAF_ENTRIES = MAX_LEAF_ENTRIES / 2;
+        static constexpr size_t MAX_CHILDREN = 64;
+        static constexpr size_t MIN_CHILDREN = MAX_CHILDREN / 2;
+        static constexpr size_t MAX_DEPTH = 16;
+        static constexpr size_t LINEAR_SEARCH_WINDOW = 16;
+        // Batches at least 1/BULK_MERGE_DIVISOR of the tree size are merged by rebuilding it
+        static constexpr size_t BULK_MERGE_DIVISOR = 8;
+
+        NodePtr root;
+        size_t entryCount;
+        std::shared_ptr<NodePool> pool;
+
+        static std::atomic<uint64_t> copiedNodeBytes;
+
+    public:
+        class Iterator {
+        private:
+            struct Frame {
+                const Node* node;
+                size_t index;
+            };
+
+            std::array<Frame, MAX_DEPTH> stack;
+            size_t depth;
+
+            friend class PersistentTree;
+            void descendToLeftmost();
+
+        public:
+            Iterator();
+
+            bool isValid() const;
+            uint64_t getNumber() const;
+            int64_t getTimestamp() const;
+            Iterator& operator++();
+
+            // Contiguous view of the current leaf from the iterator position onwards
+            size_t getBlockSize() const;
+            const uint64_t* getBlockNumbers() const;
+            const int64_t* getBlockTimestamps() const;
+            // Moves to the first entry of the next leaf block
+            Iterator& skipBlock();
+        };
+
+        // Builds a tree in O(n) from numbers appended in strictly increasing order,
+        // filling nodes left to right instead of descending from the root per entry
+        class Builder {
+        private:
+            std::vector<NodePtr> levels;      // Open (rightmost) node per level, leaves first
+            std::vector<uint64_t> firstKeys;  // Smallest number under each open node
+            size_t entryCount;
+            std::shared_ptr<NodePool> pool;
+
+            void addChild(size_t level, NodePtr child, uint64_t firstKey);
+
+        public:
+            Builder();
+            explicit Builder(std::shared_ptr<NodePool> nodePool);
+
+            void append(uint64_t number, int64_t timestamp);
+            PersistentTree finish();
+        };
+
+        PersistentTree();
+        explicit PersistentTree(std::shared_ptr<NodePool> nodePool);
+
+        PersistentTree(const PersistentTree&) = default;
+        PersistentTree& operator=(const PersistentTree&) = default;
+        PersistentTree(PersistentTree&&) noexcept = default;
+        PersistentTree& operator=(PersistentTree&&) noexcept = default;
+
+        size_t size() const;
+        bool empty() const;
+        bool contains(uint64_t number) const;
+        bool find(uint64_t number, int64_t& outTimestamp) const;
+        // Number of entries in [low, high]; whole leaf blocks are counted without visiting entries
+        size_t countRange(uint64_t low, uint64_t high) const;
+
+        // Returns false (and leaves the tree untouched) if the number already exists
+        bool insert(uint64_t number, int64_t timestamp);
+        // Returns false (and leaves the tree untouched) if the number is absent
+        bool erase(uint64_t number, int64_t& outTimestamp);
+        void clear();
+
+        // Batch forms for strictly ascending numbers: outApplied[i] is set to 1 when
+        // numbers[i] was inserted (erased) and 0 when it was already present (absent);
+        // the return value is the number applied. A batch that is large next to the tree
+        // is merged with the existing entries in one linear pass into a rebuilt tree,
+        // a small one goes through insert()/erase() entry by entry.
+        size_t insertSorted(const uint64_t* numbers, size_t count, int64_t timestamp, uint8_t* outApplied);
+        size_t eraseSorted(const uint64_t* numbers, size_t count, uint8_t* outApplied);
+
+        // Iterators borrow the tree's nodes; the tree (or a copy of it) must outlive them
+        Iterator begin() const;
+        Iterator lowerBound(uint64_t number) const;
+
+        // Bytes of nodes copied because a snapshot still shared them, across all trees
+        static uint64_t getCopiedNodeBytes();
+
+    private:
+        template <typename NodeType, typename... Args>
+        static std::shared_ptr<NodeType> allocateNode(const std::shared_ptr<NodePool>& nodePool, Args&&... args);
+
+        void makeMutable(NodePtr& node);
+        static void fixRightSpine(NodePtr& root);
+        bool insertIntoLeaf(LeafNode& leaf, uint64_t number, int64_t timestamp, uint64_t& outSplitKey, NodePtr& outSplitNode);
+        bool insertRecursive(Node& node, uint64_t number, int64_t timestamp, uint64_t& outSplitKey, NodePtr& outSplitNode);
+        void eraseRecursive(Node& node, uint64_t number, int64_t& outTimestamp);
+        static void rebalanceLeaves(InternalNode& parent, size_t leftIndex);
+        static void rebalanceInternals(InternalNode& parent, size_t leftIndex);
+        static bool isUnderfull(const Node& node);
+        static size_t childIndexFor(const InternalNode& node, uint64_t number);
+        static size_t lowerBoundInBlock(const uint64_t* keys, size_t count, uint64_t number);
+        static size_t countLess(const uint64_t* keys, size_t count, uint64_t number);
+    };
+}
+
+#endif // PERSISTENT_TREE_HXX
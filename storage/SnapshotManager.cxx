@@ -5,39 +5,41 @@ namespace NumberStore {
     SnapshotManager::SnapshotManager() {
     }
 
-    std::shared_ptr<const std::map<uint64_t, int64_t>> SnapshotManager::getSnapshot(const std::map<uint64_t, int64_t>& currentData) const {
-        // Check if we need a fresh snapshot
+    std::shared_ptr<const StoreSnapshot> SnapshotManager::getSnapshot(const std::function<StoreSnapshot()>& capture) const {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+
         if (needsUpdate()) {
-            std::lock_guard<std::mutex> lock(snapshotMutex);
-            
-            // Double-check after acquiring lock (another thread might have updated)
-            if (needsUpdate()) {
-                Logger::getInstance().debug("Creating new snapshot with " + std::to_string(currentData.size()) + " items");
-                cachedSnapshot = std::make_shared<std::map<uint64_t, int64_t>>(currentData);
-                snapshotVersion.store(dataVersion.load());
-            }
+            // Read the version before capturing so a write that lands in between
+            // makes the snapshot look stale rather than current
+            uint64_t version = dataVersion.load();
+            cachedSnapshot = std::make_shared<const StoreSnapshot>(capture());
+            snapshotVersion.store(version);
+            rebuildCount.fetch_add(1, std::memory_order_relaxed);
+            NS_LOG_DEBUG("Created new snapshot with " + std::to_string(cachedSnapshot->size()) + " items");
         }
-        
-        // Return the cached snapshot
-        std::lock_guard<std::mutex> lock(snapshotMutex);
-        return std::static_pointer_cast<const std::map<uint64_t, int64_t>>(cachedSnapshot);
+
+        return cachedSnapshot;
     }
 
     void SnapshotManager::invalidateSnapshot() {
         std::lock_guard<std::mutex> lock(snapshotMutex);
         cachedSnapshot.reset();
-        Logger::getInstance().debug("Snapshot invalidated");
+        NS_LOG_DEBUG("Snapshot invalidated");
     }
 
-    void SnapshotManager::incrementVersion() {
-        dataVersion.fetch_add(1);
-        Logger::getInstance().debug("Data version incremented to " + std::to_string(dataVersion.load()));
+    void SnapshotManager::incrementVersion(uint64_t changes) {
+        dataVersion.fetch_add(changes);
+        NS_LOG_DEBUG("Data version incremented to " + std::to_string(dataVersion.load()));
     }
 
     uint64_t SnapshotManager::getCurrentVersion() const {
         return dataVersion.load();
     }
 
+    uint64_t SnapshotManager::getRebuildCount() const {
+        return rebuildCount.load(std::memory_order_relaxed);
+    }
+
     bool SnapshotManager::hasValidSnapshot() const {
         std::lock_guard<std::mutex> lock(snapshotMutex);
         return cachedSnapshot != nullptr && snapshotVersion.load() == dataVersion.load();
@@ -1,18 +1,20 @@
 #ifndef SNAPSHOT_MANAGER_HXX
 #define SNAPSHOT_MANAGER_HXX
 
-#include <map>
+#include "StoreSnapshot.hxx"
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <functional>
 #include <cstdint>
 
 namespace NumberStore {
     class SnapshotManager {
     private:
-        mutable std::shared_ptr<std::map<uint64_t, int64_t>> cachedSnapshot;
+        mutable std::shared_ptr<const StoreSnapshot> cachedSnapshot;
         mutable std::atomic<uint64_t> dataVersion{0};
         mutable std::atomic<uint64_t> snapshotVersion{0};
+        mutable std::atomic<uint64_t> rebuildCount{0};
         mutable std::mutex snapshotMutex;
 
     public:
@@ -23,12 +25,17 @@ namespace NumberStore {
         SnapshotManager(const SnapshotManager&) = delete;
         SnapshotManager& operator=(const SnapshotManager&) = delete;
 
-        std::shared_ptr<const std::map<uint64_t, int64_t>> getSnapshot(const std::map<uint64_t, int64_t>& currentData) const;
+        // Returns the cached snapshot, calling capture only when the data version has moved
+        std::shared_ptr<const StoreSnapshot> getSnapshot(const std::function<StoreSnapshot()>& capture) const;
         void invalidateSnapshot();
-        void incrementVersion();
+        // One bump per mutation call; a batch passes how many entries it changed so
+        // the version still counts writes (see BackgroundSaver)
+        void incrementVersion(uint64_t changes = 1);
         
         uint64_t getCurrentVersion() const;
         bool hasValidSnapshot() const;
+        // How many times a read found the cached snapshot stale and captured a new one
+        uint64_t getRebuildCount() const;
         
     private:
         bool needsUpdate() const;
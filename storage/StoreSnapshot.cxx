@@ -0,0 +1,158 @@
+#include "StoreSnapshot.hxx"
+#include <algorithm>
+
+namespace NumberStore {
+    namespace {
+        struct CursorGreater {
+            const std::vector<PersistentTree::Iterator>* cursors;
+
+            bool operator()(size_t lhs, size_t rhs) const {
+                return (*cursors)[lhs].getNumber() > (*cursors)[rhs].getNumber();
+            }
+        };
+    }
+
+    StoreSnapshot::Iterator::Iterator() : checkpoint(nullptr), checkpointIndex(0) {
+    }
+
+    bool StoreSnapshot::Iterator::isValid() const {
+        if (checkpoint) {
+            return checkpointIndex < checkpoint->size();
+        }
+        return !heap.empty();
+    }
+
+    uint64_t StoreSnapshot::Iterator::getNumber() const {
+        if (checkpoint) {
+            return checkpoint->getNumbers()[checkpointIndex];
+        }
+        return cursors[heap.front()].getNumber();
+    }
+
+    int64_t StoreSnapshot::Iterator::getTimestamp() const {
+        if (checkpoint) {
+            return checkpoint->getTimestamps()[checkpointIndex];
+        }
+        return cursors[heap.front()].getTimestamp();
+    }
+
+    StoreSnapshot::Iterator& StoreSnapshot::Iterator::operator++() {
+        if (checkpoint) {
+            ++checkpointIndex;
+            return *this;
+        }
+
+        CursorGreater greater{&cursors};
+
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        size_t index = heap.back();
+        ++cursors[index];
+
+        if (cursors[index].isValid()) {
+            std::push_heap(heap.begin(), heap.end(), greater);
+        } else {
+            heap.pop_back();
+        }
+
+        return *this;
+    }
+
+    void StoreSnapshot::Iterator::buildHeap() {
+        heap.clear();
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            if (cursors[i].isValid()) {
+                heap.push_back(i);
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), CursorGreater{&cursors});
+    }
+
+    StoreSnapshot::StoreSnapshot() : totalCount(0), walSequence(0) {
+    }
+
+    StoreSnapshot::StoreSnapshot(std::vector<PersistentTree> shardTrees, uint64_t sequence)
+        : shards(std::move(shardTrees)), totalCount(0), walSequence(sequence) {
+        for (const auto& shard : shards) {
+            totalCount += shard.size();
+        }
+    }
+
+    StoreSnapshot::StoreSnapshot(std::shared_ptr<const CheckpointFile> checkpointFile)
+        : checkpoint(std::move(checkpointFile)), totalCount(checkpoint->size()), walSequence(checkpoint->getWalSequence()) {
+    }
+
+    size_t StoreSnapshot::size() const {
+        return totalCount;
+    }
+
+    bool StoreSnapshot::empty() const {
+        return totalCount == 0;
+    }
+
+    uint64_t StoreSnapshot::getWalSequence() const {
+        return walSequence;
+    }
+
+    bool StoreSnapshot::contains(uint64_t number) const {
+        if (checkpoint) {
+            int64_t timestamp;
+            return checkpoint->find(number, timestamp);
+        }
+
+        for (const auto& shard : shards) {
+            if (shard.contains(number)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t StoreSnapshot::countRange(uint64_t low, uint64_t high) const {
+        if (low > high) {
+            return 0;
+        }
+
+        if (checkpoint) {
+            const uint64_t* first = checkpoint->getNumbers() + checkpoint->lowerBoundIndex(low);
+            const uint64_t* end = checkpoint->getNumbers() + checkpoint->size();
+            return static_cast<size_t>(std::upper_bound(first, end, high) - first);
+        }
+
+        size_t count = 0;
+        for (const auto& shard : shards) {
+            count += shard.countRange(low, high);
+        }
+        return count;
+    }
+
+    StoreSnapshot::Iterator StoreSnapshot::begin() const {
+        Iterator it;
+        if (checkpoint) {
+            it.checkpoint = checkpoint.get();
+            return it;
+        }
+
+        it.cursors.reserve(shards.size());
+        for (const auto& shard : shards) {
+            it.cursors.push_back(shard.begin());
+        }
+        it.buildHeap();
+        return it;
+    }
+
+    StoreSnapshot::Iterator StoreSnapshot::lowerBound(uint64_t number) const {
+        Iterator it;
+        if (checkpoint) {
+            it.checkpoint = checkpoint.get();
+            it.checkpointIndex = checkpoint->lowerBoundIndex(number);
+            return it;
+        }
+
+        it.cursors.reserve(shards.size());
+        for (const auto& shard : shards) {
+            it.cursors.push_back(shard.lowerBound(number));
+        }
+        it.buildHeap();
+        return it;
+    }
+}
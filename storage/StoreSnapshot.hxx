@@ -0,0 +1,60 @@
+#ifndef STORE_SNAPSHOT_HXX
+#define STORE_SNAPSHOT_HXX
+
+#include "PersistentTree.hxx"
+#include "CheckpointFile.hxx"
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace NumberStore {
+    // Immutable point-in-time view over every shard of a NumberStore.
+    // Each shard tree is an O(1) copy; iteration merges the shards so callers
+    // see one globally sorted sequence. While the store is still loading from
+    // a checkpoint the snapshot reads the mapped checkpoint columns instead.
+    class StoreSnapshot {
+    private:
+        std::vector<PersistentTree> shards;
+        std::shared_ptr<const CheckpointFile> checkpoint;
+        size_t totalCount;
+        uint64_t walSequence;
+
+    public:
+        class Iterator {
+        private:
+            std::vector<PersistentTree::Iterator> cursors;
+            std::vector<size_t> heap; // Min-heap of cursor indices ordered by current number
+            const CheckpointFile* checkpoint;
+            size_t checkpointIndex;
+
+            friend class StoreSnapshot;
+            void buildHeap();
+
+        public:
+            Iterator();
+
+            bool isValid() const;
+            uint64_t getNumber() const;
+            int64_t getTimestamp() const;
+            Iterator& operator++();
+        };
+
+        StoreSnapshot();
+        StoreSnapshot(std::vector<PersistentTree> shardTrees, uint64_t sequence);
+        explicit StoreSnapshot(std::shared_ptr<const CheckpointFile> checkpointFile);
+
+        size_t size() const;
+        bool empty() const;
+        // Last write-ahead log sequence reflected in this snapshot
+        uint64_t getWalSequence() const;
+        bool contains(uint64_t number) const;
+        size_t countRange(uint64_t low, uint64_t high) const;
+
+        // Snapshots must outlive their iterators
+        Iterator begin() const;
+        Iterator lowerBound(uint64_t number) const;
+    };
+}
+
+#endif // STORE_SNAPSHOT_HXX
@@ -0,0 +1,307 @@
+#include "WriteAheadLog.hxx"
+#include "../utils/Checksum.hxx"
+#include "../utils/ByteOrder.hxx"
+#include "../utils/Logger.hxx"
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace NumberStore {
+    WriteAheadLog::WriteAheadLog(const std::string& logPath, DurabilityMode durability, std::chrono::milliseconds interval)
+        : path(logPath), mode(durability), flushInterval(interval), file(nullptr),
+          lastSequence(0), durableSequence(0), failed(false), stopping(false), flusherActive(false) {
+    }
+
+    WriteAheadLog::~WriteAheadLog() {
+        close();
+    }
+
+    ErrorCode WriteAheadLog::replay(const std::function<void(const WalRecord&)>& apply) {
+        std::FILE* input = std::fopen(path.c_str(), "rb");
+        if (!input) {
+            Logger::getInstance().info("No write-ahead log found at " + path + ", starting empty");
+            return ErrorCode::SUCCESS;
+        }
+
+        char buffer[RECORD_SIZE];
+        uint64_t validBytes = 0;
+        size_t replayed = 0;
+        bool tornTail = false;
+
+        while (true) {
+            size_t bytesRead = std::fread(buffer, 1, RECORD_SIZE, input);
+            if (bytesRead == 0) {
+                break;
+            }
+
+            WalRecord record;
+            if (bytesRead < RECORD_SIZE || !decodeRecord(buffer, record)) {
+                tornTail = true;
+                break;
+            }
+
+            apply(record);
+            lastSequence = record.sequence;
+            validBytes += RECORD_SIZE;
+            ++replayed;
+        }
+
+        std::fclose(input);
+        durableSequence = lastSequence;
+
+        if (tornTail) {
+            // A crash mid-append leaves a partial record; drop it so new records follow intact ones
+            std::error_code error;
+            std::filesystem::resize_file(path, validBytes, error);
+            if (error) {
+                Logger::getInstance().error("Failed to truncate torn write-ahead log tail: " + error.message());
+                return ErrorCode::PERSISTENCE_FAILED;
+            }
+            Logger::getInstance().warning("Discarded torn record at end of write-ahead log");
+        }
+
+        Logger::getInstance().info("Replayed " + std::to_string(replayed) + " write-ahead log records");
+        return ErrorCode::SUCCESS;
+    }
+
+    ErrorCode WriteAheadLog::open() {
+        if (file) {
+            return ErrorCode::SUCCESS;
+        }
+
+        file = std::fopen(path.c_str(), "ab");
+        if (!file) {
+            Logger::getInstance().error("Failed to open write-ahead log: " + path);
+            return ErrorCode::PERSISTENCE_FAILED;
+        }
+
+        stopping = false;
+        flusherActive = true;
+        flusherThread = std::thread(&WriteAheadLog::flusherLoop, this);
+        Logger::getInstance().info("Write-ahead log opened: " + path);
+        return ErrorCode::SUCCESS;
+    }
+
+    void WriteAheadLog::close() {
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            stopping = true;
+        }
+        flushRequested.notify_all();
+
+        if (flusherThread.joinable()) {
+            flusherThread.join();
+        }
+
+        std::lock_guard<std::mutex> fileLock(fileMutex);
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+            Logger::getInstance().info("Write-ahead log closed: " + path);
+        }
+    }
+
+    uint64_t WriteAheadLog::append(WalOperation operation, uint64_t number, int64_t timestamp) {
+        uint64_t sequence;
+
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            sequence = ++lastSequence;
+
+            size_t offset = pendingBuffer.size();
+            pendingBuffer.resize(offset + RECORD_SIZE);
+            encodeRecord(WalRecord{sequence, operation, number, timestamp}, pendingBuffer.data() + offset);
+        }
+
+        if (mode == DurabilityMode::STRICT) {
+            flushRequested.notify_one();
+        }
+
+        return sequence;
+    }
+
+    ErrorCode WriteAheadLog::waitDurable(uint64_t sequence) {
+        if (mode != DurabilityMode::STRICT) {
+            return ErrorCode::SUCCESS;
+        }
+
+        std::unique_lock<std::mutex> lock(bufferMutex);
+        flushCompleted.wait(lock, [this, sequence] {
+            return durableSequence >= sequence || failed || !flusherActive;
+        });
+
+        return durableSequence >= sequence ? ErrorCode::SUCCESS : ErrorCode::PERSISTENCE_FAILED;
+    }
+
+    ErrorCode WriteAheadLog::truncateThrough(uint64_t sequence) {
+        // Holding the file lock parks the flusher; records it has not written yet stay buffered
+        std::lock_guard<std::mutex> fileLock(fileMutex);
+        if (!file) {
+            return ErrorCode::SUCCESS;
+        }
+
+        std::string tempPath = path + ".tmp";
+        std::FILE* input = std::fopen(path.c_str(), "rb");
+        std::FILE* output = std::fopen(tempPath.c_str(), "wb");
+        bool ok = input && output;
+
+        char buffer[RECORD_SIZE];
+        size_t kept = 0;
+        while (ok && std::fread(buffer, 1, RECORD_SIZE, input) == RECORD_SIZE) {
+            WalRecord record;
+            if (!decodeRecord(buffer, record)) {
+                break;
+            }
+            if (record.sequence > sequence) {
+                ok = std::fwrite(buffer, 1, RECORD_SIZE, output) == RECORD_SIZE;
+                ++kept;
+            }
+        }
+
+        if (input) {
+            std::fclose(input);
+        }
+        if (output) {
+            ok = syncFile(output) && ok;
+            ok = (std::fclose(output) == 0) && ok;
+        }
+
+        if (!ok) {
+            Logger::getInstance().error("Failed to rewrite write-ahead log: " + tempPath);
+            std::remove(tempPath.c_str());
+            return ErrorCode::PERSISTENCE_FAILED;
+        }
+
+        // The live handle must be closed before the rename (required on Windows)
+        std::fclose(file);
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        file = std::fopen(path.c_str(), "ab");
+
+        if (error || !file) {
+            Logger::getInstance().error("Failed to reopen truncated write-ahead log: " + path);
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            failed = true;
+            flushCompleted.notify_all();
+            return ErrorCode::PERSISTENCE_FAILED;
+        }
+
+        Logger::getInstance().info("Truncated write-ahead log through sequence " + std::to_string(sequence) +
+                                   " (" + std::to_string(kept) + " records kept)");
+        return ErrorCode::SUCCESS;
+    }
+
+    void WriteAheadLog::resumeAfter(uint64_t sequence) {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        lastSequence = std::max(lastSequence, sequence);
+        durableSequence = std::max(durableSequence, sequence);
+    }
+
+    DurabilityMode WriteAheadLog::getMode() const {
+        return mode;
+    }
+
+    uint64_t WriteAheadLog::getLastSequence() {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        return lastSequence;
+    }
+
+    void WriteAheadLog::flusherLoop() {
+        std::vector<char> batch;
+        std::unique_lock<std::mutex> lock(bufferMutex);
+
+        while (true) {
+            if (mode == DurabilityMode::STRICT) {
+                flushRequested.wait(lock, [this] { return stopping || !pendingBuffer.empty(); });
+            } else {
+                flushRequested.wait_for(lock, flushInterval, [this] { return stopping; });
+            }
+
+            if (pendingBuffer.empty()) {
+                if (stopping) {
+                    break;
+                }
+                continue;
+            }
+
+            // Everything appended so far goes out with a single fsync
+            batch.swap(pendingBuffer);
+            uint64_t batchSequence = lastSequence;
+
+            lock.unlock();
+            bool written;
+            {
+                std::lock_guard<std::mutex> fileLock(fileMutex);
+                written = writeAndSync(batch);
+            }
+            batch.clear();
+            lock.lock();
+
+            if (written) {
+                durableSequence = batchSequence;
+            } else {
+                failed = true;
+            }
+            flushCompleted.notify_all();
+        }
+
+        flusherActive = false;
+        flushCompleted.notify_all();
+    }
+
+    bool WriteAheadLog::writeAndSync(const std::vector<char>& data) {
+        if (!file || std::fwrite(data.data(), 1, data.size(), file) != data.size()) {
+            Logger::getInstance().error("Failed to write write-ahead log: " + path);
+            return false;
+        }
+
+        if (!syncFile(file)) {
+            Logger::getInstance().error("Failed to sync write-ahead log: " + path);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool WriteAheadLog::syncFile(std::FILE* output) {
+        if (std::fflush(output) != 0) {
+            return false;
+        }
+#ifdef _WIN32
+        return _commit(_fileno(output)) == 0;
+#else
+        return fsync(fileno(output)) == 0;
+#endif
+    }
+
+    void WriteAheadLog::encodeRecord(const WalRecord& record, char* out) {
+        out[0] = static_cast<char>(record.operation);
+        ByteOrder::putUint64(out + 1, record.sequence);
+        ByteOrder::putUint64(out + 9, record.number);
+        ByteOrder::putUint64(out + 17, static_cast<uint64_t>(record.timestamp));
+        ByteOrder::putUint32(out + 25, Checksum::crc32(out, 25));
+    }
+
+    bool WriteAheadLog::decodeRecord(const char* in, WalRecord& record) {
+        if (ByteOrder::getUint32(in + 25) != Checksum::crc32(in, 25)) {
+            return false;
+        }
+
+        uint8_t operation = static_cast<uint8_t>(in[0]);
+        if (operation < static_cast<uint8_t>(WalOperation::INSERT) || operation > static_cast<uint8_t>(WalOperation::DELETE_ALL)) {
+            return false;
+        }
+
+        record.operation = static_cast<WalOperation>(operation);
+        record.sequence = ByteOrder::getUint64(in + 1);
+        record.number = ByteOrder::getUint64(in + 9);
+        record.timestamp = static_cast<int64_t>(ByteOrder::getUint64(in + 17));
+        return true;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef WRITE_AHEAD_LOG_HXX
+#define WRITE_AHEAD_LOG_HXX
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include "../utils/Config.hxx"
+#include "../utils/ErrorCodes.hxx"
+
+namespace NumberStore {
+    enum class WalOperation : uint8_t {
+        INSERT = 1,
+        DELETE_NUM = 2,
+        DELETE_ALL = 3
+    };
+
+    struct WalRecord {
+        uint64_t sequence;
+        WalOperation operation;
+        uint64_t number;
+        int64_t timestamp;
+    };
+
+    // Append-only log of store mutations.
+    //
+    // Writers append encoded records to an in-memory buffer (cheap, may be done
+    // under the store's locks to fix the order). A dedicated flusher thread
+    // writes the accumulated buffer and issues a single fsync for everything
+    // appended since the previous flush, so concurrent writers share one fsync
+    // (group commit). In STRICT mode writers block in waitDurable() until the
+    // flush covering their record completes; in BATCHED mode the flusher runs
+    // every flush interval and writers never wait.
+    class WriteAheadLog {
+    private:
+        static constexpr size_t RECORD_SIZE = 1 + 8 + 8 + 8 + 4; // op, sequence, number, timestamp, crc
+
+        std::string path;
+        DurabilityMode mode;
+        std::chrono::milliseconds flushInterval;
+        std::FILE* file;
+        std::mutex fileMutex; // Serializes flusher writes with truncation
+
+        std::mutex bufferMutex;
+        std::condition_variable flushRequested;
+        std::condition_variable flushCompleted;
+        std::vector<char> pendingBuffer;
+        uint64_t lastSequence;
+        uint64_t durableSequence;
+        bool failed;
+        bool stopping;
+        bool flusherActive;
+        std::thread flusherThread;
+
+    public:
+        WriteAheadLog(const std::string& logPath, DurabilityMode durability, std::chrono::milliseconds interval);
+        ~WriteAheadLog();
+
+        WriteAheadLog(const WriteAheadLog&) = delete;
+        WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+        WriteAheadLog(WriteAheadLog&&) = delete;
+        WriteAheadLog& operator=(WriteAheadLog&&) = delete;
+
+        // Replays every intact record in the log, truncating a torn tail left by a crash.
+        // Must be called before open().
+        ErrorCode replay(const std::function<void(const WalRecord&)>& apply);
+        ErrorCode open();
+        void close();
+
+        // Returns the sequence number assigned to the record
+        uint64_t append(WalOperation operation, uint64_t number = 0, int64_t timestamp = 0);
+        // Blocks until the record with this sequence number is on disk (no-op unless STRICT)
+        ErrorCode waitDurable(uint64_t sequence);
+
+        // Drops records with sequence numbers up to and including this one,
+        // once a checkpoint covers them
+        ErrorCode truncateThrough(uint64_t sequence);
+        // Continues numbering after a sequence the log itself may no longer contain
+        void resumeAfter(uint64_t sequence);
+
+        DurabilityMode getMode() const;
+        uint64_t getLastSequence();
+
+    private:
+        void flusherLoop();
+        bool writeAndSync(const std::vector<char>& data);
+        static bool syncFile(std::FILE* output);
+        static void encodeRecord(const WalRecord& record, char* out);
+        static bool decodeRecord(const char* in, WalRecord& record);
+    };
+}
+
+#endif // WRITE_AHEAD_LOG_HXX
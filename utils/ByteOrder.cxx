@@ -0,0 +1,45 @@
+#include "ByteOrder.hxx"
+
+namespace NumberStore {
+    void ByteOrder::putUint16(char* out, uint16_t value) {
+        out[0] = static_cast<char>(value & 0xFFu);
+        out[1] = static_cast<char>((value >> 8) & 0xFFu);
+    }
+
+    void ByteOrder::putUint32(char* out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out[i] = static_cast<char>((value >> (8 * i)) & 0xFFu);
+        }
+    }
+
+    void ByteOrder::putUint64(char* out, uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            out[i] = static_cast<char>((value >> (8 * i)) & 0xFFu);
+        }
+    }
+
+    uint16_t ByteOrder::getUint16(const char* in) {
+        return static_cast<uint16_t>(static_cast<uint8_t>(in[0]) | (static_cast<uint8_t>(in[1]) << 8));
+    }
+
+    uint32_t ByteOrder::getUint32(const char* in) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t ByteOrder::getUint64(const char* in) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    bool ByteOrder::isLittleEndianHost() {
+        const uint16_t probe = 1;
+        return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef BYTE_ORDER_HXX
+#define BYTE_ORDER_HXX
+
+#include <cstdint>
+
+namespace NumberStore {
+    // Little-endian encoding helpers for on-disk and on-wire formats
+    class ByteOrder {
+    public:
+        static void putUint16(char* out, uint16_t value);
+        static void putUint32(char* out, uint32_t value);
+        static void putUint64(char* out, uint64_t value);
+        static uint16_t getUint16(const char* in);
+        static uint32_t getUint32(const char* in);
+        static uint64_t getUint64(const char* in);
+        static bool isLittleEndianHost();
+    };
+}
+
+#endif // BYTE_ORDER_HXX
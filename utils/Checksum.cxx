@@ -0,0 +1,49 @@
+#include "Checksum.hxx"
+#include <array>
+
+namespace NumberStore {
+    namespace {
+        const size_t SLICES = 16;
+
+        // tables[0] is the byte-at-a-time table; tables[k] advances a byte through k
+        // more zero bytes, so sixteen bytes are folded in with independent lookups
+        // (slicing-by-16) instead of a chain of sixteen dependent ones
+        std::array<std::array<uint32_t, 256>, SLICES> buildCrcTables() {
+            std::array<std::array<uint32_t, 256>, SLICES> tables{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+                }
+                tables[0][i] = value;
+            }
+            for (size_t k = 1; k < SLICES; ++k) {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t previous = tables[k - 1][i];
+                    tables[k][i] = tables[0][previous & 0xFFu] ^ (previous >> 8);
+                }
+            }
+            return tables;
+        }
+    }
+
+    uint32_t Checksum::crc32(const void* data, size_t length, uint32_t seed) {
+        static const std::array<std::array<uint32_t, 256>, SLICES> tables = buildCrcTables();
+
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint32_t crc = ~seed;
+        for (; length >= SLICES; length -= SLICES, bytes += SLICES) {
+            crc ^= static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+                   (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+            crc = tables[15][crc & 0xFFu] ^ tables[14][(crc >> 8) & 0xFFu] ^
+                  tables[13][(crc >> 16) & 0xFFu] ^ tables[12][crc >> 24] ^
+                  tables[11][bytes[4]] ^ tables[10][bytes[5]] ^ tables[9][bytes[6]] ^ tables[8][bytes[7]] ^
+                  tables[7][bytes[8]] ^ tables[6][bytes[9]] ^ tables[5][bytes[10]] ^ tables[4][bytes[11]] ^
+                  tables[3][bytes[12]] ^ tables[2][bytes[13]] ^ tables[1][bytes[14]] ^ tables[0][bytes[15]];
+        }
+        for (; length > 0; --length, ++bytes) {
+            crc = tables[0][(crc ^ *bytes) & 0xFFu] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+}
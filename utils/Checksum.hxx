@@ -0,0 +1,15 @@
+#ifndef CHECKSUM_HXX
+#define CHECKSUM_HXX
+
+#include <cstddef>
+#include <cstdint>
+
+namespace NumberStore {
+    class Checksum {
+    public:
+        // CRC-32 (IEEE 802.3); pass a previous result as seed to checksum data in pieces
+        static uint32_t crc32(const void* data, size_t length, uint32_t seed = 0);
+    };
+}
+
+#endif // CHECKSUM_HXX
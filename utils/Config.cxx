@@ -19,6 +19,14 @@ namespace NumberStore {
         return pipeName;
     }
 
+    TransportType Config::getTransportType() const {
+        return transportType;
+    }
+
+    const std::string& Config::getSocketPath() const {
+        return socketPath;
+    }
+
     size_t Config::getConnectionTimeout() const {
         return connectionTimeout;
     }
@@ -31,10 +39,90 @@ namespace NumberStore {
         return bufferSize;
     }
 
+    size_t Config::getShardCount() const {
+        return shardCount;
+    }
+
+    bool Config::isWriteCombiningEnabled() const {
+        return writeCombining;
+    }
+
+    bool Config::isLockFreeReadsEnabled() const {
+        return lockFreeReads;
+    }
+
+    bool Config::isHugePagesEnabled() const {
+        return hugePages;
+    }
+
+    bool Config::isBloomFilterEnabled() const {
+        return bloomFilter;
+    }
+
+    DurabilityMode Config::getDurabilityMode() const {
+        return durabilityMode;
+    }
+
+    const std::string& Config::getWalPath() const {
+        return walPath;
+    }
+
+    size_t Config::getWalFlushInterval() const {
+        return walFlushInterval;
+    }
+
+    const std::string& Config::getCheckpointPath() const {
+        return checkpointPath;
+    }
+
+    size_t Config::getSaveWriteThreshold() const {
+        return saveWriteThreshold;
+    }
+
+    size_t Config::getSaveInterval() const {
+        return saveInterval;
+    }
+
+    bool Config::isBinaryProtocolEnabled() const {
+        return binaryProtocol;
+    }
+
+    size_t Config::getPipelineDepth() const {
+        return pipelineDepth;
+    }
+
+    size_t Config::getReactorThreads() const {
+        return reactorThreads;
+    }
+
+    size_t Config::getWorkerThreads() const {
+        return workerThreads;
+    }
+
+    IoBackend Config::getIoBackend() const {
+        return ioBackend;
+    }
+
+    LogOverflowPolicy Config::getLogOverflowPolicy() const {
+        return logOverflowPolicy;
+    }
+
+    size_t Config::getStatsSampleInterval() const {
+        return statsSampleInterval;
+    }
+
     void Config::setPipeName(const std::string& name) {
         pipeName = name;
     }
 
+    void Config::setTransportType(TransportType type) {
+        transportType = type;
+    }
+
+    void Config::setSocketPath(const std::string& path) {
+        socketPath = path;
+    }
+
     void Config::setConnectionTimeout(const size_t& timeout) {
         connectionTimeout = timeout;
     }
@@ -47,10 +135,106 @@ namespace NumberStore {
         bufferSize = size;
     }
 
+    void Config::setShardCount(const size_t& count) {
+        shardCount = count > 0 ? count : 1;
+    }
+
+    void Config::setWriteCombiningEnabled(bool enabled) {
+        writeCombining = enabled;
+    }
+
+    void Config::setLockFreeReadsEnabled(bool enabled) {
+        lockFreeReads = enabled;
+    }
+
+    void Config::setHugePagesEnabled(bool enabled) {
+        hugePages = enabled;
+    }
+
+    void Config::setBloomFilterEnabled(bool enabled) {
+        bloomFilter = enabled;
+    }
+
+    void Config::setDurabilityMode(DurabilityMode mode) {
+        durabilityMode = mode;
+    }
+
+    void Config::setWalPath(const std::string& path) {
+        walPath = path;
+    }
+
+    void Config::setWalFlushInterval(const size_t& interval) {
+        walFlushInterval = interval > 0 ? interval : 1;
+    }
+
+    void Config::setCheckpointPath(const std::string& path) {
+        checkpointPath = path;
+    }
+
+    void Config::setSaveWriteThreshold(const size_t& writes) {
+        saveWriteThreshold = writes;
+    }
+
+    void Config::setSaveInterval(const size_t& seconds) {
+        saveInterval = seconds;
+    }
+
+    void Config::setBinaryProtocolEnabled(bool enabled) {
+        binaryProtocol = enabled;
+    }
+
+    void Config::setPipelineDepth(const size_t& depth) {
+        pipelineDepth = depth > 0 ? depth : 1;
+    }
+
+    void Config::setReactorThreads(const size_t& threads) {
+        reactorThreads = threads > 0 ? threads : 1;
+    }
+
+    void Config::setWorkerThreads(const size_t& threads) {
+        workerThreads = threads;
+    }
+
+    void Config::setIoBackend(IoBackend backend) {
+        ioBackend = backend;
+    }
+
+    void Config::setLogOverflowPolicy(LogOverflowPolicy policy) {
+        logOverflowPolicy = policy;
+    }
+
+    void Config::setStatsSampleInterval(const size_t& interval) {
+        statsSampleInterval = interval > 0 ? interval : 1;
+    }
+
     void Config::loadDefaults() {
         pipeName = Constants::PIPE_NAME;
+#ifdef _WIN32
+        transportType = TransportType::NAMED_PIPE;
+#else
+        transportType = TransportType::UNIX_STREAM;
+#endif
+        socketPath = Constants::SOCKET_PATH;
         connectionTimeout = Constants::DEFAULT_TIMEOUT;
         maxConnections = Constants::MAX_CONNECTIONS;
         bufferSize = Constants::BUFFER_SIZE;
+        shardCount = Constants::DEFAULT_SHARD_COUNT;
+        writeCombining = Constants::DEFAULT_WRITE_COMBINING;
+        lockFreeReads = Constants::DEFAULT_LOCK_FREE_READS;
+        hugePages = false;
+        bloomFilter = Constants::DEFAULT_BLOOM_FILTER;
+        durabilityMode = DurabilityMode::BATCHED;
+        walPath = Constants::WAL_FILE_NAME;
+        walFlushInterval = Constants::DEFAULT_WAL_FLUSH_INTERVAL;
+        checkpointPath = Constants::CHECKPOINT_FILE_NAME;
+        saveWriteThreshold = Constants::DEFAULT_SAVE_WRITE_THRESHOLD;
+        saveInterval = Constants::DEFAULT_SAVE_INTERVAL;
+        binaryProtocol = Constants::DEFAULT_BINARY_PROTOCOL;
+        pipelineDepth = Constants::DEFAULT_PIPELINE_DEPTH;
+        reactorThreads = Constants::DEFAULT_REACTOR_THREADS;
+        workerThreads = Constants::DEFAULT_WORKER_THREADS;
+        ioBackend = IoBackend::IO_URING;
+        logOverflowPolicy = LogOverflowPolicy::COUNT;
+        statsSampleInterval = Constants::DEFAULT_STATS_SAMPLE_INTERVAL;
     }
 }
@@ -5,14 +5,62 @@
 #include <memory>
 
 namespace NumberStore {
+    // How hard the write-ahead log tries to make a change durable before it is acknowledged
+    enum class DurabilityMode {
+        NONE,       // No write-ahead log; data lives only in memory
+        BATCHED,    // Logged and fsynced by the flusher thread every flush interval
+        STRICT      // Every write waits for the fsync that covers it (group-committed)
+    };
+
+    // How the CLI reaches the daemon
+    enum class TransportType {
+        NAMED_PIPE,     // Windows message-mode named pipe
+        UNIX_STREAM,    // AF_UNIX SOCK_STREAM; messages carry a 4-byte length prefix
+        UNIX_SEQPACKET, // AF_UNIX SOCK_SEQPACKET; the kernel keeps message boundaries
+        SHARED_MEMORY   // Linux: rings in a memfd handed over a unix stream socket
+    };
+
+    // How the daemon's event loops do socket I/O (Linux)
+    enum class IoBackend {
+        EPOLL,      // Readiness: epoll_wait, then recv/sendmsg per client
+        IO_URING    // Completions: multishot accept/recv and batched sends; falls back to EPOLL if unsupported
+    };
+
+    // What a thread logging into a full log queue does
+    enum class LogOverflowPolicy {
+        DROP,       // Discard the record; it still shows in Logger::getDroppedCount()
+        BLOCK,      // Wait for the writer thread to make room; nothing is lost
+        COUNT       // Discard the record, and have the writer log how many were lost once it catches up
+    };
+
     class Config {
     private:
         static std::unique_ptr<Config> instance;
         
         std::string pipeName;
+        TransportType transportType;
+        std::string socketPath;
         size_t connectionTimeout;
         size_t maxConnections;
         size_t bufferSize;
+        size_t shardCount;
+        bool writeCombining;
+        bool lockFreeReads;
+        bool hugePages;
+        bool bloomFilter;
+        DurabilityMode durabilityMode;
+        std::string walPath;
+        size_t walFlushInterval;
+        std::string checkpointPath;
+        size_t saveWriteThreshold;
+        size_t saveInterval;
+        bool binaryProtocol;
+        size_t pipelineDepth;
+        size_t reactorThreads;
+        size_t workerThreads;
+        IoBackend ioBackend;
+        LogOverflowPolicy logOverflowPolicy;
+        size_t statsSampleInterval;
 
         Config(); // Private constructor for singleton
 
@@ -26,14 +74,54 @@ namespace NumberStore {
         static Config& getInstance();
         
         const std::string& getPipeName() const;
+        TransportType getTransportType() const;
+        const std::string& getSocketPath() const;
         size_t getConnectionTimeout() const;
         size_t getMaxConnections() const;
         size_t getBufferSize() const;
+        size_t getShardCount() const;
+        bool isWriteCombiningEnabled() const;
+        bool isLockFreeReadsEnabled() const;
+        bool isHugePagesEnabled() const;
+        bool isBloomFilterEnabled() const;
+        DurabilityMode getDurabilityMode() const;
+        const std::string& getWalPath() const;
+        size_t getWalFlushInterval() const;
+        const std::string& getCheckpointPath() const;
+        size_t getSaveWriteThreshold() const;
+        size_t getSaveInterval() const;
+        bool isBinaryProtocolEnabled() const;
+        size_t getPipelineDepth() const;
+        size_t getReactorThreads() const;
+        size_t getWorkerThreads() const;
+        IoBackend getIoBackend() const;
+        LogOverflowPolicy getLogOverflowPolicy() const;
+        size_t getStatsSampleInterval() const;
         
         void setPipeName(const std::string& name);
+        void setTransportType(TransportType type);
+        void setSocketPath(const std::string& path);
         void setConnectionTimeout(const size_t& timeout);
         void setMaxConnections(const size_t& max);
         void setBufferSize(const size_t& size);
+        void setShardCount(const size_t& count);
+        void setWriteCombiningEnabled(bool enabled); // Read when a NumberStore is constructed
+        void setLockFreeReadsEnabled(bool enabled);  // Read when a NumberStore is constructed
+        void setHugePagesEnabled(bool enabled);      // Node pools back their chunks with 2 MB pages (Linux)
+        void setBloomFilterEnabled(bool enabled);    // Read when a NumberStore is constructed
+        void setDurabilityMode(DurabilityMode mode);
+        void setWalPath(const std::string& path);
+        void setWalFlushInterval(const size_t& interval);
+        void setCheckpointPath(const std::string& path);
+        void setSaveWriteThreshold(const size_t& writes);
+        void setSaveInterval(const size_t& seconds);
+        void setBinaryProtocolEnabled(bool enabled);
+        void setPipelineDepth(const size_t& depth);
+        void setReactorThreads(const size_t& threads);
+        void setWorkerThreads(const size_t& threads); // 0: one per hardware thread
+        void setIoBackend(IoBackend backend);
+        void setLogOverflowPolicy(LogOverflowPolicy policy);
+        void setStatsSampleInterval(const size_t& interval); // 1 times every request
         
         void loadDefaults();
     };
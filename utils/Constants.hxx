@@ -8,19 +8,82 @@ namespace NumberStore {
         // Named Pipe Configuration
         const std::string PIPE_NAME = "\\\\.\\pipe\\numberstore";
         const int DEFAULT_TIMEOUT = 5000; // milliseconds
-        const size_t MAX_CONNECTIONS = 100;
+        const size_t MAX_CONNECTIONS = 10000;
         const size_t BUFFER_SIZE = 4096;
         
+        // Unix Domain Socket Configuration
+        const std::string SOCKET_PATH = "/tmp/numberstore.sock";
+        const std::string PID_FILE_PREFIX = "/tmp/numberstore_"; // + app name + ".pid"
+        const size_t SOCKET_RECEIVE_BUFFER = 64 * 1024; // Bytes read per recv on stream sockets
+        // Requested SO_SNDBUF for seqpacket sockets, which bounds the largest message;
+        // the kernel caps it at net.core.wmem_max
+        const int SEQPACKET_SEND_BUFFER = 4 * 1024 * 1024;
+        const size_t SHARED_MEMORY_RING_SIZE = 1024 * 1024; // Bytes per direction; a power of two
+        const size_t BUFFER_POOL_LIMIT = 1024;             // Idle I/O buffers kept for reuse
+        const size_t BUFFER_POOL_MAX_CAPACITY = 64 * 1024; // Larger buffers are freed, not pooled
+        const size_t SPARE_MESSAGE_BUFFERS = 16;           // Queued-message buffers a connection keeps for itself
+        
+        // Logging Configuration
+        const size_t LOG_QUEUE_CAPACITY = 8192;   // Records waiting for the writer thread; a power of two
+        const size_t LOG_WRITE_BATCH = 512;       // Records formatted into one console/file write
+        const int LOG_WRITER_LINGER = 1;          // milliseconds the writer naps after a batch so the next one can build up
+        
+        // Event Loop Configuration (Linux)
+        const size_t DEFAULT_REACTOR_THREADS = 4;
+        const size_t REACTOR_MESSAGE_BUDGET = 256;     // Requests parsed into one executor batch
+        const size_t REACTOR_OUTPUT_HIGH_WATER = 1024 * 1024; // Queued reply bytes that pause reading
+        const size_t DEFAULT_WORKER_THREADS = 0;       // Command executor threads; 0 means one per core
+        const size_t DEFAULT_STATS_SAMPLE_INTERVAL = 16; // Each connection times one request in this many for STATS
+        
+        // Storage Configuration
+        const size_t DEFAULT_SHARD_COUNT = 16;
+        const bool DEFAULT_WRITE_COMBINING = true;
+        const bool DEFAULT_LOCK_FREE_READS = true;
+        const bool DEFAULT_BLOOM_FILTER = false;
+        const size_t NODE_POOL_MIN_CHUNK = 64 * 1024;       // First chunk a shard's node pool reserves
+        const size_t NODE_POOL_MAX_CHUNK = 2 * 1024 * 1024; // Chunks double up to this size
+        const unsigned WRITE_COMBINING_SPINS = 64; // Yields a writer waits for a combiner before blocking on the shard lock
+        const size_t MAX_PAGE_SIZE = 10000;     // Entries per RANGE/PAGE response
+        const size_t MAX_BATCH_SIZE = 65536;    // Numbers per INSERT_MANY/DELETE_MANY command
+        const size_t DEFAULT_PAGE_SIZE = 1000;
+        const size_t STREAM_CHUNK_SIZE = 64 * 1024; // Max payload bytes per streamed DATA frame
+        const size_t MAX_FRAME_SIZE = 512 * 1024 * 1024; // Largest binary frame accepted
+        const bool DEFAULT_BINARY_PROTOCOL = true;
+        // Requests a pipelining client keeps in flight; small enough that the unread
+        // requests always fit in the daemon's inbound pipe buffer
+        const size_t DEFAULT_PIPELINE_DEPTH = 64;
+        
+        // Durability Configuration
+        const std::string WAL_FILE_NAME = "numberstore.wal";
+        const size_t DEFAULT_WAL_FLUSH_INTERVAL = 10; // milliseconds
+        const std::string CHECKPOINT_FILE_NAME = "numberstore.ckpt";
+        const size_t DEFAULT_SAVE_WRITE_THRESHOLD = 100000; // writes between background saves
+        const size_t DEFAULT_SAVE_INTERVAL = 300; // seconds
+        
         // Protocol Messages
         const std::string CMD_INSERT = "INSERT";
         const std::string CMD_DELETE = "DELETE";
         const std::string CMD_PRINT_ALL = "PRINT_ALL";
         const std::string CMD_DELETE_ALL = "DELETE_ALL";
         const std::string CMD_EXIT = "EXIT";
+        const std::string CMD_RANGE = "RANGE";
+        const std::string CMD_PAGE = "PAGE";
+        const std::string CMD_COUNT = "COUNT";
+        const std::string CMD_STREAM_ALL = "STREAM_ALL";
+        const std::string CMD_HELLO = "HELLO";
+        const std::string CMD_INSERT_MANY = "INSERT_MANY";
+        const std::string CMD_DELETE_MANY = "DELETE_MANY";
+        const std::string CMD_STATS = "STATS";
+        const std::string CMD_SAVE = "SAVE";
         
         const std::string RESP_SUCCESS = "SUCCESS";
         const std::string RESP_ERROR = "ERROR";
         const std::string RESP_DATA = "DATA";
+        const std::string RESP_CHUNK = "CHUNK";
+        
+        // First line of a RANGE/PAGE response: "NEXT <cursor>" or "END"
+        const std::string PAGE_NEXT = "NEXT";
+        const std::string PAGE_END = "END";
         
         // Messages
         const std::string MSG_ENTER_NUMBER = "Enter a positive integer: ";
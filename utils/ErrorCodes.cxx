@@ -2,6 +2,10 @@
 
 namespace NumberStore {
     std::string ErrorHandler::getErrorMessage(const ErrorCode& code) {
+        return getErrorText(code);
+    }
+
+    const char* ErrorHandler::getErrorText(const ErrorCode& code) {
         switch (code) {
             case ErrorCode::SUCCESS:
                 return "Operation completed successfully";
@@ -33,6 +37,14 @@ namespace NumberStore {
                 return "Initialization failed";
             case ErrorCode::INSTANCE_ALREADY_RUNNING:
                 return "Another daemon instance is already running";
+            case ErrorCode::PERSISTENCE_FAILED:
+                return "Failed to persist change to disk";
+            case ErrorCode::INVALID_RANGE:
+                return "Invalid range: lower bound above upper bound or empty page size";
+            case ErrorCode::BATCH_TOO_LARGE:
+                return "Batch is empty or holds more numbers than one command allows";
+            case ErrorCode::WOULD_BLOCK:
+                return "Operation would block";
             default:
                 return "Unknown error";
         }
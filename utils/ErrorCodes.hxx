@@ -19,12 +19,18 @@ namespace NumberStore {
         TIMEOUT,
         SHUTDOWN_REQUESTED,
         INITIALIZATION_FAILED,
-        INSTANCE_ALREADY_RUNNING
+        INSTANCE_ALREADY_RUNNING,
+        PERSISTENCE_FAILED,
+        INVALID_RANGE,
+        BATCH_TOO_LARGE,
+        WOULD_BLOCK
     };
 
     class ErrorHandler {
     public:
         static std::string getErrorMessage(const ErrorCode& code);
+        // The same text without building a string, for replies written into reused buffers
+        static const char* getErrorText(const ErrorCode& code);
         static bool isError(const ErrorCode& code);
     };
 }
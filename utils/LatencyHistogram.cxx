@@ -0,0 +1,104 @@
+#include "LatencyHistogram.hxx"
+#include <vector>
+#include <cmath>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace NumberStore {
+    LatencyHistogram::LatencyHistogram() : maximum(0) {
+        for (auto& count : counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void LatencyHistogram::record(uint64_t value) {
+        counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t seen = maximum.load(std::memory_order_relaxed);
+        while (value > seen && !maximum.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    LatencyHistogram::Summary LatencyHistogram::summarize() const {
+        // Work from one copy so the percentiles agree with the count they are taken from
+        std::vector<uint64_t> copy(BUCKET_COUNT);
+        Summary summary;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            copy[i] = counts[i].load(std::memory_order_relaxed);
+            summary.count += copy[i];
+        }
+        summary.max = maximum.load(std::memory_order_relaxed);
+        if (summary.count == 0) {
+            return summary;
+        }
+
+        const double fractions[3] = {0.50, 0.99, 0.999};
+        uint64_t* results[3] = {&summary.p50, &summary.p99, &summary.p999};
+        uint64_t ranks[3];
+        for (size_t i = 0; i < 3; ++i) {
+            ranks[i] = static_cast<uint64_t>(std::ceil(fractions[i] * static_cast<double>(summary.count)));
+            if (ranks[i] == 0) {
+                ranks[i] = 1;
+            }
+        }
+
+        size_t next = 0;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT && next < 3; ++i) {
+            seen += copy[i];
+            while (next < 3 && seen >= ranks[next]) {
+                *results[next++] = bucketUpperBound(i);
+            }
+        }
+
+        // The top bucket's bound can overshoot the largest value actually recorded
+        for (uint64_t* result : results) {
+            if (*result > summary.max) {
+                *result = summary.max;
+            }
+        }
+        return summary;
+    }
+
+    uint64_t LatencyHistogram::getCount() const {
+        uint64_t total = 0;
+        for (const auto& count : counts) {
+            total += count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    size_t LatencyHistogram::bucketIndex(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+
+#ifdef _MSC_VER
+        unsigned long highestBit;
+        _BitScanReverse64(&highestBit, value);
+        unsigned exponent = static_cast<unsigned>(highestBit);
+#else
+        unsigned exponent = 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+        if (exponent >= MAX_EXPONENT) {
+            return BUCKET_COUNT - 1;
+        }
+
+        // The SUB_BUCKET_BITS bits below the leading one pick the bucket within the power of two
+        size_t subBucket = static_cast<size_t>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+    }
+
+    uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+
+        unsigned exponent = static_cast<unsigned>(index / SUB_BUCKETS) + SUB_BUCKET_BITS - 1;
+        uint64_t subBucket = index % SUB_BUCKETS;
+        unsigned shift = exponent - SUB_BUCKET_BITS;
+        return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+    }
+}
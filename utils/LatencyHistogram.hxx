@@ -0,0 +1,50 @@
+#ifndef LATENCY_HISTOGRAM_HXX
+#define LATENCY_HISTOGRAM_HXX
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace NumberStore {
+    // Lock-free log-linear histogram in the style of HdrHistogram. Values below 32 get a
+    // bucket each; above that every power of two is split into 32 buckets, so a reported
+    // percentile is within about 3% of the true value. Values from 2^44 up (about 4.9
+    // hours in nanoseconds) share the last bucket. Recording is one relaxed increment,
+    // and readers may summarize while writers record.
+    class LatencyHistogram {
+    public:
+        static const unsigned SUB_BUCKET_BITS = 5;
+        static const unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+        static const unsigned MAX_EXPONENT = 44;
+        static const size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        struct Summary {
+            uint64_t count = 0;
+            uint64_t p50 = 0;
+            uint64_t p99 = 0;
+            uint64_t p999 = 0;
+            uint64_t max = 0;
+        };
+
+    private:
+        std::atomic<uint64_t> counts[BUCKET_COUNT];
+        std::atomic<uint64_t> maximum;
+
+    public:
+        LatencyHistogram();
+        ~LatencyHistogram() = default;
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void record(uint64_t value);
+        // Percentiles are the highest value their bucket stands for
+        Summary summarize() const;
+        uint64_t getCount() const;
+
+        static size_t bucketIndex(uint64_t value);
+        static uint64_t bucketUpperBound(size_t index);
+    };
+}
+
+#endif // LATENCY_HISTOGRAM_HXX
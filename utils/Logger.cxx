@@ -1,76 +1,250 @@
 #include "Logger.hxx"
 #include "TimeUtils.hxx"
+#include "Config.hxx"
+#include "Constants.hxx"
 #include <iostream>
-#include <sstream>
+#include <chrono>
 
 namespace NumberStore {
     std::unique_ptr<Logger> Logger::instance = nullptr;
-    std::mutex Logger::logMutex;
+    std::once_flag Logger::instanceFlag;
 
-    Logger::Logger() : consoleOutput(true), currentLevel(LogLevel::INFO) {
+    Logger::Logger()
+        : consoleOutput(true), currentLevel(LogLevel::INFO),
+          records(new Record[Constants::LOG_QUEUE_CAPACITY]), recordMask(Constants::LOG_QUEUE_CAPACITY - 1),
+          enqueuePosition(0), dequeuePosition(0), writtenPosition(0), droppedCount(0), unreportedDrops(0),
+          writerWaiting(false), stopping(false) {
+        for (size_t i = 0; i < Constants::LOG_QUEUE_CAPACITY; ++i) {
+            records[i].sequence.store(i, std::memory_order_relaxed);
+        }
         // logFile.open("numberstore.log", std::ios::app);
+        writerThread = std::thread(&Logger::writerLoop, this);
     }
 
     Logger::~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping.store(true);
+        }
+        wakeCondition.notify_one();
+        if (writerThread.joinable()) {
+            writerThread.join();
+        }
+
+        uint64_t dropped = droppedCount.load();
+        if (dropped > 0) {
+            std::string line = "[" + TimeUtils::getCurrentTimestampString() + "] [" + levelToString(LogLevel::WARNING) + "] "
+                             + std::to_string(dropped) + " log records were dropped because the log queue was full\n";
+            if (consoleOutput.load()) {
+                std::cout << line << std::flush;
+            }
+            if (logFile.is_open()) {
+                logFile << line;
+            }
+        }
+
         if (logFile.is_open()) {
             logFile.close();
         }
     }
 
     Logger& Logger::getInstance() {
-        std::lock_guard<std::mutex> lock(logMutex);
-        if (!instance) {
+        // Every log call comes through here, so the initialized path must not take a lock
+        std::call_once(instanceFlag, [] {
             instance = std::unique_ptr<Logger>(new Logger());
-        }
+        });
         return *instance;
     }
 
-    void Logger::log(LogLevel level, const std::string& message) {
-        if (!shouldLog(level)) return;
-
-        std::lock_guard<std::mutex> lock(logMutex);
-        
-        std::ostringstream logEntry;
-        logEntry << "[" << getCurrentTimeString() << "] "
-                 << "[" << levelToString(level) << "] "
-                 << message;
+    void Logger::log(LogLevel level, std::string message) {
+        if (!isEnabled(level)) return;
 
-        std::string logLine = logEntry.str();
+        int64_t timestamp = TimeUtils::getCurrentUnixTimestamp();
+        if (tryEnqueue(level, timestamp, message)) {
+            return;
+        }
 
-        if (consoleOutput) {
-            std::cout << logLine << std::endl;
+        // Queue full: only this slow path looks at the configuration
+        LogOverflowPolicy policy = Config::getInstance().getLogOverflowPolicy();
+        if (policy == LogOverflowPolicy::BLOCK) {
+            // Once shutdown has begun nothing will make room, so the record is dropped instead
+            while (!stopping.load(std::memory_order_relaxed)) {
+                std::this_thread::yield();
+                if (tryEnqueue(level, timestamp, message)) {
+                    return;
+                }
+            }
         }
 
-        if (logFile.is_open()) {
-            logFile << logLine << std::endl;
-            logFile.flush();
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        if (policy == LogOverflowPolicy::COUNT) {
+            unreportedDrops.fetch_add(1, std::memory_order_relaxed);
         }
     }
 
-    void Logger::info(const std::string& message) {
-        log(LogLevel::INFO, message);
+    void Logger::info(std::string message) {
+        log(LogLevel::INFO, std::move(message));
+    }
+
+    void Logger::warning(std::string message) {
+        log(LogLevel::WARNING, std::move(message));
     }
 
-    void Logger::warning(const std::string& message) {
-        log(LogLevel::WARNING, message);
+    void Logger::error(std::string message) {
+        log(LogLevel::ERROR_LEVEL, std::move(message));
     }
 
-    void Logger::error(const std::string& message) {
-        log(LogLevel::ERROR_LEVEL, message);
+    void Logger::debug(std::string message) {
+        log(LogLevel::DEBUG, std::move(message));
     }
 
-    void Logger::debug(const std::string& message) {
-        log(LogLevel::DEBUG, message);
+    void Logger::flush() {
+        size_t target = enqueuePosition.load(std::memory_order_acquire);
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.notify_one();
+        drainedCondition.wait(lock, [this, target] {
+            return writtenPosition.load(std::memory_order_acquire) >= target || stopping.load();
+        });
     }
 
     void Logger::setConsoleOutput(bool enabled) {
-        std::lock_guard<std::mutex> lock(logMutex);
-        consoleOutput = enabled;
+        consoleOutput.store(enabled);
     }
 
     void Logger::setLogLevel(LogLevel level) {
-        std::lock_guard<std::mutex> lock(logMutex);
-        currentLevel = level;
+        currentLevel.store(level);
+    }
+
+    uint64_t Logger::getDroppedCount() const {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+    bool Logger::tryEnqueue(LogLevel level, int64_t timestamp, std::string& message) {
+        // Bounded multi-producer queue: a slot's sequence says whose turn it is, so
+        // producers only contend on the compare-exchange that claims a position
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Record* record;
+        while (true) {
+            record = &records[position & recordMask];
+            size_t sequence = record->sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (sequence < position) {
+                return false; // The writer has not freed this slot yet: full
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        record->level = level;
+        record->timestamp = timestamp;
+        record->message = std::move(message);
+        record->sequence.store(position + 1, std::memory_order_release);
+
+        // Pairs with the fence in writerLoop(): either the writer sees this record
+        // before it sleeps, or this thread sees that it is asleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writerWaiting.load(std::memory_order_relaxed)) {
+            wakeWriter();
+        }
+        return true;
+    }
+
+    void Logger::wakeWriter() {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeCondition.notify_one();
+    }
+
+    void Logger::writerLoop() {
+        std::string batch;
+        while (true) {
+            bool wrote = false;
+            while (writeBatch(batch) > 0) {
+                wrote = true;
+            }
+
+            if (wrote) {
+                // Let the next batch build up; producers don't wake a napping writer
+                std::this_thread::sleep_for(std::chrono::milliseconds(Constants::LOG_WRITER_LINGER));
+                continue;
+            }
+
+            if (stopping.load()) {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            writerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wakeCondition.wait(lock, [this] {
+                return stopping.load() || hasReadyRecord();
+            });
+            writerWaiting.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    size_t Logger::writeBatch(std::string& batch) {
+        batch.clear();
+        size_t count = 0;
+        int64_t lastTimestamp = -1;
+        std::string timestampString;
+
+        while (count < Constants::LOG_WRITE_BATCH) {
+            Record& record = records[dequeuePosition & recordMask];
+            if (record.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+                break;
+            }
+
+            if (record.timestamp != lastTimestamp) {
+                lastTimestamp = record.timestamp;
+                timestampString = TimeUtils::formatTimestamp(record.timestamp);
+            }
+            batch += '[';
+            batch += timestampString;
+            batch += "] [";
+            batch += levelToString(record.level);
+            batch += "] ";
+            batch += record.message;
+            batch += '\n';
+
+            // Free the message here rather than in the next producer to use the slot
+            std::string().swap(record.message);
+            record.sequence.store(dequeuePosition + recordMask + 1, std::memory_order_release);
+            ++dequeuePosition;
+            ++count;
+        }
+
+        uint64_t lost = unreportedDrops.exchange(0, std::memory_order_relaxed);
+        if (lost > 0) {
+            batch += "[" + TimeUtils::getCurrentTimestampString() + "] [" + levelToString(LogLevel::WARNING) + "] "
+                   + std::to_string(lost) + " log records dropped because the log queue was full\n";
+        }
+
+        if (!batch.empty()) {
+            if (consoleOutput.load(std::memory_order_relaxed)) {
+                std::cout << batch << std::flush;
+            }
+            if (logFile.is_open()) {
+                logFile << batch;
+                logFile.flush();
+            }
+        }
+
+        if (count > 0) {
+            writtenPosition.store(dequeuePosition, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+            }
+            drainedCondition.notify_all();
+        }
+        return count;
+    }
+
+    bool Logger::hasReadyRecord() const {
+        return records[dequeuePosition & recordMask].sequence.load(std::memory_order_acquire) == dequeuePosition + 1;
     }
 
     std::string Logger::levelToString(LogLevel level) {
@@ -82,12 +256,4 @@ namespace NumberStore {
             default: return "UNKNOWN";
         }
     }
-
-    std::string Logger::getCurrentTimeString() {
-        return TimeUtils::getCurrentTimestampString();
-    }
-
-    bool Logger::shouldLog(LogLevel level) {
-        return static_cast<int>(level) >= static_cast<int>(currentLevel);
-    }
 }
@@ -3,25 +3,60 @@
 
 #include <string>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
 #include <fstream>
 #include <memory>
+#include <cstdint>
+#include <cstddef>
 
 namespace NumberStore {
+    // In increasing severity; setLogLevel() drops everything below its level
     enum class LogLevel {
+        DEBUG,
         INFO,
         WARNING,
-        ERROR_LEVEL,
-        DEBUG
+        ERROR_LEVEL
     };
 
+    // Logging never formats or writes on the caller's thread. A call moves its message
+    // into a bounded lock-free multi-producer queue, and one writer thread formats the
+    // records and writes them in batches, one console write and one file flush per
+    // batch. A busy writer naps between batches instead of being woken, so only the
+    // first record after a quiet spell costs its caller a wake-up. When the queue is
+    // full, Config::getLogOverflowPolicy() decides whether the caller drops the record
+    // or waits.
     class Logger {
     private:
+        struct Record {
+            std::atomic<size_t> sequence;   // Position this slot is ready for: writable at pos, readable at pos + 1
+            LogLevel level;
+            int64_t timestamp;
+            std::string message;
+        };
+
         static std::unique_ptr<Logger> instance;
-        static std::mutex logMutex;
+        static std::once_flag instanceFlag;
         
         std::ofstream logFile;
-        bool consoleOutput;
-        LogLevel currentLevel;
+        std::atomic<bool> consoleOutput;
+        std::atomic<LogLevel> currentLevel;
+
+        std::unique_ptr<Record[]> records;
+        size_t recordMask;
+        alignas(64) std::atomic<size_t> enqueuePosition;
+        alignas(64) size_t dequeuePosition;     // Writer thread only
+        std::atomic<size_t> writtenPosition;    // Records before this one have been written
+        std::atomic<uint64_t> droppedCount;
+        std::atomic<uint64_t> unreportedDrops;  // COUNT policy: drops the writer has yet to log
+
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable drainedCondition;
+        std::atomic<bool> writerWaiting;
+        std::atomic<bool> stopping;
+        std::thread writerThread;
 
         Logger();
 
@@ -36,20 +71,68 @@ namespace NumberStore {
         
         static Logger& getInstance();
         
-        void log(LogLevel level, const std::string& message);
-        void info(const std::string& message);
-        void warning(const std::string& message);
-        void error(const std::string& message);
-        void debug(const std::string& message);
+        void log(LogLevel level, std::string message);
+        void info(std::string message);
+        void warning(std::string message);
+        void error(std::string message);
+        void debug(std::string message);
+        
+        // Waits until everything logged before the call has been written
+        void flush();
         
         void setConsoleOutput(bool enabled);
         void setLogLevel(LogLevel level);
+        uint64_t getDroppedCount() const;
+        
+        // Inline so that the NS_LOG_* macros cost one relaxed load when the level is off
+        bool isEnabled(LogLevel level) const {
+            return static_cast<int>(level) >= static_cast<int>(currentLevel.load(std::memory_order_relaxed));
+        }
         
     private:
+        bool tryEnqueue(LogLevel level, int64_t timestamp, std::string& message);
+        void wakeWriter();
+        void writerLoop();
+        // Formats and writes up to LOG_WRITE_BATCH ready records; returns how many
+        size_t writeBatch(std::string& batch);
+        bool hasReadyRecord() const;
         std::string levelToString(LogLevel level);
-        std::string getCurrentTimeString();
-        bool shouldLog(LogLevel level);
     };
 }
 
+// Preferred over calling Logger directly: the message expression is only evaluated
+// when its level is enabled, so a disabled statement never builds its string.
+#define NS_LOG(level, message) \
+    do { \
+        ::NumberStore::Logger& nsLogger = ::NumberStore::Logger::getInstance(); \
+        if (nsLogger.isEnabled(level)) { \
+            nsLogger.log(level, message); \
+        } \
+    } while (0)
+
+#define NS_LOG_INFO(message) NS_LOG(::NumberStore::LogLevel::INFO, message)
+#define NS_LOG_WARNING(message) NS_LOG(::NumberStore::LogLevel::WARNING, message)
+#define NS_LOG_ERROR(message) NS_LOG(::NumberStore::LogLevel::ERROR_LEVEL, message)
+
+// Debug statements are compiled out of release (NDEBUG) builds unless
+// NUMBERSTORE_DEBUG_LOGGING is defined to 1. The message is still type-checked.
+#ifndef NUMBERSTORE_DEBUG_LOGGING
+#ifdef NDEBUG
+#define NUMBERSTORE_DEBUG_LOGGING 0
+#else
+#define NUMBERSTORE_DEBUG_LOGGING 1
+#endif
+#endif
+
+#if NUMBERSTORE_DEBUG_LOGGING
+#define NS_LOG_DEBUG(message) NS_LOG(::NumberStore::LogLevel::DEBUG, message)
+#else
+#define NS_LOG_DEBUG(message) \
+    do { \
+        if (false) { \
+            static_cast<void>(message); \
+        } \
+    } while (0)
+#endif
+
 #endif // LOGGER_HXX
@@ -1,16 +1,33 @@
 #include "SingleInstanceManager.hxx"
 #include "Logger.hxx"
+#include "Constants.hxx"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
 
 namespace NumberStore {
+#ifdef _WIN32
     SingleInstanceManager::SingleInstanceManager(const std::string& appName) 
         : mutexHandle(nullptr), isOwner(false) {
         mutexName = "Global\\NumberStore_" + appName + "_Mutex";
     }
+#else
+    SingleInstanceManager::SingleInstanceManager(const std::string& appName) 
+        : lockFd(-1), isOwner(false) {
+        mutexName = Constants::PID_FILE_PREFIX + appName + ".pid";
+    }
+#endif
 
     SingleInstanceManager::~SingleInstanceManager() {
         unlock();
     }
 
+#ifdef _WIN32
     ErrorCode SingleInstanceManager::tryLock() {
         if (mutexHandle != nullptr) {
             return ErrorCode::SUCCESS; // Already locked
@@ -57,4 +74,54 @@ namespace NumberStore {
     bool SingleInstanceManager::isLocked() const {
         return mutexHandle != nullptr && isOwner;
     }
+#else
+    ErrorCode SingleInstanceManager::tryLock() {
+        if (lockFd >= 0) {
+            return ErrorCode::SUCCESS; // Already locked
+        }
+
+        int fd = ::open(mutexName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            Logger::getInstance().error("Failed to open lock file " + mutexName + ": " + std::strerror(errno));
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            int error = errno;
+            ::close(fd);
+            if (error == EWOULDBLOCK) {
+                // Another instance is already running
+                Logger::getInstance().warning("Another daemon instance is already running");
+                return ErrorCode::INSTANCE_ALREADY_RUNNING;
+            }
+            Logger::getInstance().error("Failed to lock " + mutexName + ": " + std::strerror(error));
+            return ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        // Record our pid for operators; the lock, not the file contents, is what excludes others
+        std::string pid = std::to_string(::getpid()) + "\n";
+        if (::ftruncate(fd, 0) != 0 || ::write(fd, pid.data(), pid.size()) != static_cast<ssize_t>(pid.size())) {
+            Logger::getInstance().warning("Failed to write pid to " + mutexName);
+        }
+
+        lockFd = fd;
+        isOwner = true;
+        Logger::getInstance().info("Single instance lock acquired");
+        return ErrorCode::SUCCESS;
+    }
+
+    void SingleInstanceManager::unlock() {
+        if (lockFd >= 0 && isOwner) {
+            // The file stays behind; unlinking it would let a racing instance lock a stale inode
+            ::close(lockFd);
+            lockFd = -1;
+            isOwner = false;
+            Logger::getInstance().info("Single instance lock released");
+        }
+    }
+
+    bool SingleInstanceManager::isLocked() const {
+        return lockFd >= 0 && isOwner;
+    }
+#endif
 }
@@ -1,14 +1,20 @@
 #ifndef SINGLEINSTANCEMANAGER_HXX
 #define SINGLEINSTANCEMANAGER_HXX
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <string>
 #include "ErrorCodes.hxx"
 
 namespace NumberStore {
     class SingleInstanceManager {
     private:
+#ifdef _WIN32
         HANDLE mutexHandle;
+#else
+        int lockFd;             // flock()ed pid file; the kernel drops the lock if the process dies
+#endif
         std::string mutexName;
         bool isOwner;
 